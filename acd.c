@@ -0,0 +1,935 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "acd.h"
+
+// --rungcode, shared by parse, export and batch
+#define RUNGCODE_USAGE \
+    "   --rungcode   decode rung logic from RungCode blocks, a hypothetical encoding only the\n" \
+    "                synthetic generator writes (real ladder logic is in SbRegion.Dat, not yet\n" \
+    "                decoded); without it every rung is exported as NOP();\n"
+
+static void usage(const char *prog) {
+    printf("Usage: %s <command> [options]\n\n", prog);
+    printf("Commands:\n");
+    printf("   scan [--sig TEXT]... <acd_file>          list header, blocks and signature hits\n");
+    printf("   extract [--jobs N] [--full] [--block-cache DIR] [--sig TEXT]... <acd_file>\n");
+    printf("                                            write blocks to extracted_blocks/\n");
+    printf("   parse [--jobs N] [--no-cache] [--block-cache DIR] [--columnar FILE] [--rungcode]\n");
+    printf("         <block.bin | project.ACD> [out.L5X]  parse Comps, generate L5X\n");
+    printf("   export [--jobs N] [--dump-blocks[=DIR]] [--rungcode] <project.ACD> [out.L5X]\n");
+    printf("                                            one pass ACD → L5X, blocks to disk only on request\n");
+    printf("   tags [--type NAME] [--program NAME | --controller] [--datatypes] <project.ACD>\n");
+    printf("                                            decode TagInfo.XML and list tags\n");
+    printf("   diff <old.ACD> <new.ACD>                 changed blocks and components between revisions\n");
+    printf("   batch [--jobs N] [--out DIR] [--manifest FILE] [--list FILE] [--rungcode] <dir | project.ACD>...\n");
+    printf("                                            convert many ACDs to L5X, write a JSON manifest\n");
+    printf("\n   --sig TEXT  search for TEXT as well as the built-in database signatures\n");
+    printf("   --full      re-extract every block, not just the ones that changed\n");
+    printf("   --no-cache  ignore and don't write the <acd>%s component cache\n", ACD_COMPCACHE_SUFFIX);
+    printf("   --block-cache DIR     share decompressed blocks across files in DIR (default $%s)\n",
+           ACD_BLOCK_CACHE_ENV);
+    printf("   --block-cache-limit MB  evict least recently used blocks above MB (default %llu)\n",
+           ACD_BLOCK_CACHE_DEFAULT_LIMIT >> 20);
+    printf("%s", RUNGCODE_USAGE);
+    printf("\nAny command:\n");
+    printf("   --quiet, -q     no per-block or per-record lines\n");
+    printf("   --stats=json    print stage counters and timings as one JSON line at the end\n");
+}
+
+// File the command worked on, for the --stats line
+static const char *stats_path;
+
+// Add a --sig pattern, starting from the built-in signatures on first use
+static int add_signature(SignatureSet **sigs, const char *text) {
+    if (!*sigs) {
+        *sigs = acd_signatures_create();
+        if (!*sigs || acd_signatures_add_defaults(*sigs) != 0) {
+            return -1;
+        }
+    }
+    return acd_signatures_add(*sigs, text, text, strlen(text)) < 0 ? -1 : 0;
+}
+
+// The shared block cache from --block-cache, else $ACD_BLOCK_CACHE; NULL
+// when neither is set or it can't be opened
+static BlockCache *open_block_cache(const char *dir, long limit_mb) {
+    if (!dir) dir = getenv(ACD_BLOCK_CACHE_ENV);
+    if (!dir || !*dir) {
+        return NULL;
+    }
+    BlockCache *cache = acd_block_cache_open(dir, limit_mb > 0 ? (uint64_t)limit_mb << 20 : 0);
+    if (!cache) {
+        fprintf(stderr, "⚠️  Block cache %s unavailable, inflating everything\n", dir);
+    }
+    return cache;
+}
+
+static void report_block_cache(const BlockCache *cache) {
+    if (cache) {
+        size_t hits, misses;
+        acd_block_cache_counts(cache, &hits, &misses);
+        printf("🗃️  Block cache: %zu hits, %zu misses\n", hits, misses);
+    }
+}
+
+// True for a whole project file rather than an extracted block
+static int is_acd_path(const char *path) {
+    size_t len = strlen(path);
+    return len > 4 && strcasecmp(path + len - 4, ".acd") == 0;
+}
+
+static int cmd_scan(int argc, char *argv[]) {
+    const char *path = NULL;
+    SignatureSet *sigs = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sig") == 0 && i + 1 < argc) {
+            add_signature(&sigs, argv[++i]);
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || (sigs && acd_signatures_compile(sigs) != 0)) {
+        printf("Usage: acd scan [--sig TEXT]... <acd_file>\n");
+        acd_signatures_destroy(sigs);
+        return 1;
+    }
+    
+    ACD_File acd;
+    stats_path = path;
+    
+    printf("🚀 ACD Binary Parser v1.0\n");
+    printf("========================\n\n");
+    
+    // Open file
+    if (acd_file_open(&acd, path) != 0) {
+        perror("Failed to open file");
+        acd_signatures_destroy(sigs);
+        return 1;
+    }
+    
+    printf("📄 File: %s\n", path);
+    printf("📏 Size: %.2f MB (%ld bytes)\n\n", acd.file_size / (1024.0 * 1024.0), acd.file_size);
+    
+    // Read header
+    read_text_header(&acd);
+    
+    // Find compressed blocks: from the sidecar index when it is current,
+    // otherwise scanned and the index written for the next run
+    CompressedBlock *blocks = NULL;
+    size_t block_count = 0;
+    int from_index = 0;
+    if (acd_index_blocks(path, &acd, &blocks, &block_count, &from_index) != 0) {
+        perror("Failed to index compressed blocks");
+        acd_signatures_destroy(sigs);
+        acd_file_close(&acd);
+        return 1;
+    }
+    if (from_index) {
+        printf("\n⚡ Loaded block index: %zu blocks\n", block_count);
+    } else {
+        printf("\n💾 Indexed %zu blocks: %s%s\n", block_count, path, ACD_INDEX_SUFFIX);
+    }
+    list_indexed_blocks(blocks, block_count);
+    printf("\n📦 Total compressed blocks found: %zu\n", block_count);
+    
+    // Analyze structure: the raw region, then the inside of every block
+    analyze_structure(&acd, sigs);
+    analyze_blocks(&acd, blocks, block_count, sigs);
+    free(blocks);
+    
+    acd_signatures_destroy(sigs);
+    acd_file_close(&acd);
+    
+    printf("\n✅ Analysis complete!\n");
+    return 0;
+}
+
+static int cmd_extract(int argc, char *argv[]) {
+    int jobs = 1, full = 0;
+    long cache_limit = 0;
+    const char *path = NULL, *cache_dir = NULL;
+    SignatureSet *sigs = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sig") == 0 && i + 1 < argc) {
+            add_signature(&sigs, argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--full") == 0) {
+            full = 1;
+        } else if (strcmp(argv[i], "--block-cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--block-cache-limit") == 0 && i + 1 < argc) {
+            cache_limit = atol(argv[++i]);
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || (sigs && acd_signatures_compile(sigs) != 0)) {
+        printf("Usage: acd extract [--jobs N] [--full] [--block-cache DIR [--block-cache-limit MB]]\n");
+        printf("                   [--sig TEXT]... <acd_file>\n");
+        printf("   --jobs N   decompress blocks on N threads (0 = one per CPU)\n");
+        printf("   --full     re-extract every block, not just the ones that changed\n");
+        printf("   --block-cache DIR  share decompressed blocks across files (default $%s)\n", ACD_BLOCK_CACHE_ENV);
+        acd_signatures_destroy(sigs);
+        return 1;
+    }
+    
+    stats_path = path;
+    printf("🚀 ACD Extractor v2.0\n");
+    printf("====================\n\n");
+    
+    ACD_File acd;
+    if (acd_file_open(&acd, path) != 0) {
+        perror("Failed to open file");
+        acd_signatures_destroy(sigs);
+        return 1;
+    }
+    
+    printf("📄 File: %s\n", path);
+    printf("📏 Size: %.2f MB\n\n", acd.file_size / (1024.0 * 1024.0));
+    
+    // Reuse the sidecar block index when it still matches this file; a
+    // stale one from the last save still spares most of the rescan
+    CompressedBlock *blocks = NULL;
+    size_t block_count = 0;
+    IndexRefresh refresh;
+    if (acd_index_refresh(path, &acd, &blocks, &block_count, &refresh) != 0) {
+        perror("Failed to index compressed blocks");
+        acd_signatures_destroy(sigs);
+        acd_file_close(&acd);
+        return 1;
+    }
+    if (refresh.from_index) {
+        printf("⚡ Loaded block index: %zu blocks\n", block_count);
+    } else {
+        printf("💾 Indexed %zu blocks: %s%s\n", block_count, path, ACD_INDEX_SUFFIX);
+        if (refresh.previous) {
+            printf("♻️  %zu matched the previous index by CRC32/ISIZE trailer\n", refresh.reused);
+        }
+    }
+    
+    printf("📍 Binary data starts at: 0x%lx\n\n", acd.binary_start);
+    
+    // Extract GZIP blocks
+    printf("🗜️  Extracting compressed blocks...\n\n");
+    // extracted_blocks/ normally holds the last extraction of this file:
+    // the previous index after a re-save, the current one otherwise
+    const CompressedBlock *previous = refresh.from_index ? blocks : refresh.previous;
+    size_t previous_count = refresh.from_index ? block_count : refresh.previous_count;
+    if (full) {
+        previous = NULL;
+        previous_count = 0;
+    }
+    BlockCache *cache = open_block_cache(cache_dir, cache_limit);
+    if (extract_blocks(&acd, blocks, block_count, jobs, previous, previous_count, cache) != 0) {
+        perror("Failed to extract blocks");
+    }
+    report_block_cache(cache);
+    acd_block_cache_close(cache);
+    
+    printf("\n📊 Extracted %zu compressed blocks\n", block_count);
+    
+    // Search for database structures
+    find_database_files(&acd, acd.binary_start, sigs);
+    
+    acd_signatures_destroy(sigs);
+    free(refresh.previous);
+    free(blocks);
+    acd_file_close(&acd);
+    
+    printf("\n✅ Extraction complete! Check 'extracted_blocks' directory\n");
+    return 0;
+}
+
+// Summary of an acd_export_collect pass
+static void report_export(const ExportStats *stats, const char *dump_dir) {
+    const PipelineStats *ps = &stats->pipeline;
+    printf("\n📊 One pass over %zu blocks: %zu Comps, %zu RungCode, %zu TagInfo.XML, %zu skipped after the head, %zu failed\n",
+           ps->blocks, stats->comps_blocks, stats->rung_blocks, stats->tag_blocks, ps->skipped, ps->failed);
+    if (dump_dir) {
+        printf("💾 Dumped %zu blocks to %s/", stats->dumped, dump_dir);
+        if (stats->dump_failed) printf(" (%zu could not be written)", stats->dump_failed);
+        printf("\n");
+    }
+}
+
+static int cmd_parse(int argc, char *argv[]) {
+    int jobs = 1, use_cache = 1;
+    long cache_limit = 0;
+    const char *path = NULL, *output_file = "PLC100_Mashing_Detailed.L5X", *cache_dir = NULL;
+    const char *columnar_file = NULL;
+    int positional = 0, rungcode = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            use_cache = 0;
+        } else if (strcmp(argv[i], "--block-cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--block-cache-limit") == 0 && i + 1 < argc) {
+            cache_limit = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--columnar") == 0 && i + 1 < argc) {
+            columnar_file = argv[++i];
+        } else if (strcmp(argv[i], "--rungcode") == 0) {
+            rungcode = 1;
+        } else if (positional == 0) {
+            path = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            output_file = argv[i];
+            positional++;
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        printf("Usage: acd parse [--jobs N] [--no-cache] [--block-cache DIR [--block-cache-limit MB]]\n");
+        printf("                 [--columnar FILE] [--rungcode] <extracted_block.bin | project.ACD> [output.L5X]\n");
+        printf("   --jobs N     decode routines and render L5X sections on N threads (0 = one per CPU)\n");
+        printf("   --no-cache   ignore and don't write the <acd>%s component cache\n", ACD_COMPCACHE_SUFFIX);
+        printf("   --block-cache DIR  share decompressed blocks across files (default $%s)\n", ACD_BLOCK_CACHE_ENV);
+        printf("   --columnar FILE    also write components, tags and rungs as a mappable columnar\n");
+        printf("                      file (%s) for analytics\n", ACD_COLUMNAR_SUFFIX);
+        printf("%s", RUNGCODE_USAGE);
+        return 1;
+    }
+    if (jobs <= 0) {
+        jobs = acd_cpu_count();
+    }
+    
+    stats_path = path;
+    printf("🚀 Comprehensive ACD Parser v3.0\n");
+    printf("=================================\n\n");
+    
+    // Map the input
+    ACD_File input;
+    if (acd_file_open(&input, path) != 0) {
+        perror("Failed to open input file");
+        return 1;
+    }
+    
+    ComponentStore store;
+    RungTable rungs;
+    TagTable tags = {0};
+    L5xOptions options = {0};
+    options.jobs = jobs;
+    char header_text[512];
+    rung_table_init(&rungs);
+    if (component_store_init(&store) != 0) {
+        perror("Failed to allocate component store");
+        acd_file_close(&input);
+        return 1;
+    }
+    
+    if (is_acd_path(path)) {
+        // Members are inflated and parsed in memory, nothing touches disk
+        printf("📄 Loaded ACD: %s\n", path);
+        printf("📏 Size: %.2f MB\n", input.file_size / (1024.0 * 1024.0));
+        
+        // Controller name and revision come from the text header
+        ACD_Header header;
+        input.binary_start = acd_find_binary_start(&input);
+        if (acd_header_parse(&input, &header) == 0) {
+            acd_l5x_options_from_header(&options, &header, header_text, sizeof(header_text));
+            options.jobs = jobs;
+            acd_header_free(&header);
+        }
+        
+        CompressedBlock *blocks = NULL;
+        size_t block_count = 0;
+        if (acd_index_blocks(path, &input, &blocks, &block_count, NULL) != 0) {
+            perror("Failed to index compressed blocks");
+            component_store_free(&store);
+            acd_file_close(&input);
+            return 1;
+        }
+        // Comps, RungCode (with --rungcode) and TagInfo.XML (for --columnar;
+        // tags don't go in the L5X) in one pass. Unchanged blocks come back
+        // from the component cache, shared ones from the block cache.
+        BlockCache *cache = open_block_cache(cache_dir, cache_limit);
+        ExportOptions export_options = { jobs, NULL, cache, rungcode, use_cache ? path : NULL };
+        ExportStats export_stats;
+        TagTable *want_tags = NULL;
+        if (columnar_file) {
+            if (tag_table_init(&tags) == 0) {
+                want_tags = &tags;
+            } else {
+                fprintf(stderr, "⚠️  Tag database unavailable, columnar file has no tags\n");
+            }
+        }
+        if (acd_export_collect(&store, &rungs, want_tags, &input, blocks, block_count, &export_options,
+                               &export_stats) != 0) {
+            fprintf(stderr, "⚠️  Not every database decoded; exporting what did\n");
+        } else {
+            report_export(&export_stats, NULL);
+        }
+        report_block_cache(cache);
+        acd_block_cache_close(cache);
+        free(blocks);
+    } else {
+        printf("📄 Loaded block: %s\n", path);
+        printf("📏 Size: %.2f MB\n", input.file_size / (1024.0 * 1024.0));
+        parse_block(&store, input.data, (size_t)input.file_size);
+        if (rungcode) parse_rung_block(&rungs, input.data, (size_t)input.file_size, jobs);
+        if (columnar_file && tag_table_init(&tags) == 0) {
+            parse_tag_block(&tags, input.data, (size_t)input.file_size);
+        }
+    }
+    if (rungs.count) {
+        printf("🪜 Decoded %zu rungs", rungs.count);
+        if (rungs.bad) printf(" (%zu with unknown code, kept as NOP();)", rungs.bad);
+        printf("\n");
+        options.rungs = &rungs;
+    }
+    
+    // Generate L5X
+    int ret = generate_detailed_l5x(&store, &options, output_file) == 0 ? 0 : 1;
+    
+    if (columnar_file) {
+        if (component_store_build_index(&store) != 0 ||
+            acd_columnar_write(columnar_file, &store, &tags, &rungs) != 0) {
+            perror("Failed to write columnar file");
+            ret = 1;
+        } else {
+            printf("🧱 Columnar file: %s (%zu components, %zu tags, %zu rungs)\n", columnar_file,
+                   store.count, tags.count, rungs.count);
+        }
+    }
+    
+    tag_table_free(&tags);
+    rung_table_free(&rungs);
+    component_store_free(&store);
+    acd_file_close(&input);
+    return ret;
+}
+
+static int cmd_export(int argc, char *argv[]) {
+    int jobs = 1;
+    long cache_limit = 0;
+    const char *path = NULL, *output_file = NULL, *cache_dir = NULL, *dump_dir = NULL;
+    int positional = 0, rungcode = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--dump-blocks") == 0) {
+            dump_dir = "extracted_blocks";
+        } else if (strncmp(argv[i], "--dump-blocks=", 14) == 0) {
+            dump_dir = argv[i] + 14;
+        } else if (strcmp(argv[i], "--rungcode") == 0) {
+            rungcode = 1;
+        } else if (strcmp(argv[i], "--block-cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--block-cache-limit") == 0 && i + 1 < argc) {
+            cache_limit = atol(argv[++i]);
+        } else if (positional == 0) {
+            path = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            output_file = argv[i];
+            positional++;
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || !is_acd_path(path)) {
+        printf("Usage: acd export [--jobs N] [--dump-blocks[=DIR]] [--block-cache DIR [--block-cache-limit MB]]\n");
+        printf("                  [--rungcode] <project.ACD> [output.L5X]\n");
+        printf("   --jobs N             decode routines and render L5X sections on N threads\n");
+        printf("   --dump-blocks[=DIR]  also write every block to DIR (default extracted_blocks)\n");
+        printf("%s", RUNGCODE_USAGE);
+        printf("   Output defaults to <project>.L5X in the current directory\n");
+        return 1;
+    }
+    if (jobs <= 0) {
+        jobs = acd_cpu_count();
+    }
+    
+    // Project.ACD -> Project.L5X
+    char default_output[4096];
+    if (!output_file) {
+        const char *name = strrchr(path, '/');
+        name = name ? name + 1 : path;
+        snprintf(default_output, sizeof(default_output), "%.*s.L5X", (int)(strlen(name) - 4), name);
+        output_file = default_output;
+    }
+    
+    stats_path = path;
+    printf("📤 ACD → L5X export: %s → %s\n\n", path, output_file);
+    
+    ACD_File acd;
+    if (acd_file_open(&acd, path) != 0) {
+        perror("Failed to open input file");
+        return 1;
+    }
+    
+    L5xOptions options = {0};
+    char header_text[512];
+    ACD_Header header;
+    acd.binary_start = acd_find_binary_start(&acd);
+    if (acd_header_parse(&acd, &header) == 0) {
+        acd_l5x_options_from_header(&options, &header, header_text, sizeof(header_text));
+        acd_header_free(&header);
+    }
+    options.jobs = jobs;
+    
+    CompressedBlock *blocks = NULL;
+    size_t block_count = 0;
+    ComponentStore store;
+    RungTable rungs;
+    rung_table_init(&rungs);
+    if (component_store_init(&store) != 0 ||
+        acd_index_blocks(path, &acd, &blocks, &block_count, NULL) != 0) {
+        perror("Failed to index compressed blocks");
+        component_store_free(&store);
+        acd_file_close(&acd);
+        return 1;
+    }
+    
+    // Comps, RungCode (with --rungcode) and (with --dump-blocks) every
+    // other member in one pass over the mapping
+    BlockCache *cache = open_block_cache(cache_dir, cache_limit);
+    ExportOptions export_options = { jobs, dump_dir, cache, rungcode, NULL };
+    ExportStats export_stats;
+    int ret = acd_export_collect(&store, &rungs, NULL, &acd, blocks, block_count, &export_options,
+                                 &export_stats);
+    report_block_cache(cache);
+    acd_block_cache_close(cache);
+    free(blocks);
+    
+    if (ret != 0) {
+        perror(dump_dir ? "Export failed (is the dump directory writable?)" : "Export failed");
+    } else {
+        report_export(&export_stats, dump_dir);
+        if (rungs.count) {
+            printf("🪜 Decoded %zu rungs", rungs.count);
+            if (rungs.bad) printf(" (%zu with unknown code, kept as NOP();)", rungs.bad);
+            printf("\n");
+            options.rungs = &rungs;
+        }
+        ret = generate_detailed_l5x(&store, &options, output_file);
+    }
+    
+    rung_table_free(&rungs);
+    component_store_free(&store);
+    acd_file_close(&acd);
+    return ret == 0 ? 0 : 1;
+}
+
+// "[2,3]" for an array tag, "" for a scalar
+static void format_dimensions(const TagTable *table, size_t i, char *out, size_t size) {
+    int dims = tag_dimensions(table, i);
+    const uint32_t d[3] = { table->dim0[i], table->dim1[i], table->dim2[i] };
+    if (dims == 0) {
+        out[0] = '\0';
+    } else if (dims == 1) {
+        snprintf(out, size, "[%u]", d[0]);
+    } else if (dims == 2) {
+        snprintf(out, size, "[%u,%u]", d[0], d[1]);
+    } else {
+        snprintf(out, size, "[%u,%u,%u]", d[0], d[1], d[2]);
+    }
+}
+
+static int cmd_tags(int argc, char *argv[]) {
+    const char *path = NULL, *type_name = NULL, *program = NULL;
+    int controller_only = 0, list_datatypes = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            type_name = argv[++i];
+        } else if (strcmp(argv[i], "--program") == 0 && i + 1 < argc) {
+            program = argv[++i];
+        } else if (strcmp(argv[i], "--controller") == 0) {
+            controller_only = 1;
+        } else if (strcmp(argv[i], "--datatypes") == 0) {
+            list_datatypes = 1;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || (program && controller_only)) {
+        printf("Usage: acd tags [--type NAME] [--program NAME | --controller] [--datatypes] <project.ACD>\n");
+        printf("   --type NAME     only tags of this data type (e.g. TIMER)\n");
+        printf("   --program NAME  only tags of this program\n");
+        printf("   --controller    only controller-scoped tags\n");
+        printf("   --datatypes     also list the data type definitions and their members\n");
+        return 1;
+    }
+    stats_path = path;
+    
+    ACD_File acd;
+    if (acd_file_open(&acd, path) != 0) {
+        perror("Failed to open file");
+        return 1;
+    }
+    acd.binary_start = acd_find_binary_start(&acd);
+    
+    CompressedBlock *blocks = NULL;
+    size_t block_count = 0;
+    TagTable table;
+    if (tag_table_init(&table) != 0 ||
+        acd_index_blocks(path, &acd, &blocks, &block_count, NULL) != 0) {
+        perror("Failed to index compressed blocks");
+        tag_table_free(&table);
+        acd_file_close(&acd);
+        return 1;
+    }
+    long decoded = parse_acd_tags(&table, &acd, blocks, block_count);
+    free(blocks);
+    if (decoded < 0) {
+        perror("Failed to decode tags");
+        tag_table_free(&table);
+        acd_file_close(&acd);
+        return 1;
+    }
+    
+    uint32_t type = TAG_TYPE_ANY;
+    if (type_name) {
+        type = tag_table_type_id(&table, type_name);
+    }
+    uint32_t scope = controller_only ? TAG_SCOPE_CONTROLLER : TAG_SCOPE_ANY;
+    if (program) {
+        scope = tag_table_program_scope(&table, program);
+    }
+    size_t matches = 0;
+    if ((!type_name || type != TAG_TYPE_ANY) && (!program || scope != TAG_SCOPE_ANY)) {
+        matches = tag_table_select(&table, type, scope, NULL, 0);
+    }
+    uint32_t *selected = malloc((matches ? matches : 1) * sizeof(*selected));
+    if (!selected) {
+        tag_table_free(&table);
+        acd_file_close(&acd);
+        return 1;
+    }
+    if (matches) {
+        tag_table_select(&table, type, scope, selected, matches);
+    }
+    
+    for (size_t k = 0; k < matches && !acd_quiet; k++) {
+        size_t i = selected[k];
+        char dims[48];
+        format_dimensions(&table, i, dims, sizeof(dims));
+        const char *scope_name = table.scope[i] ? tag_scope_name(&table, table.scope[i]) : "controller";
+        printf("   %s : %s%s  (%s, %s", tag_name(&table, i), tag_type_name(&table, table.type[i]),
+               dims, scope_name, tag_access_name(table.access[i]));
+        if (table.alias[i]) printf(", alias for %s", tag_str(&table, table.alias[i]));
+        printf(")\n");
+    }
+    for (size_t d = 0; list_datatypes && d < table.def_count && !acd_quiet; d++) {
+        printf("   DataType %s (%s, %s)\n", tag_type_name(&table, table.def_type[d]),
+               tag_str(&table, table.def_class[d]), tag_str(&table, table.def_family[d]));
+        for (size_t m = table.def_member_start[d]; m < table.def_member_start[d + 1]; m++) {
+            printf("      %s : %s", tag_str(&table, table.member_name[m]), tag_type_name(&table, table.member_type[m]));
+            if (table.member_dim[m]) printf("[%u]", table.member_dim[m]);
+            printf("%s\n", table.member_hidden[m] ? "  (hidden)" : "");
+        }
+    }
+    printf("\n🏷️  %zu of %zu tags, %zu programs, %zu data type definitions (%zu members)\n", matches,
+           table.count, table.program_count, table.def_count, table.member_count);
+    
+    free(selected);
+    tag_table_free(&table);
+    acd_file_close(&acd);
+    return 0;
+}
+
+static const char *diff_mark(DiffStatus status) {
+    switch (status) {
+        case DIFF_MODIFIED: return "✏️  Modified";
+        case DIFF_ADDED: return "➕ Added   ";
+        case DIFF_REMOVED: return "➖ Removed ";
+        default: return "   Same    ";
+    }
+}
+
+// One changed block, with its offsets on whichever sides it exists
+static void print_block_diff(const BlockDiff *d, const CompressedBlock *old_blocks,
+                             const CompressedBlock *new_blocks) {
+    const CompressedBlock *a = d->old_index >= 0 ? &old_blocks[d->old_index] : NULL;
+    const CompressedBlock *b = d->new_index >= 0 ? &new_blocks[d->new_index] : NULL;
+    const CompressedBlock *any = b ? b : a;
+    printf("   %s %-6s block", diff_mark(d->status), acd_block_kind_name(any->kind));
+    if (a) printf("  old 0x%lx (%u bytes, CRC32 %08x)", a->offset, a->uncompressed_size, a->crc32);
+    if (b) printf("  new 0x%lx (%u bytes, CRC32 %08x)", b->offset, b->uncompressed_size, b->crc32);
+    printf("\n");
+}
+
+static void print_component_diff(const AcdDiff *diff, const ComponentDiff *d) {
+    const ComponentStore *a = &diff->old_store, *b = &diff->new_store;
+    const Component *old_comp = d->old_index >= 0 ? &a->items[d->old_index] : NULL;
+    const Component *new_comp = d->new_index >= 0 ? &b->items[d->new_index] : NULL;
+    const ComponentStore *store = new_comp ? b : a;
+    const Component *comp = new_comp ? new_comp : old_comp;
+    printf("   %s UID %u  %s (%s)", diff_mark(d->status), d->uid, component_str(store, comp->name),
+           component_str(store, comp->type));
+    if (d->changed & COMP_DIFF_NAME) printf("  name: %s → %s", component_str(a, old_comp->name), component_str(b, new_comp->name));
+    if (d->changed & COMP_DIFF_TYPE) printf("  type: %s → %s", component_str(a, old_comp->type), component_str(b, new_comp->type));
+    if (d->changed & COMP_DIFF_PARENT) printf("  parent: %u → %u", old_comp->parent_uid, new_comp->parent_uid);
+    if (d->changed & COMP_DIFF_ORDINAL) printf("  ordinal: %u → %u", old_comp->ordinal, new_comp->ordinal);
+    if (d->changed & COMP_DIFF_IOI) printf("  ioi changed");
+    printf("\n");
+}
+
+static int cmd_diff(int argc, char *argv[]) {
+    const char *paths[2] = { NULL, NULL };
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (positional < 2 && argv[i][0] != '-') {
+            paths[positional++] = argv[i];
+        } else {
+            positional = 0;
+            break;
+        }
+    }
+    if (positional != 2) {
+        printf("Usage: acd diff <old.ACD> <new.ACD>\n");
+        printf("   Pairs blocks by index CRC32/size, inflates only the changed ones and\n");
+        printf("   lists added, removed and modified components by UID.\n");
+        printf("   Exit status: 0 identical, 1 different, 2 trouble\n");
+        return 2;
+    }
+    stats_path = paths[1];
+    
+    ACD_File acd[2];
+    CompressedBlock *blocks[2] = { NULL, NULL };
+    size_t counts[2] = { 0, 0 };
+    int opened = 0;
+    for (; opened < 2; opened++) {
+        if (acd_file_open(&acd[opened], paths[opened]) != 0) {
+            perror(paths[opened]);
+            break;
+        }
+        if (acd_index_blocks(paths[opened], &acd[opened], &blocks[opened], &counts[opened], NULL) != 0) {
+            perror("Failed to index compressed blocks");
+            acd_file_close(&acd[opened]);
+            break;
+        }
+    }
+    if (opened < 2) {
+        for (int i = 0; i < opened; i++) {
+            free(blocks[i]);
+            acd_file_close(&acd[i]);
+        }
+        return 2;
+    }
+    
+    printf("🔍 Diffing %s → %s\n", paths[0], paths[1]);
+    AcdDiff diff;
+    int ret = 2;
+    if (acd_diff_run(&diff, &acd[0], blocks[0], counts[0], &acd[1], blocks[1], counts[1]) != 0) {
+        perror("Diff failed");
+    } else {
+        printf("\n📦 Blocks: %zu unchanged (not inflated), %zu modified, %zu added, %zu removed\n",
+               diff.blocks_same, diff.blocks_modified, diff.blocks_added, diff.blocks_removed);
+        for (size_t i = 0; i < diff.block_count && !acd_quiet; i++) {
+            if (diff.blocks[i].status != DIFF_SAME) print_block_diff(&diff.blocks[i], blocks[0], blocks[1]);
+        }
+        printf("\n🧩 Components: %zu added, %zu removed, %zu modified\n",
+               diff.comps_added, diff.comps_removed, diff.comps_modified);
+        for (size_t i = 0; i < diff.component_count && !acd_quiet; i++) {
+            print_component_diff(&diff, &diff.components[i]);
+        }
+        ret = diff.blocks_same == diff.block_count ? 0 : 1;
+    }
+    
+    acd_diff_free(&diff);
+    for (int i = 0; i < 2; i++) {
+        free(blocks[i]);
+        acd_file_close(&acd[i]);
+    }
+    return ret;
+}
+
+static int cmd_batch(int argc, char *argv[]) {
+    int jobs = 0, use_cache = 1, bad_args = 0, rungcode = 0;
+    long cache_limit = 0;
+    const char *out_dir = NULL, *manifest_path = NULL, *cache_dir = NULL;
+    PathList paths = {0};
+    
+    for (int i = 1; i < argc && !bad_args; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            manifest_path = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0 && i + 1 < argc) {
+            if (path_list_add_file(&paths, argv[++i]) < 0) {
+                fprintf(stderr, "❌ Cannot read file list %s\n", argv[i]);
+                bad_args = 1;
+            }
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            use_cache = 0;
+        } else if (strcmp(argv[i], "--block-cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--block-cache-limit") == 0 && i + 1 < argc) {
+            cache_limit = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--rungcode") == 0) {
+            rungcode = 1;
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            bad_args = 1;
+        } else {
+            // A directory contributes every ACD under it
+            struct stat st;
+            long added = stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)
+                ? path_list_add_dir(&paths, argv[i]) : path_list_add(&paths, argv[i]);
+            if (added < 0) {
+                fprintf(stderr, "❌ Cannot read %s\n", argv[i]);
+                bad_args = 1;
+            }
+        }
+    }
+    if (bad_args || !paths.count) {
+        printf("Usage: acd batch [--jobs N] [--out DIR] [--manifest FILE] [--list FILE] [--no-cache]\n");
+        printf("                 [--block-cache DIR [--block-cache-limit MB]] [--rungcode] <dir | project.ACD>...\n");
+        printf("   --jobs N         convert N files at a time (default one per CPU)\n");
+        printf("   --out DIR        write the L5X files to DIR (default next to each ACD)\n");
+        printf("   --manifest FILE  JSON summary of the run (default <out>/acd_batch_manifest.json)\n");
+        printf("   --list FILE      read ACD paths from FILE, one per line (- = stdin)\n");
+        printf("%s", RUNGCODE_USAGE);
+        path_list_free(&paths);
+        return 1;
+    }
+    path_list_sort(&paths);
+    if (out_dir && mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+        perror("Failed to create output directory");
+        path_list_free(&paths);
+        return 1;
+    }
+    char default_manifest[4096];
+    if (!manifest_path) {
+        snprintf(default_manifest, sizeof(default_manifest), "%s/acd_batch_manifest.json",
+                 out_dir ? out_dir : ".");
+        manifest_path = default_manifest;
+    }
+    BatchResult *results = calloc(paths.count, sizeof(*results));
+    if (!results) {
+        path_list_free(&paths);
+        return 1;
+    }
+    
+    stats_path = out_dir ? out_dir : ".";
+    printf("📦 Batch converting %zu ACD files\n", paths.count);
+    fflush(stdout);
+    
+    // The library's per-file banners would interleave across workers; the
+    // progress lines (unless -q) report each file instead
+    int quiet = acd_quiet;
+    acd_quiet = 1;
+    BlockCache *cache = open_block_cache(cache_dir, cache_limit);
+    BatchOptions options = { jobs, out_dir, use_cache, cache, NULL, quiet ? NULL : stdout, rungcode };
+    uint64_t start = acd_now_ns();
+    long failed = acd_batch_run((const char *const *)paths.items, paths.count, &options, results);
+    uint64_t wall_ns = acd_now_ns() - start;
+    acd_quiet = quiet;
+    
+    report_block_cache(cache);
+    acd_block_cache_close(cache);
+    
+    int ret = failed == 0 ? 0 : 1;
+    if (failed < 0) {
+        perror("Failed to start batch");
+    } else {
+        FILE *manifest = fopen(manifest_path, "w");
+        if (!manifest || acd_batch_write_manifest(manifest, results, paths.count, wall_ns) != 0) {
+            perror("Failed to write manifest");
+            ret = 1;
+        }
+        if (manifest) fclose(manifest);
+        
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < paths.count; i++) bytes += results[i].bytes;
+        printf("\n📊 %zu converted, %ld failed, %.2f MB in %.2f s (%.1f MB/s)\n",
+               paths.count - (size_t)failed, failed, bytes / 1e6, wall_ns / 1e9,
+               wall_ns ? bytes / (wall_ns / 1e9) / 1e6 : 0.0);
+        printf("📝 Manifest: %s\n", manifest_path);
+    }
+    
+    acd_batch_results_free(results, paths.count);
+    free(results);
+    path_list_free(&paths);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    // Options every command takes are handled here and dropped from argv
+    int stats = 0, kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0 || strcmp(argv[i], "-q") == 0) {
+            acd_quiet = 1;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            stats = 1;
+        } else if (strncmp(argv[i], "--stats", 7) == 0) {
+            fprintf(stderr, "❌ Unknown stats format: %s (only --stats=json)\n", argv[i]);
+            return 1;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    int (*command)(int, char *[]) = NULL;
+    if (strcmp(argv[1], "scan") == 0) {
+        command = cmd_scan;
+    } else if (strcmp(argv[1], "extract") == 0) {
+        command = cmd_extract;
+    } else if (strcmp(argv[1], "parse") == 0) {
+        command = cmd_parse;
+    } else if (strcmp(argv[1], "export") == 0) {
+        command = cmd_export;
+    } else if (strcmp(argv[1], "tags") == 0) {
+        command = cmd_tags;
+    } else if (strcmp(argv[1], "diff") == 0) {
+        command = cmd_diff;
+    } else if (strcmp(argv[1], "batch") == 0) {
+        command = cmd_batch;
+    }
+    if (!command) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    uint64_t start = acd_now_ns();
+    int ret = command(argc - 1, argv + 1);
+    if (stats && stats_path) {
+        acd_stats_write_json(stdout, argv[1], stats_path, acd_now_ns() - start);
+    }
+    return ret;
+}
@@ -0,0 +1,66 @@
+#ifndef ACD_H
+#define ACD_H
+
+// libacd: in-memory access to Studio 5000 .ACD project files
+//
+//   acd_file        mapped file and header/binary boundary
+//   acd_header      text header key/value parser
+//   acd_scan        gzip member candidate scanner
+//   acd_inflate     one-shot member decoder (zlib, libdeflate or ISA-L)
+//   acd_block       member probe/inflate, lazy block iterator
+//   acd_blockread   random reads inside one member, zran-style checkpoints
+//   acd_index       sidecar .acdidx block index
+//   acd_blockcache  content-addressed decompressed block cache
+//   acd_pool        work-stealing thread pool
+//   acd_pipeline    signature routing of inflated blocks to parsers
+//   acd_signatures  Aho-Corasick multi-pattern signature search
+//   acd_parser      header and block listing (scan)
+//   acd_extractor   block extraction to extracted_blocks/
+//   acd_store       component store and interned string pool
+//   acd_comps       Comps database parser
+//   acd_compcache   sidecar .acdcomps parsed-component cache
+//   acd_tags        TagInfo.XML decoder, columnar tag table
+//   acd_rll         ladder logic decoder for a hypothetical RungCode format
+//   acd_xml         buffered streaming XML writer
+//   acd_l5x         L5X export of the component tree
+//   acd_diff        block and component diff of two revisions
+//   acd_columnar    mappable columnar export of components, tags and rungs
+//   acd_export      single-pass ACD to L5X collection, optional block dump
+//   acd_batch       many-file ACD to L5X conversion with a manifest
+//   acd_stats       hot-path counters and timers, quiet mode
+//
+// Build (static and shared library, then the CLI):
+//   cc -O2 -fPIC -c acd_*.c
+//   ar rcs libacd.a acd_*.o
+//   cc -shared -o libacd.so acd_*.o -lz -pthread
+//   cc -O2 -o acd acd.c libacd.a -lz -pthread
+// Add -DACD_INFLATE_LIBDEFLATE (-ldeflate) or -DACD_INFLATE_ISAL (-lisal)
+// for a faster one-shot inflate backend.
+
+#include "acd_file.h"
+#include "acd_header.h"
+#include "acd_scan.h"
+#include "acd_inflate.h"
+#include "acd_block.h"
+#include "acd_blockread.h"
+#include "acd_index.h"
+#include "acd_blockcache.h"
+#include "acd_pool.h"
+#include "acd_pipeline.h"
+#include "acd_signatures.h"
+#include "acd_parser.h"
+#include "acd_extractor.h"
+#include "acd_store.h"
+#include "acd_compcache.h"
+#include "acd_comps.h"
+#include "acd_tags.h"
+#include "acd_rll.h"
+#include "acd_xml.h"
+#include "acd_l5x.h"
+#include "acd_diff.h"
+#include "acd_columnar.h"
+#include "acd_export.h"
+#include "acd_batch.h"
+#include "acd_stats.h"
+
+#endif
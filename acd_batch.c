@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdatomic.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "acd_batch.h"
+#include "acd_file.h"
+#include "acd_header.h"
+#include "acd_index.h"
+#include "acd_comps.h"
+#include "acd_rll.h"
+#include "acd_l5x.h"
+#include "acd_export.h"
+#include "acd_pool.h"
+#include "acd_stats.h"
+
+int path_list_add(PathList *list, const char *path) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        char **grown = realloc(list->items, capacity * sizeof(*grown));
+        if (!grown) {
+            return -1;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    char *copy = strdup(path);
+    if (!copy) {
+        return -1;
+    }
+    list->items[list->count++] = copy;
+    return 0;
+}
+
+static int is_acd_name(const char *name) {
+    size_t len = strlen(name);
+    return len > 4 && strcasecmp(name + len - 4, ".acd") == 0;
+}
+
+long path_list_add_dir(PathList *list, const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        return -1;
+    }
+    long added = 0;
+    struct dirent *entry;
+    char path[4096];
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= sizeof(path)) continue;
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            long n = path_list_add_dir(list, path);
+            if (n > 0) added += n;
+        } else if (S_ISREG(st.st_mode) && is_acd_name(entry->d_name)) {
+            if (path_list_add(list, path) != 0) {
+                added = -1;
+                break;
+            }
+            added++;
+        }
+    }
+    closedir(d);
+    return added;
+}
+
+long path_list_add_file(PathList *list, const char *list_path) {
+    FILE *f = strcmp(list_path, "-") == 0 ? stdin : fopen(list_path, "r");
+    if (!f) {
+        return -1;
+    }
+    long added = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (!len) continue;
+        if (path_list_add(list, line) != 0) {
+            added = -1;
+            break;
+        }
+        added++;
+    }
+    if (f != stdin) fclose(f);
+    return added;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+void path_list_sort(PathList *list) {
+    qsort(list->items, list->count, sizeof(*list->items), compare_paths);
+}
+
+void path_list_free(PathList *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->items[i]);
+    }
+    free(list->items);
+    memset(list, 0, sizeof(*list));
+}
+
+// "dir/Name.ACD" -> "<out_dir or dir>/Name.L5X"
+static char *output_path(const char *path, const char *out_dir) {
+    const char *slash = strrchr(path, '/');
+    const char *name = slash ? slash + 1 : path;
+    size_t stem = strlen(name);
+    if (is_acd_name(name)) stem -= 4;
+
+    const char *dir = out_dir;
+    size_t dir_len = out_dir ? strlen(out_dir) : 0;
+    if (!out_dir && slash) {
+        dir = path;
+        dir_len = (size_t)(slash - path);
+    }
+    size_t size = dir_len + 1 + stem + sizeof(".L5X");
+    char *out = malloc(size);
+    if (out) {
+        if (dir) {
+            snprintf(out, size, "%.*s/%.*s.L5X", (int)dir_len, dir, (int)stem, name);
+        } else {
+            snprintf(out, size, "%.*s.L5X", (int)stem, name);
+        }
+    }
+    return out;
+}
+
+typedef struct {
+    const char *const *paths;
+    size_t count;
+    const BatchOptions *options;
+    BatchResult *results;
+    _Atomic size_t done;
+} BatchJob;
+
+static int write_l5x_file(const char *output, const ComponentStore *store, const L5xOptions *options,
+                          uint64_t *bytes) {
+    FILE *f = fopen(output, "wb");
+    if (!f) {
+        return -1;
+    }
+    XmlWriter w;
+    int ret = xml_writer_init(&w, f, 0);
+    if (ret == 0) {
+        ret = acd_l5x_write(&w, store, options);
+        *bytes = xml_writer_total(&w);
+    }
+    if (xml_writer_close(&w) != 0) ret = -1;
+    if (fclose(f) != 0) ret = -1;
+    return ret;
+}
+
+// One file, start to finish, on the calling thread
+static void convert_file(const BatchJob *job, const char *path, BatchResult *r) {
+    const BatchOptions *options = job->options;
+    ACD_File acd;
+    if (acd_file_open(&acd, path) != 0) {
+        r->error = "cannot open";
+        return;
+    }
+    r->bytes = (uint64_t)acd.file_size;
+
+    L5xOptions l5x = {0};
+    char header_text[512];
+    ACD_Header header;
+    acd.binary_start = acd_find_binary_start(&acd);
+    if (acd_header_parse(&acd, &header) == 0) {
+        acd_l5x_options_from_header(&l5x, &header, header_text, sizeof(header_text));
+        acd_header_free(&header);
+    }
+    l5x.export_date = options->export_date;
+    l5x.jobs = 1;
+
+    CompressedBlock *blocks = NULL;
+    size_t count = 0;
+    ComponentStore store;
+    RungTable rungs;
+    rung_table_init(&rungs);
+    if (component_store_init(&store) != 0) {
+        r->error = "out of memory";
+        acd_file_close(&acd);
+        return;
+    }
+
+    // Comps and (with rungcode) RungCode in one pass, as acd export does
+    ExportOptions export_options = {
+        1, NULL, options->block_cache, options->rungcode, options->use_cache ? path : NULL,
+    };
+    if (acd_index_blocks(path, &acd, &blocks, &count, NULL) != 0) {
+        r->error = "cannot index blocks";
+    } else if (acd_export_collect(&store, &rungs, NULL, &acd, blocks, count, &export_options, NULL) != 0) {
+        r->error = options->rungcode ? "Comps or RungCode decode failed" : "Comps decode failed";
+    } else if (!store.count) {
+        r->error = "no Comps database";
+    } else {
+        if (rungs.count) l5x.rungs = &rungs;
+        if (write_l5x_file(r->output, &store, &l5x, &r->l5x_bytes) != 0) {
+            r->error = "cannot write L5X";
+        } else {
+            r->status = 0;
+        }
+    }
+    r->blocks = count;
+    r->components = store.count;
+    r->rungs = rungs.count;
+
+    free(blocks);
+    rung_table_free(&rungs);
+    component_store_free(&store);
+    acd_file_close(&acd);
+}
+
+static void batch_task(void *arg, size_t index, int worker) {
+    (void)worker;
+    BatchJob *job = arg;
+    // The next file of this worker's range is read in while this one parses
+    if (index + 1 < job->count) {
+        acd_file_prefetch(job->paths[index + 1]);
+    }
+
+    BatchResult *r = &job->results[index];
+    uint64_t start = acd_now_ns();
+    if (!r->error) {
+        convert_file(job, r->path, r);
+    }
+    r->ns = acd_now_ns() - start;
+
+    size_t done = atomic_fetch_add(&job->done, 1) + 1;
+    if (job->options->progress) {
+        if (r->status == 0) {
+            fprintf(job->options->progress, "✅ [%zu/%zu] %s → %s (%zu components, %zu rungs, %.1f ms)\n",
+                    done, job->count, r->path, r->output, r->components, r->rungs, r->ns / 1e6);
+        } else {
+            fprintf(job->options->progress, "❌ [%zu/%zu] %s: %s\n", done, job->count, r->path, r->error);
+        }
+    }
+}
+
+static int compare_outputs(const void *a, const void *b) {
+    const BatchResult *x = *(const BatchResult *const *)a, *y = *(const BatchResult *const *)b;
+    return strcasecmp(x->output, y->output);
+}
+
+// Name every output before anything runs. Inputs that would write the
+// same L5X (equal names in different directories under one --out, or the
+// same file twice) all fail, rather than one silently overwriting
+// another; names compare case-insensitively for case-folding filesystems.
+static int assign_outputs(const char *const *paths, size_t count, const char *out_dir,
+                          BatchResult *results) {
+    BatchResult **order = malloc(count * sizeof(*order));
+    if (!order) {
+        return -1;
+    }
+    size_t named = 0;
+    for (size_t i = 0; i < count; i++) {
+        BatchResult *r = &results[i];
+        r->path = paths[i];
+        r->status = -1;
+        r->output = output_path(r->path, out_dir);
+        if (r->output) {
+            order[named++] = r;
+        } else {
+            r->error = "out of memory";
+        }
+    }
+    qsort(order, named, sizeof(*order), compare_outputs);
+    for (size_t i = 0; i < named;) {
+        size_t end = i + 1;
+        while (end < named && strcasecmp(order[end]->output, order[i]->output) == 0) end++;
+        for (size_t k = i; end - i > 1 && k < end; k++) {
+            order[k]->error = "L5X name collides with another input's";
+        }
+        i = end;
+    }
+    free(order);
+    return 0;
+}
+
+long acd_batch_run(const char *const *paths, size_t count, const BatchOptions *options,
+                   BatchResult *results) {
+    memset(results, 0, count * sizeof(*results));
+    if (!count) {
+        return 0;
+    }
+    if (assign_outputs(paths, count, options->out_dir, results) != 0) {
+        return -1;
+    }
+    int jobs = options->jobs > 0 ? options->jobs : acd_cpu_count();
+    ThreadPool *pool = acd_pool_create(jobs < (int)count ? jobs : (int)count);
+    if (!pool) {
+        return -1;
+    }
+    BatchJob job = { paths, count, options, results, 0 };
+    acd_pool_run(pool, count, batch_task, &job);
+    acd_pool_destroy(pool);
+    inflate_context_pool_drain();
+
+    long failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].status != 0) failed++;
+    }
+    return failed;
+}
+
+int acd_batch_write_manifest(FILE *out, const BatchResult *results, size_t count, uint64_t wall_ns) {
+    uint64_t bytes = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += results[i].bytes;
+        if (results[i].status != 0) failed++;
+    }
+    double seconds = wall_ns / 1e9;
+    fprintf(out, "{\"version\":1,\"files\":%zu,\"ok\":%zu,\"failed\":%zu,\"bytes\":%llu,"
+                 "\"wall_ns\":%llu,\"mb_per_s\":%.1f,\"results\":[\n",
+            count, count - failed, failed, (unsigned long long)bytes, (unsigned long long)wall_ns,
+            seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+    for (size_t i = 0; i < count; i++) {
+        const BatchResult *r = &results[i];
+        fputs("{\"path\":", out);
+        acd_json_write_string(out, r->path);
+        fputs(",\"output\":", out);
+        acd_json_write_string(out, r->output);
+        fprintf(out, ",\"status\":\"%s\"", r->status == 0 ? "ok" : "failed");
+        if (r->status != 0) {
+            fputs(",\"error\":", out);
+            acd_json_write_string(out, r->error);
+        }
+        fprintf(out, ",\"bytes\":%llu,\"blocks\":%zu,\"components\":%zu,\"rungs\":%zu,"
+                     "\"l5x_bytes\":%llu,\"ns\":%llu}%s\n",
+                (unsigned long long)r->bytes, r->blocks, r->components, r->rungs,
+                (unsigned long long)r->l5x_bytes, (unsigned long long)r->ns, i + 1 < count ? "," : "");
+    }
+    fputs("]}\n", out);
+    return fflush(out) == 0 && !ferror(out) ? 0 : -1;
+}
+
+void acd_batch_results_free(BatchResult *results, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(results[i].output);
+        results[i].output = NULL;
+    }
+}
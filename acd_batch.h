@@ -0,0 +1,75 @@
+#ifndef ACD_BATCH_H
+#define ACD_BATCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_blockcache.h"
+
+// Batch conversion of many ACDs to L5X in one process
+//
+// Files are the tasks of a single thread pool, each converted start to
+// finish on one worker (index, Comps, RungCode on request, L5X), so
+// nothing is paid per file beyond the work itself: inflate states come
+// from the shared pool (inflate_context_acquire), the block cache is
+// opened once, and while a worker parses one file the next one in its
+// range is already being read in (acd_file_prefetch).
+
+// Growable list of paths (copies owned by the list)
+typedef struct {
+    char **items;
+    size_t count;
+    size_t capacity;
+} PathList;
+
+int path_list_add(PathList *list, const char *path);
+
+// Every *.ACD under dir (recursively); returns the number added or -1
+long path_list_add_dir(PathList *list, const char *dir);
+
+// One path per line of the file at list_path ("-" = stdin); blank lines
+// are skipped. Returns the number added or -1.
+long path_list_add_file(PathList *list, const char *list_path);
+
+void path_list_sort(PathList *list);
+void path_list_free(PathList *list);
+
+typedef struct {
+    int jobs;                    // Files in flight (<= 0: one per CPU)
+    const char *out_dir;         // NULL: each L5X next to its ACD
+    int use_cache;               // Read and write the .acdcomps component caches
+    BlockCache *block_cache;     // Shared by every file; may be NULL
+    const char *export_date;     // NULL = now
+    FILE *progress;              // One line per finished file; may be NULL
+    int rungcode;                // Decode RungCode blocks (hypothetical format, see acd_rll.h)
+} BatchOptions;
+
+typedef struct {
+    const char *path;            // The input (not owned)
+    char *output;                // L5X path (owned)
+    int status;                  // 0, or -1 with error set
+    const char *error;           // Static text
+    uint64_t bytes;              // ACD size
+    size_t blocks;
+    size_t components;
+    size_t rungs;
+    uint64_t l5x_bytes;
+    uint64_t ns;                 // Wall time of this file's conversion
+} BatchResult;
+
+// Convert every path, filling results[i] for paths[i]. The L5X of
+// "dir/Name.ACD" is "Name.L5X" in out_dir (or dir); inputs whose L5X
+// names collide (case-insensitively) all fail without writing anything.
+// Returns the number of files that failed, or -1 if the run couldn't
+// start.
+long acd_batch_run(const char *const *paths, size_t count, const BatchOptions *options,
+                   BatchResult *results);
+
+// Manifest of a run as JSON: totals, then one object per file (input
+// order), one per line. Returns 0, or -1 on write error.
+int acd_batch_write_manifest(FILE *out, const BatchResult *results, size_t count, uint64_t wall_ns);
+
+void acd_batch_results_free(BatchResult *results, size_t count);
+
+#endif
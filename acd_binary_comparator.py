@@ -4,11 +4,14 @@ ACD Binary Comparator - Compare two ACD files to understand format changes
 """
 
 import sys
-import gzip
 from pathlib import Path
 import struct
 import difflib
 
+from acd_gzip_members import gzip_members, libacd
+
+CHUNK = 1 << 16
+
 class ACDBinaryComparator:
     """Compare two ACD files at the binary level"""
     
@@ -19,6 +22,7 @@ class ACDBinaryComparator:
         self.file2_data = None
         self.file1_blocks = []
         self.file2_blocks = []
+        self.acd_files = []
     
     def load_files(self):
         """Load both ACD files"""
@@ -37,37 +41,53 @@ class ACDBinaryComparator:
         print(f"   File 2: {len(self.file2_data):,} bytes")
         print(f"   Difference: {len(self.file2_data) - len(self.file1_data):+,} bytes")
     
-    def extract_gzip_blocks(self, data: bytes) -> list:
-        """Extract all GZIP blocks from data"""
-        blocks = []
-        offset = 0
-        
-        while offset < len(data):
-            pos = data.find(b'\x1F\x8B', offset)
-            if pos == -1:
-                break
-            
-            # Try to decompress with various sizes
-            for size in [1000, 10000, 100000, 1000000, 10000000]:
-                if pos + size > len(data):
-                    size = len(data) - pos
-                
-                try:
-                    decompressed = gzip.decompress(data[pos:pos + size])
-                    blocks.append({
-                        'offset': pos,
-                        'compressed_size': size,
-                        'decompressed_size': len(decompressed),
-                        'data': decompressed
-                    })
-                    offset = pos + size
-                    break
-                except:
-                    continue
-            else:
-                offset = pos + 2
-        
-        return blocks
+    def extract_gzip_blocks(self, path: Path, data: bytes) -> list:
+        """
+        List all GZIP blocks of data (read from path). With libacd only the
+        block index is read: sizes and CRCs tell identical blocks apart, and
+        block_data() decodes just the ranges a comparison looks at.
+        """
+        if libacd is not None:
+            acd = libacd.AcdFile(str(path))
+            self.acd_files.append(acd)
+            return [
+                {
+                    'offset': pos,
+                    'compressed_size': compressed_size,
+                    'decompressed_size': decompressed_size,
+                    'crc32': crc32,
+                    'acd': acd,
+                    'data': None
+                }
+                for pos, compressed_size, decompressed_size, crc32, _kind in acd.blocks()
+            ]
+        return [
+            {
+                'offset': pos,
+                'compressed_size': compressed_size,
+                'decompressed_size': len(decompressed),
+                'crc32': None,
+                'acd': None,
+                'data': bytes(decompressed)
+            }
+            for pos, compressed_size, decompressed in gzip_members(path, data)
+        ]
+    
+    def block_data(self, block: dict, start: int = 0, length: int = None) -> bytes:
+        """Decoded bytes [start, start + length) of a block (to its end by default)"""
+        if length is None:
+            length = max(block['decompressed_size'] - start, 0)
+        if block['data'] is not None:
+            return block['data'][start:start + length]
+        return block['acd'].read(block['offset'], start, length)
+    
+    def blocks_identical(self, b1: dict, b2: dict) -> bool:
+        """Same decoded bytes: by size and CRC-32 when both are indexed"""
+        if b1['decompressed_size'] != b2['decompressed_size']:
+            return False
+        if b1['crc32'] is not None and b2['crc32'] is not None:
+            return b1['crc32'] == b2['crc32']
+        return self.block_data(b1) == self.block_data(b2)
     
     def compare_headers(self):
         """Compare file headers (text portion)"""
@@ -105,8 +125,8 @@ class ACDBinaryComparator:
         """Compare GZIP blocks between files"""
         print("\n📦 Extracting and comparing GZIP blocks:")
         
-        self.file1_blocks = self.extract_gzip_blocks(self.file1_data)
-        self.file2_blocks = self.extract_gzip_blocks(self.file2_data)
+        self.file1_blocks = self.extract_gzip_blocks(self.file1_path, self.file1_data)
+        self.file2_blocks = self.extract_gzip_blocks(self.file2_path, self.file2_data)
         
         print(f"\n   File 1: {len(self.file1_blocks)} blocks")
         print(f"   File 2: {len(self.file2_blocks)} blocks")
@@ -121,36 +141,42 @@ class ACDBinaryComparator:
                 print(f"      File 1: {b1['decompressed_size']:,} bytes")
                 print(f"      File 2: {b2['decompressed_size']:,} bytes")
                 
-                if b1['data'] != b2['data']:
+                if not self.blocks_identical(b1, b2):
                     print(f"      ⚠️  Block contents differ!")
-                    self.analyze_block_differences(b1['data'], b2['data'], i)
+                    self.analyze_block_differences(b1, b2, i)
                 else:
                     print(f"      ✅ Blocks are identical")
     
-    def analyze_block_differences(self, data1: bytes, data2: bytes, block_num: int):
+    def analyze_block_differences(self, b1: dict, b2: dict, block_num: int):
         """Analyze differences within a block"""
         print(f"\n🔍 Analyzing differences in Block {block_num}:")
         
-        # Find first difference
+        # Find first difference, decoding chunk by chunk only until it
         first_diff = -1
-        for i in range(min(len(data1), len(data2))):
-            if data1[i] != data2[i]:
-                first_diff = i
+        common = min(b1['decompressed_size'], b2['decompressed_size'])
+        for pos in range(0, common, CHUNK):
+            chunk1 = self.block_data(b1, pos, CHUNK)
+            chunk2 = self.block_data(b2, pos, CHUNK)
+            if chunk1 != chunk2:
+                first_diff = pos + next(
+                    (i for i, (x, y) in enumerate(zip(chunk1, chunk2)) if x != y),
+                    min(len(chunk1), len(chunk2))
+                )
                 break
         
-        if first_diff >= 0:
+        if 0 <= first_diff < common:
             print(f"   First difference at offset 0x{first_diff:X}")
             
             # Show context
             start = max(0, first_diff - 32)
-            end = min(len(data1), len(data2), first_diff + 32)
+            end = min(common, first_diff + 32)
             
             print(f"\n   Context around first difference:")
-            print(f"   File 1: {self.format_hex(data1[start:end], first_diff - start)}")
-            print(f"   File 2: {self.format_hex(data2[start:end], first_diff - start)}")
+            print(f"   File 1: {self.format_hex(self.block_data(b1, start, end - start), first_diff - start)}")
+            print(f"   File 2: {self.format_hex(self.block_data(b2, start, end - start), first_diff - start)}")
         
         # Look for added strings
-        self.find_new_strings(data1, data2)
+        self.find_new_strings(self.block_data(b1), self.block_data(b2))
     
     def format_hex(self, data: bytes, highlight_pos: int = -1) -> str:
         """Format bytes as hex with optional highlighting"""
@@ -207,6 +233,9 @@ class ACDBinaryComparator:
         self.compare_headers()
         self.compare_blocks()
         
+        for acd in self.acd_files:
+            acd.close()
+        
         print("\n✅ Comparison complete!")
 
 def main():
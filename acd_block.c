@@ -0,0 +1,633 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <zlib.h>
+#include <pthread.h>
+
+#include "acd_block.h"
+#include "acd_scan.h"
+#include "acd_blockcache.h"
+#include "acd_inflate.h"
+#include "acd_stats.h"
+
+#define PROBE_CHUNK 65536
+#define INITIAL_OUTPUT (256 * 1024)
+#define CLASSIFY_WINDOW 4096
+#define ONESHOT_PROBE_INITIAL (1024 * 1024)
+
+// Deflate can't expand input by more than about 1032:1
+#define MAX_DEFLATE_RATIO 1032
+
+// Idle inflate states kept for reuse
+#define INFLATE_POOL_MAX 64
+
+// Search only the head of a block; database names sit near the start
+static int head_contains(const unsigned char *data, size_t len, const char *needle) {
+    size_t n = strlen(needle);
+    if (len > CLASSIFY_WINDOW) len = CLASSIFY_WINDOW;
+    for (size_t i = 0; i + n <= len; i++) {
+        if (data[i] == (unsigned char)needle[0] && memcmp(data + i, needle, n) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t acd_block_classify(const unsigned char *data, size_t len) {
+    if (len >= 5 && memcmp(data, "<?xml", 5) == 0) {
+        return BLOCK_KIND_XML;
+    }
+    // UTF-16LE XML with a byte order mark (TagInfo.XML, QuickInfo.XML)
+    if (len >= 4 && data[0] == 0xFF && data[1] == 0xFE && data[2] == '<' && data[3] == 0) {
+        return BLOCK_KIND_XML;
+    }
+    if (head_contains(data, len, "CompUId") || head_contains(data, len, "Comps")) {
+        return BLOCK_KIND_COMPS;
+    }
+    return BLOCK_KIND_BINARY;
+}
+
+const char *acd_block_kind_name(uint32_t kind) {
+    switch (kind) {
+        case BLOCK_KIND_XML: return "xml";
+        case BLOCK_KIND_COMPS: return "comps";
+        default: return "binary";
+    }
+}
+
+static uint32_t read_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// FLG bits (RFC 1952)
+#define GZIP_FHCRC 0x02
+#define GZIP_FEXTRA 0x04
+#define GZIP_FNAME 0x08
+#define GZIP_FCOMMENT 0x10
+#define GZIP_FLG_RESERVED 0xE0
+
+// Highest OS value assigned (Acorn RISCOS), and 255 = unknown
+#define GZIP_OS_MAX 13
+
+// Skip a NUL-terminated header field at *pos; 0 if it runs off the end
+static int skip_zstring(const unsigned char *p, size_t avail, size_t *pos) {
+    if (*pos >= avail) {
+        return 0;
+    }
+    const unsigned char *nul = memchr(p + *pos, 0, avail - *pos);
+    if (!nul) {
+        return 0;
+    }
+    *pos = (size_t)(nul - p) + 1;
+    return 1;
+}
+
+long acd_gzip_header_size(const unsigned char *p, size_t avail) {
+    if (avail < GZIP_HEADER_SIZE ||
+        p[0] != 0x1F || p[1] != 0x8B || p[2] != 0x08 || (p[3] & GZIP_FLG_RESERVED)) {
+        return -1;
+    }
+    unsigned char flags = p[3], xfl = p[8], os = p[9];
+    if ((xfl != 0 && xfl != 2 && xfl != 4) || (os > GZIP_OS_MAX && os != 255)) {
+        return -1;
+    }
+
+    size_t pos = GZIP_HEADER_SIZE;
+    if (flags & GZIP_FEXTRA) {
+        if (avail - pos < 2) {
+            return -1;
+        }
+        size_t xlen = (size_t)p[pos] | ((size_t)p[pos + 1] << 8);
+        if (avail - pos - 2 < xlen) {
+            return -1;
+        }
+        pos += 2 + xlen;
+    }
+    if ((flags & GZIP_FNAME) && !skip_zstring(p, avail, &pos)) {
+        return -1;
+    }
+    if ((flags & GZIP_FCOMMENT) && !skip_zstring(p, avail, &pos)) {
+        return -1;
+    }
+    if (flags & GZIP_FHCRC) {
+        if (avail - pos < 2) {
+            return -1;
+        }
+        // Low 16 bits of the CRC32 of everything before it
+        uint32_t want = (uint32_t)p[pos] | ((uint32_t)p[pos + 1] << 8);
+        if ((crc32(0L, p, (uInt)pos) & 0xFFFF) != want) {
+            return -1;
+        }
+        pos += 2;
+    }
+    return (long)pos;
+}
+
+GzipCheck acd_gzip_check(const unsigned char *p, size_t avail) {
+    // Stage one: the member header
+    long header = acd_gzip_header_size(p, avail);
+    if (header < 0) {
+        return GZIP_REJECT_HEADER;
+    }
+    size_t pos = (size_t)header;
+
+    // Stage two: BFINAL (1 bit) and BTYPE (2 bits) of the first block
+    if (pos >= avail) {
+        return GZIP_REJECT_BLOCK;
+    }
+    unsigned btype = (p[pos] >> 1) & 3;
+    if (btype == 3) {
+        return GZIP_REJECT_BLOCK;
+    }
+    if (btype == 0) {
+        // Stored: the rest of the byte is padding, then LEN and ~LEN
+        if (avail - pos < 5) {
+            return GZIP_REJECT_BLOCK;
+        }
+        unsigned len = (unsigned)p[pos + 1] | ((unsigned)p[pos + 2] << 8);
+        unsigned nlen = (unsigned)p[pos + 3] | ((unsigned)p[pos + 4] << 8);
+        if ((len ^ nlen) != 0xFFFF) {
+            return GZIP_REJECT_BLOCK;
+        }
+    } else if (btype == 2) {
+        // Dynamic: HLIT (5 bits, + 257 <= 286) and HDIST (5 bits, + 1 <= 30)
+        if (avail - pos < 2) {
+            return GZIP_REJECT_BLOCK;
+        }
+        unsigned bits = (unsigned)p[pos] | ((unsigned)p[pos + 1] << 8);
+        unsigned hlit = (bits >> 3) & 31, hdist = (bits >> 8) & 31;
+        if (hlit > 29 || hdist > 29) {
+            return GZIP_REJECT_BLOCK;
+        }
+    }
+    return GZIP_CANDIDATE_OK;
+}
+
+static int grow_scratch(InflateContext *ctx, size_t want) {
+    if (ctx->scratch_cap >= want) {
+        return 0;
+    }
+    unsigned char *grown = realloc(ctx->scratch, want);
+    if (!grown) {
+        return -1;
+    }
+    ctx->scratch = grown;
+    ctx->scratch_cap = want;
+    return 0;
+}
+
+static int ensure_oneshot(InflateContext *ctx) {
+    if (!ctx->oneshot) {
+        ctx->oneshot = acd_inflater_create();
+    }
+    return ctx->oneshot ? 0 : -1;
+}
+
+// Fill block from a decoded member: in_used bytes starting at in
+static void finish_probe(CompressedBlock *block, const unsigned char *in, size_t in_used) {
+    // The 8-byte trailer (CRC32, ISIZE) ends the member
+    const unsigned char *trailer = in + in_used - 8;
+    block->compressed_size = (uint32_t)in_used;
+    block->crc32 = read_le32(trailer);
+    block->uncompressed_size = read_le32(trailer + 4);
+}
+
+// Probe with a backend that needs room for the whole member: decode into
+// the context's scratch buffer, doubling it while the output doesn't fit
+static int probe_oneshot(InflateContext *ctx, const unsigned char *in, size_t avail,
+                         CompressedBlock *block) {
+    if (ensure_oneshot(ctx) != 0 ||
+        grow_scratch(ctx, ONESHOT_PROBE_INITIAL) != 0) {
+        return -1;
+    }
+    size_t bound = avail > UINT32_MAX / MAX_DEFLATE_RATIO ? UINT32_MAX : avail * MAX_DEFLATE_RATIO + 64;
+
+    for (;;) {
+        size_t in_used, out_used;
+        AcdInflateResult ret = acd_inflater_gzip(ctx->oneshot, in, avail, ctx->scratch, ctx->scratch_cap,
+                                                 &in_used, &out_used);
+        if (ret == ACD_INFLATE_OK && in_used >= 18) {
+            block->kind = acd_block_classify(ctx->scratch, out_used);
+            finish_probe(block, in, in_used);
+            return 0;
+        }
+        if (ret != ACD_INFLATE_SHORT_OUTPUT || ctx->scratch_cap >= bound ||
+            grow_scratch(ctx, ctx->scratch_cap * 2) != 0) {
+            return -1;
+        }
+    }
+}
+
+// Decode a candidate that passed acd_gzip_check; 0 for a complete member
+static int probe_inflate(InflateContext *ctx, const unsigned char *in, size_t avail, CompressedBlock *block) {
+    if (acd_inflate_needs_whole_output()) {
+        return probe_oneshot(ctx, in, avail, block);
+    }
+
+    // Streaming: only a bounded window of output is kept
+    if (grow_scratch(ctx, PROBE_CHUNK) != 0) {
+        return -1;
+    }
+    if (!ctx->ready) {
+        if (inflateInit2(&ctx->strm, 16 + MAX_WBITS) != Z_OK) {
+            return -1;
+        }
+        ctx->ready = 1;
+    } else {
+        inflateReset(&ctx->strm);
+    }
+    z_stream *strm = &ctx->strm;
+    strm->next_in = (Bytef *)in;
+    strm->avail_in = avail > UINT_MAX ? UINT_MAX : (uInt)avail;
+
+    int ret;
+    int classified = 0;
+    do {
+        strm->next_out = ctx->scratch;
+        strm->avail_out = PROBE_CHUNK;
+        ret = inflate(strm, Z_NO_FLUSH);
+        if (!classified && strm->total_out > 0) {
+            block->kind = acd_block_classify(ctx->scratch, PROBE_CHUNK - strm->avail_out);
+            classified = 1;
+        }
+    } while (ret == Z_OK);
+
+    if (ret != Z_STREAM_END || strm->total_in < 18) {
+        return -1;
+    }
+    finish_probe(block, in, strm->total_in);
+    return 0;
+}
+
+int acd_block_probe_ctx(InflateContext *ctx, const ACD_File *acd, long offset, CompressedBlock *block) {
+    memset(block, 0, sizeof(*block));
+    block->offset = offset;
+
+    const unsigned char *in = acd_file_ptr(acd, offset, 0);
+    if (!in) {
+        return -1;
+    }
+    size_t avail = (size_t)(acd->file_size - offset);
+
+    // Most false positives fail on the header bytes alone
+    acd_stat_add(&acd_stats.candidates, 1);
+    GzipCheck check = acd_gzip_check(in, avail);
+    if (check != GZIP_CANDIDATE_OK) {
+        acd_stat_add(check == GZIP_REJECT_HEADER ? &acd_stats.rejected_header : &acd_stats.rejected_block, 1);
+        return -1;
+    }
+
+    uint64_t start = acd_now_ns();
+    int ret = probe_inflate(ctx, in, avail, block);
+    uint64_t elapsed = acd_now_ns() - start;
+    ctx->probe_ns += elapsed;
+    acd_stat_add(&acd_stats.probe_ns, elapsed);
+    acd_stat_add(ret == 0 ? &acd_stats.blocks : &acd_stats.rejected_inflate, 1);
+    return ret;
+}
+
+int acd_block_probe(const ACD_File *acd, long offset, CompressedBlock *block) {
+    InflateContext *ctx = inflate_context_acquire();
+    if (!ctx) {
+        return -1;
+    }
+    int ret = acd_block_probe_ctx(ctx, acd, offset, block);
+    inflate_context_release(ctx);
+    return ret;
+}
+
+void inflate_context_init(InflateContext *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void inflate_context_end(InflateContext *ctx) {
+    if (ctx->ready) {
+        inflateEnd(&ctx->strm);
+    }
+    acd_inflater_destroy(ctx->oneshot);
+    free(ctx->scratch);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static InflateContext *pool_idle[INFLATE_POOL_MAX];
+static size_t pool_idle_count;
+
+InflateContext *inflate_context_acquire(void) {
+    InflateContext *ctx = NULL;
+    pthread_mutex_lock(&pool_lock);
+    if (pool_idle_count) {
+        ctx = pool_idle[--pool_idle_count];
+    }
+    pthread_mutex_unlock(&pool_lock);
+    if (!ctx) {
+        ctx = malloc(sizeof(*ctx));
+        if (!ctx) return NULL;
+        inflate_context_init(ctx);
+    }
+    ctx->probe_ns = 0;
+    return ctx;
+}
+
+void inflate_context_release(InflateContext *ctx) {
+    if (!ctx) return;
+    pthread_mutex_lock(&pool_lock);
+    int kept = pool_idle_count < INFLATE_POOL_MAX;
+    if (kept) {
+        pool_idle[pool_idle_count++] = ctx;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    if (!kept) {
+        inflate_context_end(ctx);
+        free(ctx);
+    }
+}
+
+void inflate_context_pool_drain(void) {
+    pthread_mutex_lock(&pool_lock);
+    while (pool_idle_count) {
+        InflateContext *ctx = pool_idle[--pool_idle_count];
+        inflate_context_end(ctx);
+        free(ctx);
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+int acd_block_inflate_begin(InflateContext *ctx, const ACD_File *acd, const CompressedBlock *block) {
+    const unsigned char *in = acd_file_ptr(acd, block->offset, 0);
+    if (!in) {
+        return Z_DATA_ERROR;
+    }
+    size_t avail = (size_t)(acd->file_size - block->offset);
+
+    if (!ctx->ready) {
+        if (inflateInit2(&ctx->strm, 16 + MAX_WBITS) != Z_OK) {
+            return Z_MEM_ERROR;
+        }
+        ctx->ready = 1;
+    } else {
+        inflateReset(&ctx->strm);
+    }
+    ctx->strm.next_in = (Bytef *)in;
+    ctx->strm.avail_in = avail > UINT_MAX ? UINT_MAX : (uInt)avail;
+    return Z_OK;
+}
+
+// Account one acd_block_inflate_until call: its time and the bytes it
+// consumed and produced
+static void note_inflate(const z_stream *strm, uint64_t start, uLong in_before, uLong out_before, int ended) {
+    acd_stat_time(&acd_stats.inflate_ns, start);
+    acd_stat_add(&acd_stats.inflate_bytes_in, strm->total_in - in_before);
+    acd_stat_add(&acd_stats.inflate_bytes_out, strm->total_out - out_before);
+    if (ended) acd_stat_add(&acd_stats.inflate_members, 1);
+}
+
+int acd_block_inflate_until(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block,
+                            unsigned char **buf, size_t *cap, size_t limit) {
+    z_stream *strm = &ctx->strm;
+    uint64_t start = acd_now_ns();
+    uLong in_before = strm->total_in, out_before = strm->total_out;
+
+    // A known ISIZE lets the whole member land in a single allocation (the
+    // spare byte lets inflate reach the trailer without another grow); a
+    // head-only read needs no more than its limit
+    size_t want = block->uncompressed_size ? (size_t)block->uncompressed_size + 1 : INITIAL_OUTPUT;
+    if (limit < want) {
+        want = limit ? limit : 1;
+    }
+    if (*cap < want) {
+        unsigned char *grown = realloc(*buf, want);
+        if (!grown) {
+            return Z_MEM_ERROR;
+        }
+        *buf = grown;
+        *cap = want;
+    }
+
+    int ret;
+    for (;;) {
+        if (strm->total_out >= limit) {
+            note_inflate(strm, start, in_before, out_before, 0);
+            return Z_OK;
+        }
+        if (strm->total_out == *cap) {
+            unsigned char *grown = realloc(*buf, *cap * 2);
+            if (!grown) {
+                return Z_MEM_ERROR;
+            }
+            *buf = grown;
+            *cap *= 2;
+        }
+        // Never past limit, however large the buffer already is
+        size_t room = *cap - strm->total_out;
+        if (limit - strm->total_out < room) room = limit - strm->total_out;
+        strm->next_out = *buf + strm->total_out;
+        strm->avail_out = room > UINT_MAX ? UINT_MAX : (uInt)room;
+        
+        ret = inflate(strm, Z_NO_FLUSH);
+        if (ret != Z_OK) break;
+    }
+    note_inflate(strm, start, in_before, out_before, ret == Z_STREAM_END);
+
+    if (ret != Z_STREAM_END) {
+        // Running out of input before the trailer is a truncated member
+        return ret == Z_BUF_ERROR ? Z_DATA_ERROR : ret;
+    }
+
+    const unsigned char *trailer = acd->data + block->offset + strm->total_in - 8;
+    block->compressed_size = (uint32_t)strm->total_in;
+    block->uncompressed_size = (uint32_t)strm->total_out;
+    block->crc32 = read_le32(trailer);
+    block->kind = acd_block_classify(*buf, strm->total_out);
+    return ret;
+}
+
+// Inflate block's member into *buf (capacity *cap), growing it as needed.
+// On Z_STREAM_END the block's sizes, CRC and kind are filled in and the
+// output is the first uncompressed_size bytes of *buf.
+static int inflate_into(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block,
+                        unsigned char **buf, size_t *cap) {
+    int ret = acd_block_inflate_begin(ctx, acd, block);
+    if (ret != Z_OK) {
+        return ret;
+    }
+    return acd_block_inflate_until(ctx, acd, block, buf, cap, SIZE_MAX);
+}
+
+// Decode a member whose sizes are known in one call into an exact buffer.
+// Returns Z_STREAM_END, or Z_DATA_ERROR to fall back to streaming (which
+// then reports the real error).
+static int inflate_oneshot(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block) {
+    const unsigned char *in = acd_file_ptr(acd, block->offset, block->compressed_size);
+    if (!in || block->compressed_size < 18 || ensure_oneshot(ctx) != 0) {
+        return Z_DATA_ERROR;
+    }
+    size_t size = block->uncompressed_size;
+    unsigned char *out = malloc(size ? size : 1);
+    if (!out) {
+        return Z_MEM_ERROR;
+    }
+
+    size_t in_used, out_used;
+    uint64_t start = acd_now_ns();
+    AcdInflateResult ret = acd_inflater_gzip(ctx->oneshot, in, block->compressed_size, out, size ? size : 1,
+                                             &in_used, &out_used);
+    acd_stat_time(&acd_stats.inflate_ns, start);
+    if (ret != ACD_INFLATE_OK || in_used != block->compressed_size || out_used != size) {
+        free(out);
+        return ret == ACD_INFLATE_NO_MEMORY ? Z_MEM_ERROR : Z_DATA_ERROR;
+    }
+    acd_stat_add(&acd_stats.inflate_members, 1);
+    acd_stat_add(&acd_stats.inflate_bytes_in, in_used);
+    acd_stat_add(&acd_stats.inflate_bytes_out, out_used);
+    block->crc32 = read_le32(in + in_used - 8);
+    block->kind = acd_block_classify(out, size);
+    block->data = out;
+    return Z_STREAM_END;
+}
+
+int acd_block_inflate_ctx(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block) {
+    unsigned char *out = NULL;
+    size_t capacity = 0;
+    block->data = NULL;
+
+    // Indexed members: one call, no buffer growth
+    if (block->compressed_size && block->uncompressed_size) {
+        int ret = inflate_oneshot(ctx, acd, block);
+        if (ret != Z_DATA_ERROR) {
+            return ret;
+        }
+    }
+
+    int ret = inflate_into(ctx, acd, block, &out, &capacity);
+    if (ret != Z_STREAM_END) {
+        free(out);
+        return ret;
+    }
+
+    // Trim to the member size
+    size_t size = block->uncompressed_size;
+    if (size < capacity) {
+        unsigned char *exact = realloc(out, size ? size : 1);
+        if (exact) out = exact;
+    }
+    block->data = out;
+    return ret;
+}
+
+int acd_block_inflate(const ACD_File *acd, CompressedBlock *block) {
+    InflateContext *ctx = inflate_context_acquire();
+    if (!ctx) {
+        return Z_MEM_ERROR;
+    }
+    int ret = acd_block_inflate_ctx(ctx, acd, block);
+    inflate_context_release(ctx);
+    return ret;
+}
+
+void acd_block_free(CompressedBlock *block) {
+    free(block->data);
+    block->data = NULL;
+}
+
+int acd_block_iter_open(BlockIter *it, const ACD_File *acd,
+                        const CompressedBlock *known, size_t known_count) {
+    memset(it, 0, sizeof(*it));
+    it->acd = acd;
+    it->known = known;
+    it->known_count = known_count;
+    it->pos = (size_t)acd->binary_start;
+    inflate_context_init(&it->ctx);
+    return 0;
+}
+
+int acd_block_iter_next(BlockIter *it, const CompressedBlock **block) {
+    const ACD_File *acd = it->acd;
+    *block = NULL;
+
+    if (it->cached.data) {
+        acd_file_close(&it->cached);
+    }
+
+    for (;;) {
+        CompressedBlock *current = &it->block;
+        memset(current, 0, sizeof(*current));
+
+        if (it->known) {
+            if (it->next_known >= it->known_count) {
+                return 0;
+            }
+            *current = it->known[it->next_known++];
+        } else {
+            size_t size = (size_t)acd->file_size;
+            it->pos = acd_scan_next_gzip(acd->data, size, it->pos);
+            if (it->pos >= size) {
+                return 0;
+            }
+            current->offset = (long)it->pos;
+
+            // Magic hits that fail the header checks are never inflated
+            acd_stat_add(&acd_stats.candidates, 1);
+            GzipCheck check = acd_gzip_check(acd->data + it->pos, size - it->pos);
+            if (check != GZIP_CANDIDATE_OK) {
+                acd_stat_add(check == GZIP_REJECT_HEADER ? &acd_stats.rejected_header : &acd_stats.rejected_block, 1);
+                it->pos++;
+                continue;
+            }
+        }
+        current->data = NULL;
+
+        // Only indexed blocks have the compressed size a cache key needs
+        BlockCacheKey key;
+        int keyed = it->cache && it->known && acd_block_cache_key(acd, current, &key) == 0;
+        if (keyed && acd_block_cache_get(it->cache, &key, &it->cached) == 0) {
+            current->data = (unsigned char *)it->cached.data;
+            it->number++;
+            *block = current;
+            return 1;
+        }
+
+        int ret = inflate_into(&it->ctx, acd, current, &it->buffer, &it->capacity);
+        if (ret == Z_MEM_ERROR) {
+            return -1;
+        }
+        if (ret != Z_STREAM_END) {
+            // A scanned candidate that doesn't decode; known blocks are
+            // reported either way so numbering matches the list
+            if (!it->known) {
+                acd_stat_add(&acd_stats.rejected_inflate, 1);
+                it->pos++;
+                continue;
+            }
+            current->uncompressed_size = 0;
+        } else {
+            current->data = it->buffer;
+            if (!it->known) {
+                acd_stat_add(&acd_stats.blocks, 1);
+                it->pos += current->compressed_size;
+            }
+            if (keyed) {
+                acd_block_cache_put(it->cache, &key, it->buffer, current->uncompressed_size);
+            }
+        }
+
+        it->number++;
+        *block = current;
+        return 1;
+    }
+}
+
+void acd_block_iter_use_cache(BlockIter *it, struct BlockCache *cache) {
+    it->cache = cache;
+}
+
+void acd_block_iter_close(BlockIter *it) {
+    if (it->cached.data) {
+        acd_file_close(&it->cached);
+    }
+    inflate_context_end(&it->ctx);
+    free(it->buffer);
+    memset(it, 0, sizeof(*it));
+}
@@ -0,0 +1,152 @@
+#ifndef ACD_BLOCK_H
+#define ACD_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "acd_file.h"
+
+// What a decompressed block holds, judged from its first bytes
+typedef enum {
+    BLOCK_KIND_BINARY = 0,
+    BLOCK_KIND_XML = 1,
+    BLOCK_KIND_COMPS = 2
+} BlockKind;
+
+// Structure for a compressed block
+typedef struct {
+    long offset;
+    uint32_t compressed_size;    // Whole gzip member, header to trailer
+    uint32_t uncompressed_size;  // ISIZE from the trailer
+    uint32_t crc32;              // CRC32 from the trailer
+    uint32_t kind;               // BlockKind
+    unsigned char *data;
+} CompressedBlock;
+
+struct AcdInflater;
+
+// Reusable inflate state for one thread: members are decoded with
+// inflateReset instead of a fresh inflateInit2/inflateEnd per block, and
+// members of known size with the one-shot backend (acd_inflate)
+typedef struct {
+    z_stream strm;
+    int ready;
+    struct AcdInflater *oneshot;   // Created on first use
+    unsigned char *scratch;        // Probe output, kept between probes
+    size_t scratch_cap;
+    uint64_t probe_ns;             // Time spent inflating in probes
+} InflateContext;
+
+void inflate_context_init(InflateContext *ctx);
+void inflate_context_end(InflateContext *ctx);
+
+// Process-wide pool of idle contexts, so a run over many files (or many
+// one-off probes and inflates) keeps its z_streams, one-shot decoders and
+// scratch buffers instead of setting them up per call. acquire returns a
+// context with probe_ns cleared, or NULL on allocation failure; release
+// hands it back (freeing it when the pool is full). Thread-safe.
+InflateContext *inflate_context_acquire(void);
+void inflate_context_release(InflateContext *ctx);
+
+// Free every idle context
+void inflate_context_pool_drain(void);
+
+// Classify decompressed bytes (only the first few KB are looked at)
+uint32_t acd_block_classify(const unsigned char *data, size_t len);
+
+const char *acd_block_kind_name(uint32_t kind);
+
+// Outcome of acd_gzip_check
+typedef enum {
+    GZIP_CANDIDATE_OK = 0,
+    GZIP_REJECT_HEADER = 1,      // Member header fields don't hold up
+    GZIP_REJECT_BLOCK = 2        // First deflate block header is invalid
+} GzipCheck;
+
+// Cheap plausibility test for a gzip header candidate at p (avail bytes
+// readable), without any inflate state. Stage one checks the member
+// header: magic, CM, reserved FLG bits, XFL and OS values, and that the
+// optional FEXTRA/FNAME/FCOMMENT fields end inside the data and FHCRC
+// matches. Stage two checks the first deflate block header: BTYPE not 3,
+// LEN/NLEN complementary for a stored block, HLIT/HDIST in range for a
+// dynamic one.
+GzipCheck acd_gzip_check(const unsigned char *p, size_t avail);
+
+// Length of the gzip member header at p (stage one of acd_gzip_check),
+// i.e. where the deflate stream starts; -1 if it doesn't hold up
+long acd_gzip_header_size(const unsigned char *p, size_t avail);
+
+// Inflate the gzip member at offset without keeping the output, filling
+// in the block's sizes, CRC and kind. Returns 0 when a complete member
+// was decoded, -1 otherwise.
+int acd_block_probe(const ACD_File *acd, long offset, CompressedBlock *block);
+
+// Same as acd_block_probe, reusing ctx across candidates. Candidates that
+// fail acd_gzip_check are rejected before any inflate.
+int acd_block_probe_ctx(InflateContext *ctx, const ACD_File *acd, long offset, CompressedBlock *block);
+
+// Inflate the gzip member at block->offset into block->data. The output
+// buffer grows only as far as needed and ends up exactly member-sized;
+// if both sizes are already known (e.g. from the index) it is allocated
+// in one go and decoded by the one-shot backend. On success the real compressed/uncompressed
+// sizes and CRC are recorded in the block. Returns the zlib result of the
+// last inflate call (Z_STREAM_END on success) or Z_MEM_ERROR/Z_DATA_ERROR.
+int acd_block_inflate(const ACD_File *acd, CompressedBlock *block);
+
+// Same as acd_block_inflate, reusing ctx's z_stream
+int acd_block_inflate_ctx(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block);
+
+// Staged inflate, for callers that decide from a member's first bytes
+// whether to decode the rest. acd_block_inflate_begin points ctx at the
+// member at block->offset; acd_block_inflate_until then inflates into *buf
+// (capacity *cap, grown as needed) until limit bytes are out (never more)
+// or the member ends, and may be called again with a larger limit. The bytes
+// produced so far are ctx->strm.total_out. Returns Z_OK when stopped at the
+// limit, Z_STREAM_END at the end of the member (block's sizes, CRC and kind
+// filled in), or Z_MEM_ERROR/Z_DATA_ERROR.
+int acd_block_inflate_begin(InflateContext *ctx, const ACD_File *acd, const CompressedBlock *block);
+int acd_block_inflate_until(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block,
+                            unsigned char **buf, size_t *cap, size_t limit);
+
+// Release block->data
+void acd_block_free(CompressedBlock *block);
+
+struct BlockCache;
+
+// Lazy block iterator: yields one decompressed member at a time, reusing a
+// single output buffer, so memory stays at the largest block seen rather
+// than the sum of all blocks
+typedef struct {
+    const ACD_File *acd;
+    const CompressedBlock *known;  // Optional block list (e.g. from the index)
+    size_t known_count;
+    size_t next_known;
+    size_t pos;                    // Next scan position (file offset)
+    InflateContext ctx;
+    unsigned char *buffer;
+    size_t capacity;
+    CompressedBlock block;         // Current block; data points into buffer
+    int number;                    // 1-based number of the current block
+    struct BlockCache *cache;      // Optional decompressed block cache
+    ACD_File cached;               // Mapping of the current block on a cache hit
+} BlockIter;
+
+// Start iterating acd's members. With known == NULL the binary region is
+// scanned lazily as the iterator advances; otherwise the given blocks are
+// decoded in order.
+int acd_block_iter_open(BlockIter *it, const ACD_File *acd,
+                        const CompressedBlock *known, size_t known_count);
+
+// Advance to the next member. Returns 1 with *block set (valid until the
+// next call; data is NULL if a known block failed to decode), 0 at the
+// end, -1 on allocation failure.
+int acd_block_iter_next(BlockIter *it, const CompressedBlock **block);
+
+// Serve known blocks from cache (and add the ones it lacks); the current
+// block's data then may point into a read-only mapping
+void acd_block_iter_use_cache(BlockIter *it, struct BlockCache *cache);
+
+void acd_block_iter_close(BlockIter *it);
+
+#endif
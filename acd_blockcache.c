@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "acd_blockcache.h"
+
+#define ENTRY_SUFFIX ".blk"
+
+// Trim to this share of the limit when evicting, so a full cache doesn't
+// rescan its directory on every insert
+#define EVICT_TARGET(limit) ((limit) / 10 * 9)
+
+struct BlockCache {
+    char dir[4096];
+    uint64_t limit;
+
+    pthread_mutex_t lock;
+    uint64_t size;               // Bytes in the directory (approximate across processes)
+
+    _Atomic size_t hits;
+    _Atomic size_t misses;
+    _Atomic unsigned long temp_counter;
+};
+
+typedef struct {
+    long long mtime;
+    uint64_t size;
+    char name[64];
+} CacheEntry;
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t load64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Word-at-a-time multiplicative hash with a murmur3 finaliser; compressed
+// bytes hash many times faster than they inflate
+static uint64_t hash_member(const unsigned char *p, size_t len) {
+    const uint64_t k1 = 0x9E3779B185EBCA87ull, k2 = 0xC2B2AE3D27D4EB4Full;
+    uint64_t h = 0x27D4EB2F165667C5ull ^ ((uint64_t)len * k1);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        h ^= rotl64(load64(p + i) * k2, 31) * k1;
+        h = rotl64(h, 27) * k1 + 0x85EBCA77C2B2AE63ull;
+    }
+    unsigned char tail[8] = {0};
+    memcpy(tail, p + i, len - i);
+    h ^= rotl64(load64(tail) * k2, 31) * k1;
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static void entry_path(const BlockCache *cache, const BlockCacheKey *key, char *out, size_t size) {
+    snprintf(out, size, "%s/%016llx-%08x-%08x" ENTRY_SUFFIX, cache->dir,
+             (unsigned long long)key->hash, key->compressed_size, key->crc32);
+}
+
+static int is_entry(const char *name) {
+    size_t len = strlen(name);
+    return name[0] != '.' && len > strlen(ENTRY_SUFFIX) &&
+           strcmp(name + len - strlen(ENTRY_SUFFIX), ENTRY_SUFFIX) == 0;
+}
+
+static int compare_mtime(const void *pa, const void *pb) {
+    const CacheEntry *a = pa, *b = pb;
+    return a->mtime < b->mtime ? -1 : a->mtime > b->mtime;
+}
+
+// Total the directory; with target > 0, also remove the oldest entries
+// until it is at most target bytes. Called with the lock held (or before
+// the cache is shared).
+static int rescan(BlockCache *cache, uint64_t target) {
+    DIR *dir = opendir(cache->dir);
+    if (!dir) {
+        return -1;
+    }
+
+    CacheEntry *entries = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+    char path[4096 + 64];
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (!is_entry(de->d_name) || strlen(de->d_name) >= sizeof(entries->name)) continue;
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, de->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+        total += (uint64_t)st.st_size;
+        if (!target) continue;
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            CacheEntry *grown = realloc(entries, capacity * sizeof(*entries));
+            if (!grown) break;
+            entries = grown;
+        }
+        entries[count].mtime = (long long)st.st_mtime;
+        entries[count].size = (uint64_t)st.st_size;
+        strcpy(entries[count].name, de->d_name);
+        count++;
+    }
+    closedir(dir);
+
+    if (target && total > target) {
+        qsort(entries, count, sizeof(*entries), compare_mtime);
+        for (size_t i = 0; i < count && total > target; i++) {
+            snprintf(path, sizeof(path), "%s/%s", cache->dir, entries[i].name);
+            if (unlink(path) == 0 || errno == ENOENT) {
+                total -= entries[i].size;
+            }
+        }
+    }
+    free(entries);
+    cache->size = total;
+    return 0;
+}
+
+// mkdir -p
+static int make_dirs(const char *dir) {
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s", dir) >= (int)sizeof(path)) {
+        return -1;
+    }
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST ? 0 : -1;
+}
+
+BlockCache *acd_block_cache_open(const char *dir, uint64_t limit) {
+    if (!dir || !*dir || strlen(dir) >= sizeof(((BlockCache *)0)->dir) || make_dirs(dir) != 0) {
+        return NULL;
+    }
+    BlockCache *cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        return NULL;
+    }
+    strcpy(cache->dir, dir);
+    cache->limit = limit ? limit : ACD_BLOCK_CACHE_DEFAULT_LIMIT;
+    pthread_mutex_init(&cache->lock, NULL);
+
+    // Another process may have left it over the limit
+    if (rescan(cache, 0) != 0) {
+        acd_block_cache_close(cache);
+        return NULL;
+    }
+    if (cache->size > cache->limit) {
+        rescan(cache, EVICT_TARGET(cache->limit));
+    }
+    return cache;
+}
+
+void acd_block_cache_close(BlockCache *cache) {
+    if (!cache) {
+        return;
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+int acd_block_cache_key(const ACD_File *acd, const CompressedBlock *block, BlockCacheKey *key) {
+    if (block->compressed_size < 18) {
+        return -1;
+    }
+    const unsigned char *member = acd_file_ptr(acd, block->offset, block->compressed_size);
+    if (!member) {
+        return -1;
+    }
+    key->hash = hash_member(member, block->compressed_size);
+    key->compressed_size = block->compressed_size;
+    key->uncompressed_size = block->uncompressed_size;
+    key->crc32 = block->crc32;
+    return 0;
+}
+
+int acd_block_cache_get(BlockCache *cache, const BlockCacheKey *key, ACD_File *out) {
+    char path[4096 + 64];
+    entry_path(cache, key, path, sizeof(path));
+
+    if (acd_file_open(out, path) != 0) {
+        atomic_fetch_add(&cache->misses, 1);
+        return -1;
+    }
+    if ((uint64_t)out->file_size != key->uncompressed_size) {
+        // Truncated by a crash or a full disk; don't serve it again
+        acd_file_close(out);
+        unlink(path);
+        atomic_fetch_add(&cache->misses, 1);
+        return -1;
+    }
+
+    // Recently used entries are the last to be evicted
+    utimensat(AT_FDCWD, path, NULL, 0);
+    atomic_fetch_add(&cache->hits, 1);
+    return 0;
+}
+
+int acd_block_cache_put(BlockCache *cache, const BlockCacheKey *key,
+                        const unsigned char *data, size_t size) {
+    if (size != key->uncompressed_size || size > cache->limit) {
+        return -1;
+    }
+
+    char path[4096 + 64], tmp[4096 + 64];
+    entry_path(cache, key, path, sizeof(path));
+
+    // Entries are named by content, so a complete one already there holds
+    // these bytes; writing it again would only count it twice
+    struct stat st;
+    if (stat(path, &st) == 0 && (uint64_t)st.st_size == size) {
+        utimensat(AT_FDCWD, path, NULL, 0);
+        return 0;
+    }
+    snprintf(tmp, sizeof(tmp), "%s/.tmp-%ld-%lu", cache->dir, (long)getpid(),
+             atomic_fetch_add(&cache->temp_counter, 1));
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        return -1;
+    }
+    int ok = fwrite(data, 1, size, out) == size;
+    if (fclose(out) != 0) ok = 0;
+    if (!ok) {
+        unlink(tmp);
+        return -1;
+    }
+
+    // Whatever the rename replaces (a truncated entry, or one another
+    // thread just put) stops counting
+    pthread_mutex_lock(&cache->lock);
+    uint64_t replaced = stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+    if (rename(tmp, path) != 0) {
+        pthread_mutex_unlock(&cache->lock);
+        unlink(tmp);
+        return -1;
+    }
+    cache->size -= replaced < cache->size ? replaced : cache->size;
+    cache->size += size;
+    if (cache->size > cache->limit) {
+        rescan(cache, EVICT_TARGET(cache->limit));
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+void acd_block_cache_counts(const BlockCache *cache, size_t *hits, size_t *misses) {
+    *hits = atomic_load(&cache->hits);
+    *misses = atomic_load(&cache->misses);
+}
@@ -0,0 +1,56 @@
+#ifndef ACD_BLOCKCACHE_H
+#define ACD_BLOCKCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+
+// Content-addressed cache of decompressed blocks, shared by every ACD
+//
+// Projects across a fleet carry many identical members (common AOIs, UDT
+// libraries, firmware tables). Each member's decompressed bytes are kept
+// in one file per member in the cache directory, named by a 64-bit hash
+// of its compressed bytes plus its compressed size and trailer CRC32, so
+// the same member found in any file is inflated once. Cached blocks are
+// mapped, not read. Once the directory grows past its limit the least
+// recently used entries (by mtime, refreshed on every hit) are removed.
+//
+// One cache may be used from several threads, and several processes may
+// share a directory.
+typedef struct BlockCache BlockCache;
+
+#define ACD_BLOCK_CACHE_ENV "ACD_BLOCK_CACHE"
+#define ACD_BLOCK_CACHE_DEFAULT_LIMIT (1024ull * 1024 * 1024)
+
+typedef struct {
+    uint64_t hash;               // Of the compressed member
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+    uint32_t crc32;
+} BlockCacheKey;
+
+// Open (creating it if needed) the cache in dir, holding at most limit
+// bytes (0 = ACD_BLOCK_CACHE_DEFAULT_LIMIT). Returns NULL on failure.
+BlockCache *acd_block_cache_open(const char *dir, uint64_t limit);
+
+void acd_block_cache_close(BlockCache *cache);
+
+// Key for a block whose compressed size is known (e.g. from the index).
+// Returns -1 if it isn't, or the member doesn't lie inside acd.
+int acd_block_cache_key(const ACD_File *acd, const CompressedBlock *block, BlockCacheKey *key);
+
+// Map the cached bytes for key into *out (close with acd_file_close).
+// Returns 0 on a hit, -1 on a miss.
+int acd_block_cache_get(BlockCache *cache, const BlockCacheKey *key, ACD_File *out);
+
+// Store size decompressed bytes under key (written to a temporary file and
+// renamed into place; evicts if the cache is now over its limit)
+int acd_block_cache_put(BlockCache *cache, const BlockCacheKey *key,
+                        const unsigned char *data, size_t size);
+
+// Hits and misses so far
+void acd_block_cache_counts(const BlockCache *cache, size_t *hits, size_t *misses);
+
+#endif
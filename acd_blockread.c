@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "acd_blockread.h"
+#include "acd_stats.h"
+
+// Index of the block starting at offset in a file-ordered list, or -1
+static long find_block(const CompressedBlock *blocks, size_t count, long offset) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (blocks[mid].offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < count && blocks[lo].offset == offset ? (long)lo : -1;
+}
+
+// Bytes of output a checkpoint at out keeps (and a restart primes with)
+static size_t dictionary_size(uint64_t out) {
+    return out < ACD_BLOCK_WINDOW ? (size_t)out : ACD_BLOCK_WINDOW;
+}
+
+// The window holds output byte x at x % ACD_BLOCK_WINDOW. Copy the len
+// bytes before out between it and the flat buffer flat.
+static void window_copy(unsigned char *window, unsigned char *flat, uint64_t out, size_t len, int to_window) {
+    size_t at = (size_t)((out - len) % ACD_BLOCK_WINDOW);
+    size_t first = ACD_BLOCK_WINDOW - at < len ? ACD_BLOCK_WINDOW - at : len;
+    if (to_window) {
+        memcpy(window + at, flat, first);
+        memcpy(window, flat + first, len - first);
+    } else {
+        memcpy(flat, window + at, first);
+        memcpy(flat + first, window, len - first);
+    }
+}
+
+// Point the stream at the start of the member, or at a checkpoint
+static int restart(BlockReader *r, const BlockCheckpoint *point) {
+    z_stream *strm = &r->strm;
+    inflateReset(strm);
+    r->ended = 0;
+    size_t in = point ? (size_t)point->in : 0;
+    size_t avail = r->deflate_avail - in;
+    strm->next_in = (Bytef *)(r->deflate + in);
+    strm->avail_in = avail > UINT_MAX ? UINT_MAX : (uInt)avail;
+    r->pos = point ? point->out : 0;
+    if (!point) {
+        return 0;
+    }
+
+    // The boundary may fall inside a byte: feed its unused high bits first
+    if (point->bits && inflatePrime(strm, point->bits, r->deflate[in - 1] >> (8 - point->bits)) != Z_OK) {
+        return -1;
+    }
+    size_t dict = dictionary_size(point->out);
+    if (dict && inflateSetDictionary(strm, point->window, (uInt)dict) != Z_OK) {
+        return -1;
+    }
+    window_copy(r->window, point->window, point->out, dict, 1);
+    return 0;
+}
+
+// Called after each inflate step: record a checkpoint at a block boundary
+// (not after the last block) a span past the previous one
+static int maybe_checkpoint(BlockReader *r) {
+    int type = r->strm.data_type;
+    if (!r->span || !(type & 128) || (type & 64)) {
+        return 0;
+    }
+    uint64_t last = r->point_count ? r->points[r->point_count - 1].out : 0;
+    if (r->pos < last + r->span) {
+        return 0;
+    }
+    if (r->point_count == r->point_capacity) {
+        size_t capacity = r->point_capacity ? r->point_capacity * 2 : 16;
+        BlockCheckpoint *grown = realloc(r->points, capacity * sizeof(*grown));
+        if (!grown) {
+            return -1;
+        }
+        r->points = grown;
+        r->point_capacity = capacity;
+    }
+    size_t dict = dictionary_size(r->pos);
+    BlockCheckpoint *point = &r->points[r->point_count];
+    point->window = malloc(dict ? dict : 1);
+    if (!point->window) {
+        return -1;
+    }
+    point->out = r->pos;
+    point->in = (uint64_t)(r->strm.next_in - r->deflate);
+    point->bits = type & 7;
+    window_copy(r->window, point->window, r->pos, dict, 0);
+    r->point_count++;
+    return 0;
+}
+
+// Last checkpoint at or before offset, or NULL
+static const BlockCheckpoint *checkpoint_before(const BlockReader *r, uint64_t offset) {
+    size_t lo = 0, hi = r->point_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->points[mid].out <= offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo ? &r->points[lo - 1] : NULL;
+}
+
+int acd_block_open(BlockReader *r, const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                   long offset, size_t span) {
+    memset(r, 0, sizeof(*r));
+    r->acd = acd;
+    r->span = span;
+    r->block.offset = offset;
+    if (blocks) {
+        long i = find_block(blocks, count, offset);
+        if (i < 0) {
+            return -1;
+        }
+        r->block = blocks[i];
+        r->block.data = NULL;
+    }
+
+    const unsigned char *p = acd_file_ptr(acd, offset, 0);
+    if (!p) {
+        return -1;
+    }
+    size_t avail = (size_t)(acd->file_size - offset);
+    if (r->block.compressed_size && r->block.compressed_size < avail) {
+        avail = r->block.compressed_size;
+    }
+    long header = acd_gzip_header_size(p, avail);
+    if (header < 0) {
+        return -1;
+    }
+    r->deflate = p + header;
+    r->deflate_avail = avail - (size_t)header;
+
+    r->window = malloc(ACD_BLOCK_WINDOW);
+    if (!r->window) {
+        return -1;
+    }
+    if (inflateInit2(&r->strm, -MAX_WBITS) != Z_OK) {
+        free(r->window);
+        r->window = NULL;
+        return -1;
+    }
+    r->ready = 1;
+    return restart(r, NULL);
+}
+
+long acd_block_read(BlockReader *r, uint64_t offset, void *buf, size_t len) {
+    uint64_t size = r->block.uncompressed_size;
+    if (!len || (size && offset >= size)) {
+        return 0;
+    }
+    uint64_t end = offset + len;
+    if (size && end > size) end = size;
+
+    // Back up to (or jump ahead to) the nearest checkpoint when the stream
+    // is past offset or a checkpoint is closer than where it stands
+    const BlockCheckpoint *point = checkpoint_before(r, offset);
+    if (offset < r->pos || (point && point->out > r->pos)) {
+        if (restart(r, point) != 0) {
+            return -1;
+        }
+    }
+
+    uint64_t start = acd_now_ns();
+    const unsigned char *in_before = r->strm.next_in;
+    uint64_t out_before = r->pos;
+    unsigned char *dest = buf;
+    int status = 0;
+    while (r->pos < end && !r->ended) {
+        size_t at = (size_t)(r->pos % ACD_BLOCK_WINDOW);
+        size_t room = ACD_BLOCK_WINDOW - at;
+        if (end - r->pos < room) room = (size_t)(end - r->pos);
+        r->strm.next_out = r->window + at;
+        r->strm.avail_out = (uInt)room;
+
+        int ret = inflate(&r->strm, Z_BLOCK);
+        size_t produced = room - r->strm.avail_out;
+
+        // The part of this step's output inside [offset, end)
+        uint64_t from = r->pos > offset ? r->pos : offset;
+        if (r->pos + produced > from) {
+            memcpy(dest + (from - offset), r->window + at + (from - r->pos), (size_t)(r->pos + produced - from));
+        }
+        r->pos += produced;
+
+        if (ret == Z_STREAM_END) {
+            r->ended = 1;
+            if (!r->block.uncompressed_size) r->block.uncompressed_size = (uint32_t)r->pos;
+            break;
+        }
+        if (ret != Z_OK || maybe_checkpoint(r) != 0) {
+            status = -1;
+            break;
+        }
+    }
+    acd_stat_time(&acd_stats.inflate_ns, start);
+    acd_stat_add(&acd_stats.inflate_bytes_in, (uint64_t)(r->strm.next_in - in_before));
+    acd_stat_add(&acd_stats.inflate_bytes_out, r->pos - out_before);
+
+    if (status != 0) {
+        // Leave the stream somewhere a later read can restart from
+        r->pos = UINT64_MAX;
+        return -1;
+    }
+    return r->pos > offset ? (long)((r->pos < end ? r->pos : end) - offset) : 0;
+}
+
+uint64_t acd_block_size(const BlockReader *r) {
+    return r->block.uncompressed_size;
+}
+
+void acd_block_close(BlockReader *r) {
+    if (r->ready) {
+        inflateEnd(&r->strm);
+    }
+    for (size_t i = 0; i < r->point_count; i++) {
+        free(r->points[i].window);
+    }
+    free(r->points);
+    free(r->window);
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,69 @@
+#ifndef ACD_BLOCKREAD_H
+#define ACD_BLOCKREAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+
+// Random access into one gzip member by uncompressed offset
+//
+// A read inflates only as far as the end of the requested range, into a
+// 32 KB sliding window, so memory stays fixed whatever the member's size.
+// Reading on from where the last read stopped continues the same stream;
+// reading backwards restarts it. With a checkpoint span, every deflate
+// block boundary at least span bytes past the previous checkpoint is
+// recorded as it goes by (the bit position in the compressed stream plus
+// the 32 KB of output before it, as in zlib's zran example), and a later
+// seek resumes from the nearest checkpoint before the target instead of
+// from the start: at most about span bytes are decoded to get there.
+
+#define ACD_BLOCK_WINDOW 32768
+#define ACD_BLOCK_SPAN_DEFAULT (1u << 20)
+
+typedef struct {
+    uint64_t out;                // Uncompressed offset of the boundary
+    uint64_t in;                 // Deflate bytes (from the stream start) up to it
+    int bits;                    // Bits of byte in - 1 not yet used (0-7)
+    unsigned char *window;       // The output before out (up to 32 KB)
+} BlockCheckpoint;
+
+typedef struct {
+    const ACD_File *acd;
+    CompressedBlock block;       // Sizes 0 when not known (no index entry)
+    const unsigned char *deflate;  // First byte after the gzip header
+    size_t deflate_avail;
+    z_stream strm;
+    int ready;
+    int ended;                   // strm reached the end of the member
+    uint64_t pos;                // Uncompressed offset strm is at
+    unsigned char *window;       // Last 32 KB of output, circular at pos
+    size_t span;                 // Checkpoint spacing (0 = none)
+    BlockCheckpoint *points;
+    size_t point_count;
+    size_t point_capacity;
+} BlockReader;
+
+// Open the member at offset for random reads. It is looked up in blocks
+// (count entries in file order, e.g. from acd_index_blocks) for its sizes;
+// with blocks NULL any member at offset will do and its size is found on
+// the way. span is the checkpoint spacing (ACD_BLOCK_SPAN_DEFAULT is a
+// good start, 0 = no checkpoints). Returns 0, or -1 if there is no member
+// at offset or no memory.
+int acd_block_open(BlockReader *r, const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                   long offset, size_t span);
+
+// Copy up to len uncompressed bytes from offset into buf. Returns the
+// number of bytes copied (short only at the end of the member, 0 past
+// it), or -1 on corrupt data or allocation failure.
+long acd_block_read(BlockReader *r, uint64_t offset, void *buf, size_t len);
+
+// Uncompressed size of the member: from the index, or once a read has
+// reached its end; 0 while unknown
+uint64_t acd_block_size(const BlockReader *r);
+
+void acd_block_close(BlockReader *r);
+
+#endif
@@ -0,0 +1,488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_columnar.h"
+
+_Static_assert(sizeof(ColumnarHeader) == 64, "columnar header layout changed");
+_Static_assert(sizeof(ColumnarSection) == 24, "columnar section layout changed");
+
+#define PAD8(n) (((n) + 7) & ~(uint64_t)7)
+
+// A section waiting to be written
+typedef struct {
+    uint32_t id;
+    const void *data;
+    size_t size;
+} PendingSection;
+
+// Columns the writer builds (everything else is written straight from
+// the tables)
+typedef struct {
+    StringPool strings;
+    uint32_t *comp;              // 6 columns of component_count
+    uint32_t *by_uid;
+    uint32_t *tag_name;
+    uint32_t *tag_alias;
+    uint32_t *type_name;
+    uint32_t *program_name;
+    uint32_t *def_family;
+    uint32_t *def_class;
+    uint32_t *member_name;
+    uint32_t controller_name;
+    uint32_t *rung_text;
+} ColumnarBuild;
+
+static void build_free(ColumnarBuild *b) {
+    string_pool_free(&b->strings);
+    free(b->comp);
+    free(b->by_uid);
+    free(b->tag_name);
+    free(b->tag_alias);
+    free(b->type_name);
+    free(b->program_name);
+    free(b->def_family);
+    free(b->def_class);
+    free(b->member_name);
+    free(b->rung_text);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Intern len bytes of s into b's string table; its offset, or -1
+static int64_t intern(ColumnarBuild *b, const char *s, size_t len) {
+    StrRef ref;
+    if (string_pool_intern(&b->strings, s, len, &ref) != 0) {
+        return -1;
+    }
+    return ref.offset;
+}
+
+// u32 string offsets, count of them, for NUL-terminated strings at
+// base + offsets[i] (lengths NULL) or of lengths[i] bytes
+static uint32_t *intern_column(ColumnarBuild *b, const char *base, const uint32_t *offsets,
+                               const uint32_t *lengths, size_t count) {
+    uint32_t *out = malloc((count ? count : 1) * sizeof(*out));
+    if (!out) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const char *s = base + offsets[i];
+        int64_t offset = intern(b, s, lengths ? lengths[i] : strlen(s));
+        if (offset < 0) {
+            free(out);
+            return NULL;
+        }
+        out[i] = (uint32_t)offset;
+    }
+    return out;
+}
+
+static int64_t intern_column_str(ColumnarBuild *b, const char *s) {
+    return intern(b, s, strlen(s));
+}
+
+static int build_components(ColumnarBuild *b, const ComponentStore *store) {
+    size_t n = store->count;
+    b->comp = malloc((n ? n : 1) * 6 * sizeof(uint32_t));
+    uint64_t *order = malloc((n ? n : 1) * sizeof(*order));
+    b->by_uid = malloc((n ? n : 1) * sizeof(uint32_t));
+    if (!b->comp || !order || !b->by_uid) {
+        free(order);
+        return -1;
+    }
+    uint32_t *uid = b->comp, *parent = uid + n, *ordinal = parent + n;
+    uint32_t *name = ordinal + n, *type = name + n, *ioi = type + n;
+    for (size_t i = 0; i < n; i++) {
+        const Component *comp = &store->items[i];
+        int64_t s_name = intern(b, component_str(store, comp->name), comp->name.len);
+        int64_t s_type = intern(b, component_str(store, comp->type), comp->type.len);
+        int64_t s_ioi = intern(b, component_str(store, comp->ioi), comp->ioi.len);
+        if (s_name < 0 || s_type < 0 || s_ioi < 0) {
+            free(order);
+            return -1;
+        }
+        uid[i] = comp->uid;
+        parent[i] = comp->parent_uid;
+        ordinal[i] = comp->ordinal;
+        name[i] = (uint32_t)s_name;
+        type[i] = (uint32_t)s_type;
+        ioi[i] = (uint32_t)s_ioi;
+        order[i] = ((uint64_t)comp->uid << 32) | (uint32_t)i;
+    }
+
+    // (UID, index) order, so the first of a repeated UID sorts first
+    qsort(order, n, sizeof(*order), compare_u64);
+    for (size_t i = 0; i < n; i++) {
+        b->by_uid[i] = (uint32_t)order[i];
+    }
+    free(order);
+    return 0;
+}
+
+static int write_sections(FILE *out, const ColumnarHeader *header, const PendingSection *pending) {
+    ColumnarSection table[ACD_COL_SECTION_LIMIT];
+    uint64_t pos = PAD8(sizeof(*header) + header->section_count * sizeof(*table));
+    for (uint32_t i = 0; i < header->section_count; i++) {
+        table[i] = (ColumnarSection){ .id = pending[i].id, .offset = pos, .size = pending[i].size };
+        pos = PAD8(pos + pending[i].size);
+    }
+
+    static const char padding[8];
+    uint64_t written = sizeof(*header) + header->section_count * sizeof(*table);
+    int ok = fwrite(header, sizeof(*header), 1, out) == 1 &&
+             fwrite(table, sizeof(*table), header->section_count, out) == header->section_count;
+    for (uint32_t i = 0; ok && i < header->section_count; i++) {
+        size_t gap = (size_t)(table[i].offset - written);
+        ok = fwrite(padding, 1, gap, out) == gap &&
+             fwrite(pending[i].data, 1, pending[i].size, out) == pending[i].size;
+        written = table[i].offset + pending[i].size;
+    }
+    return ok ? 0 : -1;
+}
+
+int acd_columnar_write(const char *path, const ComponentStore *store, const TagTable *tags,
+                       const RungTable *rungs) {
+    size_t n = store->count;
+    size_t tag_count = tags ? tags->count : 0, type_count = tags ? tags->type_count : 0;
+    size_t program_count = tags ? tags->program_count : 0, def_count = tags ? tags->def_count : 0;
+    size_t member_count = tags ? tags->member_count : 0, rung_count = rungs ? rungs->count : 0;
+    if ((n && !store->child_start) || n >= UINT32_MAX || tag_count >= UINT32_MAX ||
+        def_count >= UINT32_MAX || rung_count >= UINT32_MAX) {
+        return -1;
+    }
+
+    ColumnarBuild b = {0};
+    int ok = string_pool_init(&b.strings) == 0 && build_components(&b, store) == 0;
+    if (ok && tags) {
+        b.tag_name = intern_column(&b, tags->strings.data, tags->name, NULL, tag_count);
+        b.tag_alias = intern_column(&b, tags->strings.data, tags->alias, NULL, tag_count);
+        b.type_name = intern_column(&b, tags->strings.data, tags->type_name, NULL, type_count);
+        b.program_name = intern_column(&b, tags->strings.data, tags->program_name, NULL, program_count);
+        b.def_family = intern_column(&b, tags->strings.data, tags->def_family, NULL, def_count);
+        b.def_class = intern_column(&b, tags->strings.data, tags->def_class, NULL, def_count);
+        b.member_name = intern_column(&b, tags->strings.data, tags->member_name, NULL, member_count);
+        int64_t controller = intern_column_str(&b, tag_str(tags, tags->controller_name));
+        b.controller_name = (uint32_t)controller;
+        ok = b.tag_name && b.tag_alias && b.type_name && b.program_name && b.def_family && b.def_class &&
+             b.member_name && controller >= 0;
+    }
+    if (ok && rungs) {
+        b.rung_text = intern_column(&b, rungs->text_data, rungs->text, rungs->text_len, rung_count);
+        ok = b.rung_text != NULL;
+    }
+    if (!ok || b.strings.size > UINT32_MAX) {
+        build_free(&b);
+        return -1;
+    }
+
+    // Every section of this version, empty ones included
+    static const uint32_t no_children[1];
+    const uint32_t *member_start = tags && def_count ? tags->def_member_start : no_children;
+    size_t child_total = n ? store->child_start[n] : 0;
+    size_t col = n * sizeof(uint32_t), tag_col = tag_count * sizeof(uint32_t);
+    size_t rung_col = rung_count * sizeof(uint32_t), def_col = def_count * sizeof(uint32_t);
+    size_t member_col = member_count * sizeof(uint32_t);
+    PendingSection pending[] = {
+        { ACD_COL_STRINGS, b.strings.data, b.strings.size },
+        { ACD_COL_COMP_UID, b.comp, col },
+        { ACD_COL_COMP_PARENT, b.comp + n, col },
+        { ACD_COL_COMP_ORDINAL, b.comp + 2 * n, col },
+        { ACD_COL_COMP_NAME, b.comp + 3 * n, col },
+        { ACD_COL_COMP_TYPE, b.comp + 4 * n, col },
+        { ACD_COL_COMP_IOI, b.comp + 5 * n, col },
+        { ACD_COL_COMP_CHILD_START, n ? store->child_start : no_children, col + sizeof(uint32_t) },
+        { ACD_COL_COMP_CHILDREN, store->children, child_total * sizeof(uint32_t) },
+        { ACD_COL_COMP_ROOTS, store->roots, store->root_count * sizeof(uint32_t) },
+        { ACD_COL_COMP_BY_UID, b.by_uid, col },
+        { ACD_COL_TAG_ALIAS, b.tag_alias, tag_col },
+        { ACD_COL_TAG_NAME, b.tag_name, tag_col },
+        { ACD_COL_TAG_TYPE, tags ? tags->type : NULL, tag_col },
+        { ACD_COL_TAG_DIM0, tags ? tags->dim0 : NULL, tag_col },
+        { ACD_COL_TAG_DIM1, tags ? tags->dim1 : NULL, tag_col },
+        { ACD_COL_TAG_DIM2, tags ? tags->dim2 : NULL, tag_col },
+        { ACD_COL_TAG_SCOPE, tags ? tags->scope : NULL, tag_col },
+        { ACD_COL_TAG_ACCESS, tags ? tags->access : NULL, tag_count },
+        { ACD_COL_TYPE_NAME, b.type_name, type_count * sizeof(uint32_t) },
+        { ACD_COL_RUNG_UID, rungs ? rungs->uid : NULL, rung_col },
+        { ACD_COL_RUNG_ROUTINE, rungs ? rungs->routine : NULL, rung_col },
+        { ACD_COL_RUNG_TEXT, b.rung_text, rung_col },
+        { ACD_COL_PROGRAM_NAME, b.program_name, program_count * sizeof(uint32_t) },
+        { ACD_COL_DEF_TYPE, tags ? tags->def_type : NULL, def_col },
+        { ACD_COL_DEF_FAMILY, b.def_family, def_col },
+        { ACD_COL_DEF_CLASS, b.def_class, def_col },
+        { ACD_COL_DEF_MEMBER_START, member_start, def_col + sizeof(uint32_t) },
+        { ACD_COL_MEMBER_NAME, b.member_name, member_col },
+        { ACD_COL_MEMBER_TYPE, tags ? tags->member_type : NULL, member_col },
+        { ACD_COL_MEMBER_DIM, tags ? tags->member_dim : NULL, member_col },
+        { ACD_COL_MEMBER_HIDDEN, tags ? tags->member_hidden : NULL, member_count },
+    };
+    _Static_assert(sizeof(pending) / sizeof(pending[0]) == ACD_COL_SECTION_LIMIT - 1,
+                   "every section id needs a writer entry");
+
+    ColumnarHeader header = {0};
+    memcpy(header.magic, ACD_COLUMNAR_MAGIC, sizeof(header.magic));
+    header.version = ACD_COLUMNAR_VERSION;
+    header.byte_order = ACD_COLUMNAR_BYTE_ORDER;
+    header.section_count = (uint32_t)(sizeof(pending) / sizeof(pending[0]));
+    header.component_count = (uint32_t)n;
+    header.root_count = (uint32_t)store->root_count;
+    header.tag_count = (uint32_t)tag_count;
+    header.type_count = (uint32_t)type_count;
+    header.rung_count = (uint32_t)rung_count;
+    header.string_bytes = (uint32_t)b.strings.size;
+    header.program_count = (uint32_t)program_count;
+    header.datatype_count = (uint32_t)def_count;
+    header.member_count = (uint32_t)member_count;
+    header.controller_name = b.controller_name;
+
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        build_free(&b);
+        return -1;
+    }
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        build_free(&b);
+        return -1;
+    }
+    ok = write_sections(out, &header, pending) == 0;
+    if (fclose(out) != 0) ok = 0;
+    build_free(&b);
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+// Every entry of a column below limit
+static int all_below(const uint32_t *column, size_t count, size_t limit) {
+    for (size_t i = 0; i < count; i++) {
+        if (column[i] >= limit) return 0;
+    }
+    return 1;
+}
+
+// Bind each known section to its column, checking its size against the
+// header's counts. A section the file lacks stays NULL and is only an
+// error if its count says it should hold something.
+static int bind_sections(ColumnarFile *f, const ColumnarSection *table, uint32_t section_count) {
+    const ColumnarHeader *h = f->header;
+    const void *found[ACD_COL_SECTION_LIMIT] = {0};
+    uint64_t children_size = 0;
+    for (uint32_t i = 0; i < section_count; i++) {
+        const ColumnarSection *s = &table[i];
+        if (s->offset % 8 || s->offset > (uint64_t)f->map.file_size ||
+            s->size > (uint64_t)f->map.file_size - s->offset) {
+            return -1;
+        }
+        if (s->id == 0 || s->id >= ACD_COL_SECTION_LIMIT) continue;  // A later version's
+        if (found[s->id]) {
+            return -1;
+        }
+
+        size_t expect;
+        switch (s->id) {
+        case ACD_COL_STRINGS:
+            expect = h->string_bytes;
+            break;
+        case ACD_COL_COMP_CHILD_START:
+            expect = ((size_t)h->component_count + 1) * sizeof(uint32_t);
+            break;
+        case ACD_COL_COMP_CHILDREN:
+            expect = (size_t)s->size;  // Checked against child_start below
+            children_size = s->size;
+            break;
+        case ACD_COL_COMP_ROOTS:
+            expect = (size_t)h->root_count * sizeof(uint32_t);
+            break;
+        case ACD_COL_TAG_ACCESS:
+            expect = h->tag_count;
+            break;
+        case ACD_COL_TYPE_NAME:
+            expect = (size_t)h->type_count * sizeof(uint32_t);
+            break;
+        case ACD_COL_PROGRAM_NAME:
+            expect = (size_t)h->program_count * sizeof(uint32_t);
+            break;
+        case ACD_COL_DEF_MEMBER_START:
+            expect = ((size_t)h->datatype_count + 1) * sizeof(uint32_t);
+            break;
+        case ACD_COL_MEMBER_HIDDEN:
+            expect = h->member_count;
+            break;
+        default:
+            expect = (size_t)(s->id >= ACD_COL_MEMBER_NAME ? h->member_count :
+                              s->id >= ACD_COL_DEF_TYPE ? h->datatype_count :
+                              s->id >= ACD_COL_RUNG_UID ? h->rung_count :
+                              s->id >= ACD_COL_TAG_ALIAS ? h->tag_count : h->component_count) * sizeof(uint32_t);
+            break;
+        }
+        if (s->size != expect) {
+            return -1;
+        }
+        found[s->id] = f->map.data + s->offset;
+    }
+
+    f->strings = found[ACD_COL_STRINGS];
+    f->string_bytes = h->string_bytes;
+    f->comp_uid = found[ACD_COL_COMP_UID];
+    f->comp_parent = found[ACD_COL_COMP_PARENT];
+    f->comp_ordinal = found[ACD_COL_COMP_ORDINAL];
+    f->comp_name = found[ACD_COL_COMP_NAME];
+    f->comp_type = found[ACD_COL_COMP_TYPE];
+    f->comp_ioi = found[ACD_COL_COMP_IOI];
+    f->child_start = found[ACD_COL_COMP_CHILD_START];
+    f->children = found[ACD_COL_COMP_CHILDREN];
+    f->roots = found[ACD_COL_COMP_ROOTS];
+    f->by_uid = found[ACD_COL_COMP_BY_UID];
+    f->tag_name = found[ACD_COL_TAG_NAME];
+    f->tag_type = found[ACD_COL_TAG_TYPE];
+    f->tag_dim0 = found[ACD_COL_TAG_DIM0];
+    f->tag_dim1 = found[ACD_COL_TAG_DIM1];
+    f->tag_dim2 = found[ACD_COL_TAG_DIM2];
+    f->tag_scope = found[ACD_COL_TAG_SCOPE];
+    f->tag_access = found[ACD_COL_TAG_ACCESS];
+    f->tag_alias = found[ACD_COL_TAG_ALIAS];
+    f->type_name = found[ACD_COL_TYPE_NAME];
+    f->program_name = found[ACD_COL_PROGRAM_NAME];
+    f->def_type = found[ACD_COL_DEF_TYPE];
+    f->def_family = found[ACD_COL_DEF_FAMILY];
+    f->def_class = found[ACD_COL_DEF_CLASS];
+    f->def_member_start = found[ACD_COL_DEF_MEMBER_START];
+    f->member_name = found[ACD_COL_MEMBER_NAME];
+    f->member_type = found[ACD_COL_MEMBER_TYPE];
+    f->member_dim = found[ACD_COL_MEMBER_DIM];
+    f->member_hidden = found[ACD_COL_MEMBER_HIDDEN];
+    f->rung_uid = found[ACD_COL_RUNG_UID];
+    f->rung_routine = found[ACD_COL_RUNG_ROUTINE];
+    f->rung_text = found[ACD_COL_RUNG_TEXT];
+
+    // All of a table's columns, or (when it is empty) none needed
+    if (!f->strings || h->string_bytes == 0 || f->strings[0] || f->strings[h->string_bytes - 1]) {
+        return -1;
+    }
+    if (h->component_count &&
+        (!f->comp_uid || !f->comp_parent || !f->comp_ordinal || !f->comp_name || !f->comp_type ||
+         !f->comp_ioi || !f->child_start || !f->by_uid)) {
+        return -1;
+    }
+    if (h->tag_count && (!f->tag_name || !f->tag_type || !f->tag_dim0 || !f->tag_dim1 || !f->tag_dim2 ||
+                         !f->tag_scope || !f->tag_access || !f->tag_alias || !f->type_name)) {
+        return -1;
+    }
+    if (h->datatype_count && (!f->def_type || !f->def_family || !f->def_class || !f->def_member_start)) {
+        return -1;
+    }
+    if (h->member_count && (!f->member_name || !f->member_type || !f->member_dim || !f->member_hidden)) {
+        return -1;
+    }
+    if ((h->program_count && !f->program_name) || h->controller_name >= h->string_bytes) {
+        return -1;
+    }
+    if (f->def_member_start && f->def_member_start[h->datatype_count] != (f->member_name ? h->member_count : 0)) {
+        return -1;
+    }
+    if (h->rung_count && (!f->rung_uid || !f->rung_routine || !f->rung_text)) {
+        return -1;
+    }
+    if ((h->root_count && !f->roots) || (h->type_count && !f->type_name)) {
+        return -1;
+    }
+    if (f->child_start && (uint64_t)f->child_start[h->component_count] * sizeof(uint32_t) != children_size) {
+        return -1;
+    }
+    f->component_count = f->comp_uid ? h->component_count : 0;
+    f->root_count = f->roots ? h->root_count : 0;
+    f->tag_count = f->tag_name ? h->tag_count : 0;
+    f->type_count = f->type_name ? h->type_count : 0;
+    f->program_count = f->program_name ? h->program_count : 0;
+    f->controller_name = h->controller_name;
+    f->datatype_count = f->def_type ? h->datatype_count : 0;
+    f->member_count = f->member_name ? h->member_count : 0;
+    f->rung_count = f->rung_uid ? h->rung_count : 0;
+    return 0;
+}
+
+// Offsets into the string table, indices into their tables, and the CSR
+// rows; after this no accessor can step outside the mapping
+static int check_columns(const ColumnarFile *f) {
+    size_t n = f->component_count, sb = f->string_bytes;
+    if (n && f->child_start[0] != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (f->child_start[i + 1] < f->child_start[i]) return -1;
+    }
+    if (!all_below(f->comp_name, n, sb) || !all_below(f->comp_type, n, sb) || !all_below(f->comp_ioi, n, sb) ||
+        !all_below(f->by_uid, n, n) || !all_below(f->roots, f->root_count, n) ||
+        !all_below(f->tag_name, f->tag_count, sb) || !all_below(f->tag_type, f->tag_count, f->type_count) ||
+        !all_below(f->tag_alias, f->tag_count, sb) || !all_below(f->tag_scope, f->tag_count, f->program_count + 1) ||
+        !all_below(f->type_name, f->type_count, sb) || !all_below(f->program_name, f->program_count, sb) ||
+        !all_below(f->rung_text, f->rung_count, sb)) {
+        return -1;
+    }
+    size_t defs = f->datatype_count, members = f->member_count;
+    if (!all_below(f->def_type, defs, f->type_count) || !all_below(f->def_family, defs, sb) ||
+        !all_below(f->def_class, defs, sb) || !all_below(f->member_name, members, sb) ||
+        !all_below(f->member_type, members, f->type_count)) {
+        return -1;
+    }
+    if (defs && f->def_member_start[0] != 0) {
+        return -1;
+    }
+    for (size_t d = 0; d < defs; d++) {
+        if (f->def_member_start[d + 1] < f->def_member_start[d]) return -1;
+    }
+    if (n && f->children && !all_below(f->children, f->child_start[n], n)) {
+        return -1;
+    }
+    return 0;
+}
+
+int acd_columnar_open(ColumnarFile *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+    if (acd_file_open(&file->map, path) != 0) {
+        return -1;
+    }
+
+    const ColumnarHeader *header = (const ColumnarHeader *)acd_file_ptr(&file->map, 0, sizeof(*header));
+    if (!header ||
+        memcmp(header->magic, ACD_COLUMNAR_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ACD_COLUMNAR_VERSION ||
+        header->byte_order != ACD_COLUMNAR_BYTE_ORDER) {
+        acd_columnar_close(file);
+        return -1;
+    }
+    file->header = header;
+
+    const ColumnarSection *table = (const ColumnarSection *)acd_file_ptr(
+        &file->map, sizeof(*header), (size_t)header->section_count * sizeof(*table));
+    if (!table || bind_sections(file, table, header->section_count) != 0 || check_columns(file) != 0) {
+        acd_columnar_close(file);
+        return -1;
+    }
+    return 0;
+}
+
+void acd_columnar_close(ColumnarFile *file) {
+    acd_file_close(&file->map);
+    memset(file, 0, sizeof(*file));
+}
+
+long acd_columnar_find(const ColumnarFile *file, uint32_t uid) {
+    size_t lo = 0, hi = file->component_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (file->comp_uid[file->by_uid[mid]] < uid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < file->component_count && file->comp_uid[file->by_uid[lo]] == uid ? (long)file->by_uid[lo] : -1;
+}
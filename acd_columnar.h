@@ -0,0 +1,175 @@
+#ifndef ACD_COLUMNAR_H
+#define ACD_COLUMNAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_store.h"
+#include "acd_tags.h"
+#include "acd_rll.h"
+
+// Columnar project export: <project>.acdcol
+//
+// Components, tags (with their programs and data type definitions) and
+// rungs as fixed-width column arrays that a reader
+// maps and queries in place, with no XML to write or parse. Every string
+// (names, IOIs, type names, rung text) is stored once, NUL-terminated, in
+// one string table, and columns hold u32 offsets into it; offset 0 is "".
+// The component hierarchy is the store's CSR form: the children of
+// component i are children[child_start[i] .. child_start[i + 1]) in
+// ordinal order. by_uid lists component indices sorted by UID (ties in
+// index order) for binary-search lookup. Data type members are CSR the
+// same way, by def_member_start.
+//
+// Layout (little-endian): header, a table of section_count sections, then
+// the sections, each 8-byte aligned. A section is found by id, not by
+// position, so a reader skips ids it doesn't know and a later version can
+// add columns without breaking older readers; changing an existing
+// column's meaning bumps the version.
+#define ACD_COLUMNAR_SUFFIX ".acdcol"
+#define ACD_COLUMNAR_MAGIC "ACDCOL\0"
+#define ACD_COLUMNAR_VERSION 2
+#define ACD_COLUMNAR_BYTE_ORDER 0x01020304u
+
+typedef enum {
+    ACD_COL_STRINGS = 1,         // char, string_bytes
+    ACD_COL_COMP_UID,            // u32 per component
+    ACD_COL_COMP_PARENT,
+    ACD_COL_COMP_ORDINAL,
+    ACD_COL_COMP_NAME,           // String offsets
+    ACD_COL_COMP_TYPE,
+    ACD_COL_COMP_IOI,
+    ACD_COL_COMP_CHILD_START,    // u32, component_count + 1
+    ACD_COL_COMP_CHILDREN,       // u32 component indices
+    ACD_COL_COMP_ROOTS,          // u32 component indices, root_count
+    ACD_COL_COMP_BY_UID,         // u32 component indices
+    ACD_COL_TAG_ALIAS,           // String offset per tag, 0 = base tag
+    ACD_COL_TAG_NAME,
+    ACD_COL_TAG_TYPE,            // Index into TYPE_NAME
+    ACD_COL_TAG_DIM0,
+    ACD_COL_TAG_DIM1,
+    ACD_COL_TAG_DIM2,
+    ACD_COL_TAG_SCOPE,           // Program index + 1, TAG_SCOPE_CONTROLLER
+    ACD_COL_TAG_ACCESS,          // u8 TagAccess per tag
+    ACD_COL_TYPE_NAME,           // String offset per data type
+    ACD_COL_RUNG_UID,            // u32 per rung
+    ACD_COL_RUNG_ROUTINE,
+    ACD_COL_RUNG_TEXT,           // String offset
+    ACD_COL_PROGRAM_NAME,        // String offset per program
+    ACD_COL_DEF_TYPE,            // Index into TYPE_NAME, per definition
+    ACD_COL_DEF_FAMILY,          // String offsets
+    ACD_COL_DEF_CLASS,
+    ACD_COL_DEF_MEMBER_START,    // u32, datatype_count + 1
+    ACD_COL_MEMBER_NAME,         // String offset per member
+    ACD_COL_MEMBER_TYPE,         // Index into TYPE_NAME
+    ACD_COL_MEMBER_DIM,
+    ACD_COL_MEMBER_HIDDEN,       // u8 per member
+    ACD_COL_SECTION_LIMIT
+} ColumnarSectionId;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t section_count;
+    uint32_t component_count;
+    uint32_t root_count;
+    uint32_t tag_count;
+    uint32_t type_count;
+    uint32_t rung_count;
+    uint32_t string_bytes;
+    uint32_t program_count;
+    uint32_t datatype_count;
+    uint32_t member_count;
+    uint32_t controller_name;    // String offset, 0 = unknown
+    uint32_t reserved;
+} ColumnarHeader;
+
+typedef struct {
+    uint32_t id;                 // ColumnarSectionId
+    uint32_t reserved;
+    uint64_t offset;             // From the start of the file
+    uint64_t size;               // Bytes
+} ColumnarSection;
+
+// A mapped, validated export. Columns point into the mapping; ones the
+// file lacks are NULL (and their counts 0). Every offset and index column
+// has been checked against its target, so lookups need no bounds checks.
+typedef struct {
+    ACD_File map;
+    const ColumnarHeader *header;
+    const char *strings;
+    size_t string_bytes;
+
+    size_t component_count;
+    const uint32_t *comp_uid;
+    const uint32_t *comp_parent;
+    const uint32_t *comp_ordinal;
+    const uint32_t *comp_name;
+    const uint32_t *comp_type;
+    const uint32_t *comp_ioi;
+    const uint32_t *child_start;
+    const uint32_t *children;
+    const uint32_t *roots;
+    size_t root_count;
+    const uint32_t *by_uid;
+
+    size_t tag_count;
+    const uint32_t *tag_name;
+    const uint32_t *tag_type;
+    const uint32_t *tag_dim0;
+    const uint32_t *tag_dim1;
+    const uint32_t *tag_dim2;
+    const uint32_t *tag_scope;
+    const uint8_t *tag_access;
+    const uint32_t *tag_alias;
+    size_t type_count;
+    const uint32_t *type_name;
+    size_t program_count;
+    const uint32_t *program_name;
+    uint32_t controller_name;
+
+    size_t datatype_count;
+    const uint32_t *def_type;
+    const uint32_t *def_family;
+    const uint32_t *def_class;
+    const uint32_t *def_member_start;
+    size_t member_count;
+    const uint32_t *member_name;
+    const uint32_t *member_type;
+    const uint32_t *member_dim;
+    const uint8_t *member_hidden;
+
+    size_t rung_count;
+    const uint32_t *rung_uid;
+    const uint32_t *rung_routine;
+    const uint32_t *rung_text;
+} ColumnarFile;
+
+// Write store (index built), and tags and rungs when not NULL, to path
+// atomically (temp file + rename). Returns 0, or -1 on allocation or
+// write failure, or if a table outgrows the format's u32 offsets.
+int acd_columnar_write(const char *path, const ComponentStore *store, const TagTable *tags,
+                       const RungTable *rungs);
+
+// Map and validate an export. Returns 0, or -1 if it is missing,
+// malformed, or of another version or byte order.
+int acd_columnar_open(ColumnarFile *file, const char *path);
+
+void acd_columnar_close(ColumnarFile *file);
+
+// Index of the component with this UID (the first, if repeated), or -1
+long acd_columnar_find(const ColumnarFile *file, uint32_t uid);
+
+static inline const char *acd_columnar_str(const ColumnarFile *file, uint32_t offset) {
+    return file->strings + offset;
+}
+
+// Children of component index in ordinal order
+static inline const uint32_t *acd_columnar_children(const ColumnarFile *file, size_t index, size_t *count) {
+    *count = file->child_start[index + 1] - file->child_start[index];
+    return file->children + file->child_start[index];
+}
+
+#endif
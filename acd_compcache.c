@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_compcache.h"
+
+_Static_assert(sizeof(CompCacheHeader) == 24, "cache header layout changed");
+_Static_assert(sizeof(CompCacheEntry) == 24, "cache entry layout changed");
+_Static_assert(sizeof(CompCacheComponent) == 36, "cache component layout changed");
+
+#define PAD4(n) (((n) + 3) & ~(size_t)3)
+
+int comp_cache_path(const char *acd_path, char *out, size_t out_size) {
+    int n = snprintf(out, out_size, "%s%s", acd_path, ACD_COMPCACHE_SUFFIX);
+    return n < 0 || (size_t)n >= out_size ? -1 : 0;
+}
+
+static int compare_key(uint32_t crc, uint32_t size, uint32_t csize, const CompCacheEntry *e) {
+    if (crc != e->crc32) return crc < e->crc32 ? -1 : 1;
+    if (size != e->uncompressed_size) return size < e->uncompressed_size ? -1 : 1;
+    if (csize != e->compressed_size) return csize < e->compressed_size ? -1 : 1;
+    return 0;
+}
+
+static int compare_entries(const void *pa, const void *pb) {
+    const CompCacheEntry *a = *(const CompCacheEntry *const *)pa;
+    const CompCacheEntry *b = *(const CompCacheEntry *const *)pb;
+    return compare_key(a->crc32, a->uncompressed_size, a->compressed_size, b);
+}
+
+int comp_cache_load(CompCache *cache, const char *acd_path) {
+    memset(cache, 0, sizeof(*cache));
+
+    char path[4096];
+    if (comp_cache_path(acd_path, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    if (acd_file_open(&cache->map, path) != 0) {
+        return -1;
+    }
+
+    const CompCacheHeader *header = (const CompCacheHeader *)acd_file_ptr(&cache->map, 0, sizeof(*header));
+    if (!header ||
+        memcmp(header->magic, ACD_COMPCACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ACD_COMPCACHE_VERSION ||
+        header->byte_order != ACD_COMPCACHE_BYTE_ORDER) {
+        comp_cache_close(cache);
+        return -1;
+    }
+
+    cache->entries = calloc(header->block_count ? header->block_count : 1, sizeof(*cache->entries));
+    if (!cache->entries) {
+        comp_cache_close(cache);
+        return -1;
+    }
+
+    // Walk the variable-size records, checking each lies inside the file
+    long pos = sizeof(*header);
+    for (uint32_t i = 0; i < header->block_count; i++) {
+        const CompCacheEntry *e = (const CompCacheEntry *)acd_file_ptr(&cache->map, pos, sizeof(*e));
+        if (!e) {
+            comp_cache_close(cache);
+            return -1;
+        }
+        size_t body = (size_t)e->component_count * sizeof(CompCacheComponent) + PAD4((size_t)e->string_bytes);
+        if (!acd_file_ptr(&cache->map, pos + (long)sizeof(*e), body)) {
+            comp_cache_close(cache);
+            return -1;
+        }
+        cache->entries[cache->count++] = e;
+        pos += (long)(sizeof(*e) + body);
+    }
+
+    qsort(cache->entries, cache->count, sizeof(*cache->entries), compare_entries);
+    return 0;
+}
+
+void comp_cache_close(CompCache *cache) {
+    free(cache->entries);
+    acd_file_close(&cache->map);
+    memset(cache, 0, sizeof(*cache));
+}
+
+const CompCacheEntry *comp_cache_find(const CompCache *cache, const CompressedBlock *block) {
+    size_t lo = 0, hi = cache->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = compare_key(block->crc32, block->uncompressed_size, block->compressed_size,
+                            cache->entries[mid]);
+        if (c == 0) return cache->entries[mid];
+        if (c < 0) hi = mid;
+        else lo = mid + 1;
+    }
+    return NULL;
+}
+
+static int intern_cached(StringPool *pool, const char *strings, uint32_t string_bytes,
+                         StrRef in, StrRef *out) {
+    if (in.len == 0) {
+        *out = (StrRef){0, 0};
+        return 0;
+    }
+    if (in.offset > string_bytes || in.len > string_bytes - in.offset) {
+        return -1;
+    }
+    return string_pool_intern(pool, strings + in.offset, in.len, out);
+}
+
+int comp_cache_apply(const CompCacheEntry *entry, ComponentStore *store) {
+    const CompCacheComponent *items = (const CompCacheComponent *)(entry + 1);
+    const char *strings = (const char *)(items + entry->component_count);
+
+    if (component_store_reserve(store, entry->component_count) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < entry->component_count; i++) {
+        Component comp = {
+            .uid = items[i].uid,
+            .parent_uid = items[i].parent_uid,
+            .ordinal = items[i].ordinal,
+        };
+        if (intern_cached(&store->strings, strings, entry->string_bytes, items[i].name, &comp.name) != 0 ||
+            intern_cached(&store->strings, strings, entry->string_bytes, items[i].ioi, &comp.ioi) != 0 ||
+            intern_cached(&store->strings, strings, entry->string_bytes, items[i].type, &comp.type) != 0) {
+            return -1;
+        }
+        store->items[store->count++] = comp;
+    }
+    return (int)entry->component_count;
+}
+
+// Re-intern a store string into the block's own pool
+static int pack_string(StringPool *pool, const ComponentStore *store, StrRef ref, StrRef *out) {
+    return string_pool_intern(pool, component_str(store, ref), ref.len, out);
+}
+
+static int write_block(FILE *out, const CompCacheBlock *block, const ComponentStore *store) {
+    StringPool strings;
+    if (string_pool_init(&strings) != 0) {
+        return -1;
+    }
+    CompCacheComponent *items = malloc((block->count ? block->count : 1) * sizeof(*items));
+    if (!items) {
+        string_pool_free(&strings);
+        return -1;
+    }
+
+    int ok = 1;
+    for (size_t i = 0; ok && i < block->count; i++) {
+        const Component *comp = &store->items[block->first + i];
+        items[i] = (CompCacheComponent){
+            .uid = comp->uid,
+            .parent_uid = comp->parent_uid,
+            .ordinal = comp->ordinal,
+        };
+        ok = pack_string(&strings, store, comp->name, &items[i].name) == 0 &&
+             pack_string(&strings, store, comp->ioi, &items[i].ioi) == 0 &&
+             pack_string(&strings, store, comp->type, &items[i].type) == 0;
+    }
+
+    CompCacheEntry entry = {
+        .crc32 = block->crc32,
+        .uncompressed_size = block->uncompressed_size,
+        .compressed_size = block->compressed_size,
+        .component_count = (uint32_t)block->count,
+        .string_bytes = (uint32_t)strings.size,
+    };
+    static const char padding[4];
+    ok = ok && fwrite(&entry, sizeof(entry), 1, out) == 1 &&
+         fwrite(items, sizeof(*items), block->count, out) == block->count &&
+         fwrite(strings.data, 1, strings.size, out) == strings.size &&
+         fwrite(padding, 1, PAD4(strings.size) - strings.size, out) == PAD4(strings.size) - strings.size;
+
+    free(items);
+    string_pool_free(&strings);
+    return ok ? 0 : -1;
+}
+
+int comp_cache_write(const char *acd_path, const CompCacheBlock *blocks, size_t count,
+                     const ComponentStore *store) {
+    char path[4096], tmp[4096 + 8];
+    if (comp_cache_path(acd_path, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        return -1;
+    }
+
+    CompCacheHeader header = {0};
+    memcpy(header.magic, ACD_COMPCACHE_MAGIC, sizeof(header.magic));
+    header.version = ACD_COMPCACHE_VERSION;
+    header.byte_order = ACD_COMPCACHE_BYTE_ORDER;
+    header.block_count = (uint32_t)count;
+
+    int ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = write_block(out, &blocks[i], store) == 0;
+    }
+
+    if (fclose(out) != 0) ok = 0;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef ACD_COMPCACHE_H
+#define ACD_COMPCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_store.h"
+
+// Sidecar component cache: <file>.acdcomps next to the ACD
+//
+// Components parsed out of each block, keyed by the block's CRC32, ISIZE
+// and compressed size. A re-saved project usually changes a few members;
+// every other block's components come back from here without inflating
+// or decoding it. Blocks that held no components are recorded too, so
+// they aren't inflated again to find that out.
+//
+// Layout (little-endian): header, then per block an entry, its
+// component_count components and string_bytes of string data (padded to
+// 4 bytes). Component strings are offset/length into that data.
+#define ACD_COMPCACHE_SUFFIX ".acdcomps"
+#define ACD_COMPCACHE_MAGIC "ACDCMP\0"
+#define ACD_COMPCACHE_VERSION 1
+#define ACD_COMPCACHE_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t block_count;
+    uint32_t reserved;
+} CompCacheHeader;
+
+typedef struct {
+    uint32_t crc32;
+    uint32_t uncompressed_size;
+    uint32_t compressed_size;
+    uint32_t component_count;
+    uint32_t string_bytes;
+    uint32_t reserved;
+} CompCacheEntry;
+
+typedef struct {
+    uint32_t uid;
+    uint32_t parent_uid;
+    uint32_t ordinal;
+    StrRef name;
+    StrRef ioi;
+    StrRef type;
+} CompCacheComponent;
+
+// A loaded (mapped) cache; entries sorted by key for lookup
+typedef struct {
+    ACD_File map;
+    const CompCacheEntry **entries;
+    size_t count;
+} CompCache;
+
+// Components a run took from one block, for comp_cache_write: the store
+// range [first, first + count)
+typedef struct {
+    uint32_t crc32;
+    uint32_t uncompressed_size;
+    uint32_t compressed_size;
+    size_t first;
+    size_t count;
+} CompCacheBlock;
+
+// Build "<acd_path>.acdcomps" into out. Returns -1 if it doesn't fit.
+int comp_cache_path(const char *acd_path, char *out, size_t out_size);
+
+// Map the cache for acd_path. Returns 0, or -1 if missing or malformed.
+int comp_cache_load(CompCache *cache, const char *acd_path);
+
+void comp_cache_close(CompCache *cache);
+
+// Entry for a block with this content, or NULL
+const CompCacheEntry *comp_cache_find(const CompCache *cache, const CompressedBlock *block);
+
+// Append an entry's components to store. Returns the count, or -1.
+int comp_cache_apply(const CompCacheEntry *entry, ComponentStore *store);
+
+// Write the cache for acd_path atomically (temp file + rename)
+int comp_cache_write(const char *acd_path, const CompCacheBlock *blocks, size_t count,
+                     const ComponentStore *store);
+
+#endif
@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <zlib.h>
+#include <sys/stat.h>
+
+#include "acd_comps.h"
+#include "acd_stats.h"
+
+// Find a null-terminated string in data (no copy)
+const char *read_string(const unsigned char *data, size_t offset, size_t max_len, size_t *len) {
+    const unsigned char *start = data + offset;
+    const unsigned char *nul = memchr(start, 0, max_len);
+    *len = nul ? (size_t)(nul - start) : max_len;
+    return (const char *)start;
+}
+
+// Read 32-bit little-endian integer
+uint32_t read_uint32_le(const unsigned char *data, size_t offset) {
+    return (uint32_t)data[offset] | 
+           ((uint32_t)data[offset + 1] << 8) | 
+           ((uint32_t)data[offset + 2] << 16) | 
+           ((uint32_t)data[offset + 3] << 24);
+}
+
+// Comps layout, as decoded here:
+//
+//   "Comps\0"  field names, each NUL-terminated, then an empty name
+//   ".dat"      u32 size of the record area, then the records
+//   ".idx"      u32 record count, then one u32 per record: its offset
+//               from the start of the record area
+//
+// A record holds the fields in schema order. Fields named *UId and
+// Ordinal are u32 little-endian; everything else is a string with a u8
+// length prefix (e.g. "\fCTRL_FLT_1_1").
+typedef enum {
+    FIELD_SKIP = 0,
+    FIELD_UID,
+    FIELD_NAME,
+    FIELD_IOI,
+    FIELD_PARENT_UID,
+    FIELD_ORDINAL,
+    FIELD_TYPE
+} CompsTarget;
+
+typedef struct {
+    int is_u32;
+    CompsTarget target;
+} CompsField;
+
+static int ends_with(const char *s, const char *suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static CompsField schema_field(const char *name) {
+    CompsField field = { 0, FIELD_SKIP };
+    if (ends_with(name, "UId") || strcmp(name, "Ordinal") == 0) {
+        field.is_u32 = 1;
+    }
+    if (strcmp(name, "CompUId") == 0) field.target = FIELD_UID;
+    else if (strcmp(name, "CompName") == 0) field.target = FIELD_NAME;
+    else if (strcmp(name, "CompIOI") == 0) field.target = FIELD_IOI;
+    else if (ends_with(name, "ParentUId")) field.target = FIELD_PARENT_UID;
+    else if (strcmp(name, "Ordinal") == 0) field.target = FIELD_ORDINAL;
+    else if (ends_with(name, "Type")) field.target = FIELD_TYPE;
+    return field;
+}
+
+// Decode one record at data[pos, end), interning its strings. Returns 0,
+// or -1 if it runs past end or the pool can't grow.
+static int decode_record(StringPool *strings, const unsigned char *data, size_t pos, size_t end,
+                         const CompsField *schema, int field_count, Component *comp) {
+    memset(comp, 0, sizeof(*comp));
+    for (int f = 0; f < field_count; f++) {
+        if (schema[f].is_u32) {
+            if (end - pos < 4) return -1;
+            uint32_t value = read_uint32_le(data, pos);
+            pos += 4;
+            switch (schema[f].target) {
+                case FIELD_UID: comp->uid = value; break;
+                case FIELD_PARENT_UID: comp->parent_uid = value; break;
+                case FIELD_ORDINAL: comp->ordinal = value; break;
+                default: break;
+            }
+        } else {
+            if (end - pos < 1) return -1;
+            size_t len = data[pos++];
+            if (end - pos < len) return -1;
+            StrRef *target = NULL;
+            switch (schema[f].target) {
+                case FIELD_NAME: target = &comp->name; break;
+                case FIELD_IOI: target = &comp->ioi; break;
+                case FIELD_TYPE: target = &comp->type; break;
+                default: break;
+            }
+            if (target && string_pool_intern(strings, data + pos, len, target) != 0) {
+                return -1;
+            }
+            pos += len;
+        }
+    }
+    return 0;
+}
+
+int read_database_header(const unsigned char *data, size_t size, size_t name_offset,
+                         DatabaseHeader *header) {
+    memset(header, 0, sizeof(*header));
+    if (name_offset >= size) {
+        return -1;
+    }
+    size_t len;
+    const char *name = read_string(data, name_offset, size - name_offset, &len);
+    memcpy(header->name, name, len < sizeof(header->name) ? len : sizeof(header->name) - 1);
+    size_t offset = name_offset + len + 1;
+    
+    // Field names, up to the empty one
+    while (offset < size && header->field_count < DATABASE_MAX_FIELDS) {
+        size_t left = size - offset;
+        const char *text = read_string(data, offset, left < 50 ? left : 50, &len);
+        if (len == 0) break;
+        header->fields[header->field_count] = text;
+        header->field_lens[header->field_count] = len;
+        header->field_count++;
+        offset += len + 1;
+    }
+    
+    // Look for .dat and .idx markers
+    size_t dat_offset = 0, idx_offset = 0;
+    uint32_t dat_size = 0, record_count = 0;
+    
+    for (size_t i = offset; i + 8 <= size; i++) {
+        if (!dat_offset && memcmp(data + i, ".dat", 4) == 0) {
+            dat_size = read_uint32_le(data, i + 4);
+            dat_offset = i + 8;  // Skip ".dat" and its size
+            
+            // The .idx marker normally sits right after the records
+            if (dat_size <= size - dat_offset && size - dat_offset - dat_size >= 8 &&
+                memcmp(data + dat_offset + dat_size, ".idx", 4) == 0) {
+                i = dat_offset + dat_size;
+            } else {
+                i = dat_offset - 1;
+                continue;
+            }
+        }
+        if (dat_offset && i >= dat_offset && memcmp(data + i, ".idx", 4) == 0) {
+            record_count = read_uint32_le(data, i + 4);
+            idx_offset = i + 8;  // Skip ".idx" and its record count
+            break;
+        }
+    }
+    if (!dat_offset || !idx_offset || idx_offset > UINT32_MAX) {
+        return -1;
+    }
+    
+    // The record area ends at the .dat size, or at the .idx marker
+    size_t dat_end = idx_offset - 8;
+    if (dat_size && dat_size <= dat_end - dat_offset) {
+        dat_end = dat_offset + dat_size;
+    }
+    header->record_count = record_count;
+    header->record_size = (uint32_t)(dat_end - dat_offset);
+    header->data_offset = (uint32_t)dat_offset;
+    header->index_offset = (uint32_t)idx_offset;
+    return 0;
+}
+
+// Parse the Comps database
+static int parse_database(ComponentStore *store, const unsigned char *data, size_t data_size,
+                          size_t start_offset) {
+    if (!acd_quiet) printf("\n📊 Parsing Comps Database...\n");
+    
+    DatabaseHeader header;
+    int framed = read_database_header(data, data_size, start_offset, &header);
+    
+    // Read field names
+    if (!acd_quiet) printf("   Database fields:\n");
+    CompsField schema[DATABASE_MAX_FIELDS];
+    int field_count = header.field_count;
+    for (int f = 0; f < field_count; f++) {
+        StrRef name;
+        if (string_pool_intern(&store->strings, header.fields[f], header.field_lens[f], &name) != 0) {
+            return -1;
+        }
+        const char *field = component_str(store, name);
+        schema[f] = schema_field(field);
+        if (!acd_quiet) printf("      [%d] %s\n", f, field);
+    }
+    
+    if (framed != 0) {
+        if (!acd_quiet) printf("   ⚠️  No .dat/.idx sections\n");
+        return 0;
+    }
+    size_t dat_offset = header.data_offset, idx_offset = header.index_offset;
+    size_t dat_end = dat_offset + header.record_size;
+    uint32_t record_count = header.record_count;
+    if (!acd_quiet) {
+        printf("   📍 Found .dat section at: 0x%zx\n", dat_offset);
+        printf("   📍 Found .idx section at: 0x%zx\n", idx_offset);
+    }
+    if (record_count > (data_size - idx_offset) / 4) {
+        if (!acd_quiet) {
+            printf("   ⚠️  .idx claims %u records, only room for %zu\n",
+                   record_count, (data_size - idx_offset) / 4);
+        }
+        record_count = (uint32_t)((data_size - idx_offset) / 4);
+    }
+    
+    // One index entry per record: jump straight to it
+    if (!acd_quiet) printf("\n   📖 Decoding %u component records...\n", record_count);
+    int decoded = 0, bad = 0;
+    if (component_store_reserve(store, record_count) != 0) {
+        return -1;
+    }
+    
+    for (uint32_t r = 0; r < record_count; r++) {
+        size_t record = dat_offset + read_uint32_le(data, idx_offset + (size_t)r * 4);
+        Component comp;
+        if (record >= dat_end ||
+            decode_record(&store->strings, data, record, dat_end, schema, field_count, &comp) != 0) {
+            bad++;
+            continue;
+        }
+        
+        store->items[store->count++] = comp;
+        if (decoded++ < 20 && !acd_quiet) {
+            printf("      Component %zu: UID=%u, Name='%s', Parent=%u, Ordinal=%u\n",
+                   store->count, comp.uid, component_str(store, comp.name),
+                   comp.parent_uid, comp.ordinal);
+        }
+    }
+    if (decoded > 20 && !acd_quiet) {
+        printf("      ... %d more\n", decoded - 20);
+    }
+    if (bad && !acd_quiet) {
+        printf("   ⚠️  %d records out of bounds\n", bad);
+    }
+    
+    if (!acd_quiet) printf("   ✅ Found %d components\n", decoded);
+    
+    // Parent/child links for the whole store, so walks are linear
+    if (component_store_build_index(store) != 0) {
+        return -1;
+    }
+    if (!acd_quiet) printf("   🌳 Hierarchy: %zu components, %zu roots\n", store->count, store->root_count);
+    return decoded;
+}
+
+int parse_comps_database(ComponentStore *store, const unsigned char *data, size_t data_size,
+                         size_t start_offset) {
+    uint64_t start = acd_now_ns();
+    int decoded = parse_database(store, data, data_size, start_offset);
+    acd_stat_time(&acd_stats.parse_ns, start);
+    if (decoded > 0) acd_stat_add(&acd_stats.components, (uint64_t)decoded);
+    return decoded;
+}
+
+// Find and parse the Comps database inside one decompressed block
+int parse_block(ComponentStore *store, const unsigned char *data, size_t size) {
+    size_t comps_offset = 0;
+    for (size_t i = 0; i + 5 <= size; i++) {
+        if (memcmp(data + i, "Comps", 5) == 0) {
+            comps_offset = i;
+            break;
+        }
+    }
+    
+    if (comps_offset > 0) {
+        return parse_comps_database(store, data, size, comps_offset);
+    }
+    return 0;
+}
+
+static void record_range(CompsParse *parse, size_t i, size_t first) {
+    const CompressedBlock *block = &parse->blocks[i];
+    parse->ranges[i] = (CompCacheBlock){
+        block->crc32, block->uncompressed_size, block->compressed_size,
+        first, parse->store->count - first,
+    };
+}
+
+// Append cached components of every block before offset, keeping the
+// store in block order whichever way each block was read
+static void apply_cached_until(CompsParse *parse, long offset) {
+    for (; parse->next < parse->count && parse->blocks[parse->next].offset < offset; parse->next++) {
+        const CompCacheEntry *entry = parse->cached[parse->next];
+        if (!entry) continue;
+        size_t first = parse->store->count;
+        if (comp_cache_apply(entry, parse->store) > 0) {
+            parse->parsed++;
+        }
+        record_range(parse, parse->next, first);
+        parse->reused_components += parse->store->count - first;
+        acd_stat_add(&acd_stats.components_reused, parse->store->count - first);
+    }
+}
+
+int comps_parse_begin(CompsParse *parse, ComponentStore *store, const CompressedBlock *blocks,
+                      size_t count, const char *acd_path) {
+    memset(parse, 0, sizeof(*parse));
+    parse->store = store;
+    if (!acd_path || !blocks) {
+        return 0;
+    }
+    
+    parse->acd_path = acd_path;
+    parse->have_cache = comp_cache_load(&parse->cache, acd_path) == 0;
+    parse->blocks = blocks;
+    parse->count = count;
+    parse->cached = calloc(count ? count : 1, sizeof(*parse->cached));
+    parse->ranges = calloc(count ? count : 1, sizeof(*parse->ranges));
+    if (!parse->cached || !parse->ranges) {
+        comps_parse_finish(parse, -1);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        parse->cached[i] = parse->have_cache ? comp_cache_find(&parse->cache, &blocks[i]) : NULL;
+        if (!parse->cached[i]) {
+            parse->miss_count++;
+        }
+    }
+    if (parse->have_cache && !acd_quiet) {
+        printf("♻️  %zu of %zu blocks unchanged since the cached parse\n", count - parse->miss_count, count);
+    }
+    return 0;
+}
+
+const CompCacheEntry *comps_parse_cached(const CompsParse *parse, size_t i) {
+    return parse->cached ? parse->cached[i] : NULL;
+}
+
+// Pipeline handler: a block whose head names the Comps database
+int comps_block_handler(const CompressedBlock *block, const unsigned char *data,
+                        size_t size, void *ctx) {
+    CompsParse *parse = ctx;
+    size_t first = parse->store->count;
+    int here = 0;
+    if (parse->cached) {
+        apply_cached_until(parse, block->offset);
+        first = parse->store->count;
+        here = parse->next < parse->count && parse->blocks[parse->next].offset == block->offset;
+        if (here && parse->cached[parse->next]) {
+            // Routed for another reason; the cache already has its components
+            apply_cached_until(parse, block->offset + 1);
+            return 0;
+        }
+    }
+    
+    if (!acd_quiet) printf("\n🗜️  Comps block at offset 0x%lx (%zu bytes)\n", block->offset, size);
+    parse_block(parse->store, data, size);
+    parse->parsed++;
+    
+    if (here) {
+        record_range(parse, parse->next++, first);
+    }
+    return 0;
+}
+
+int comps_parse_finish(CompsParse *parse, int status) {
+    if (parse->cached && status == 0) {
+        apply_cached_until(parse, LONG_MAX);
+        if (parse->reused_components) {
+            if (!acd_quiet) printf("♻️  Reused %zu cached components\n", parse->reused_components);
+            if (component_store_build_index(parse->store) != 0) {
+                status = -1;
+            } else if (!acd_quiet) {
+                printf("   🌳 Hierarchy: %zu components, %zu roots\n", parse->store->count,
+                       parse->store->root_count);
+            }
+        }
+    }
+    
+    // Blocks that weren't routed (or didn't decode) are recorded as empty,
+    // so the next run skips them as well; a content key fails the same way
+    // every time
+    if (parse->cached && status == 0 && parse->miss_count) {
+        for (size_t i = 0; i < parse->count; i++) {
+            const CompressedBlock *block = &parse->blocks[i];
+            if (!parse->cached[i] && parse->ranges[i].count == 0) {
+                parse->ranges[i] = (CompCacheBlock){
+                    block->crc32, block->uncompressed_size, block->compressed_size, 0, 0,
+                };
+            }
+        }
+        if (comp_cache_write(parse->acd_path, parse->ranges, parse->count, parse->store) == 0 && !acd_quiet) {
+            printf("💾 Cached components: %s%s\n", parse->acd_path, ACD_COMPCACHE_SUFFIX);
+        }
+    }
+    
+    if (parse->have_cache) comp_cache_close(&parse->cache);
+    free(parse->cached);
+    free(parse->ranges);
+    parse->cached = NULL;
+    parse->ranges = NULL;
+    parse->have_cache = 0;
+    return status == 0 ? parse->parsed : -1;
+}
+
+// Parse every Comps block of a whole ACD, inflating members in memory
+int parse_acd_components(ComponentStore *store, const ACD_File *acd,
+                         const CompressedBlock *blocks, size_t count) {
+    return parse_acd_components_cached(store, acd, blocks, count, NULL, NULL);
+}
+
+int parse_acd_components_cached(ComponentStore *store, const ACD_File *acd,
+                                const CompressedBlock *blocks, size_t count,
+                                const char *acd_path, BlockCache *block_cache) {
+    CompsParse parse;
+    if (comps_parse_begin(&parse, store, blocks, count, acd_path) != 0) {
+        return -1;
+    }
+    BlockRoute routes[] = {
+        { "comps", "Comps", 0, comps_block_handler, &parse },
+    };
+    
+    // Only the blocks the cache doesn't hold go through the pipeline
+    const CompressedBlock *pending = blocks;
+    size_t pending_count = count;
+    CompressedBlock *misses = NULL;
+    if (parse.cached) {
+        misses = malloc((count ? count : 1) * sizeof(*misses));
+        if (!misses) {
+            return comps_parse_finish(&parse, -1);
+        }
+        pending_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!parse.cached[i]) misses[pending_count++] = blocks[i];
+        }
+        pending = misses;
+    }
+    
+    PipelineStats stats;
+    int status = acd_pipeline_run_cached(acd, pending, pending_count, routes,
+                                         sizeof(routes) / sizeof(routes[0]), block_cache, &stats);
+    if (status == 0 && !acd_quiet) {
+        printf("\n📊 Routed %zu of %zu blocks (%zu skipped after the head, %zu failed, %zu from the block cache)\n",
+               stats.routed, stats.blocks, stats.skipped, stats.failed, stats.cache_hits);
+    }
+    free(misses);
+    return comps_parse_finish(&parse, status);
+}
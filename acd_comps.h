@@ -0,0 +1,107 @@
+#ifndef ACD_COMPS_H
+#define ACD_COMPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_pipeline.h"
+#include "acd_store.h"
+#include "acd_compcache.h"
+
+#define DATABASE_MAX_FIELDS 20
+
+// Database header structure: the framing every database section shares
+// (Comps, TagInfo): its name, field names, and where the .dat records and
+// the .idx offsets lie, as offsets from the start of the block. Field
+// names point into the block and are not NUL-terminated.
+typedef struct {
+    char name[64];
+    uint32_t record_count;       // As claimed by .idx; may exceed the room left
+    uint32_t record_size;        // Bytes in the record area
+    uint32_t data_offset;        // First record byte
+    uint32_t index_offset;       // First .idx entry
+    int field_count;
+    const char *fields[DATABASE_MAX_FIELDS];
+    size_t field_lens[DATABASE_MAX_FIELDS];
+} DatabaseHeader;
+
+// Find a null-terminated string at data + offset, looking at most max_len
+// bytes ahead. Returns a pointer into data (not terminated) and its length.
+const char *read_string(const unsigned char *data, size_t offset, size_t max_len, size_t *len);
+
+// Read 32-bit little-endian integer
+uint32_t read_uint32_le(const unsigned char *data, size_t offset);
+
+// Read the framing of the database whose NUL-terminated name starts at
+// data + name_offset. Field names are filled in either way; returns 0, or
+// -1 when no .dat/.idx pair follows them.
+int read_database_header(const unsigned char *data, size_t size, size_t name_offset,
+                         DatabaseHeader *header);
+
+// Parse the Comps database starting at start_offset, appending to store.
+// Returns the number of components decoded, or -1 on allocation failure.
+int parse_comps_database(ComponentStore *store, const unsigned char *data, size_t data_size,
+                         size_t start_offset);
+
+// Find and parse the Comps database inside one decompressed block
+int parse_block(ComponentStore *store, const unsigned char *data, size_t size);
+
+// Parse every Comps block of a whole ACD in memory (blocks may be NULL to
+// scan for them); returns the number of blocks parsed or -1
+int parse_acd_components(ComponentStore *store, const ACD_File *acd,
+                         const CompressedBlock *blocks, size_t count);
+
+// The Comps route of a pass that may route other databases as well,
+// backed by the component cache of the ACD at acd_path (NULL = no cache).
+// comps_parse_begin looks every block up; comps_parse_cached says which
+// ones the pass needn't inflate on the Comps route's account. Route Comps
+// blocks to comps_block_handler with the CompsParse as ctx: cached ones
+// that come past anyway are applied from the cache, not parsed.
+// comps_parse_finish appends the cached blocks the pass didn't see, so
+// the store comes out the same as a full parse, rewrites the cache and
+// frees the rest.
+typedef struct {
+    ComponentStore *store;
+    int parsed;
+    
+    // Incremental runs: every block in file order, the cache entry for
+    // each (NULL = parse it), and the store range each one filled
+    const char *acd_path;
+    CompCache cache;
+    int have_cache;
+    const CompressedBlock *blocks;
+    size_t count;
+    const CompCacheEntry **cached;
+    CompCacheBlock *ranges;
+    size_t miss_count;
+    size_t next;                 // First block not yet accounted for
+    size_t reused_components;
+} CompsParse;
+
+// Returns 0, or -1 on allocation failure (parse is then finished)
+int comps_parse_begin(CompsParse *parse, ComponentStore *store, const CompressedBlock *blocks,
+                      size_t count, const char *acd_path);
+
+// Cache entry for blocks[i], or NULL if the block has to be parsed
+const CompCacheEntry *comps_parse_cached(const CompsParse *parse, size_t i);
+
+int comps_block_handler(const CompressedBlock *block, const unsigned char *data,
+                        size_t size, void *ctx);
+
+// status is the pass's own (0 or -1). Returns the number of Comps blocks
+// parsed or taken from the cache, or -1.
+int comps_parse_finish(CompsParse *parse, int status);
+
+// parse_acd_components backed by the component cache of the ACD at
+// acd_path: blocks whose CRC32/ISIZE/compressed size are cached are not
+// inflated, the rest are parsed and the cache rewritten. The store comes
+// out the same as a full parse. acd_path NULL or blocks NULL = no cache.
+// block_cache (may be NULL) is the shared decompressed block cache the
+// pipeline reads blocks it has to parse from.
+int parse_acd_components_cached(ComponentStore *store, const ACD_File *acd,
+                                const CompressedBlock *blocks, size_t count,
+                                const char *acd_path, BlockCache *block_cache);
+
+#endif
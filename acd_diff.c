@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_diff.h"
+#include "acd_comps.h"
+
+// Kinds paired separately when matching leftover blocks
+#define DIFF_KINDS 3
+
+// An old block's index entry, sortable on its own
+typedef struct {
+    uint32_t crc32;
+    uint32_t uncompressed_size;
+    uint32_t compressed_size;
+    uint32_t index;
+} BlockKey;
+
+static BlockKey block_key(const CompressedBlock *block, size_t index) {
+    BlockKey key = { block->crc32, block->uncompressed_size, block->compressed_size, (uint32_t)index };
+    return key;
+}
+
+// Entries only; index breaks ties when sorting
+static int compare_keys(const BlockKey *a, const BlockKey *b) {
+    if (a->crc32 != b->crc32) return a->crc32 < b->crc32 ? -1 : 1;
+    if (a->uncompressed_size != b->uncompressed_size) return a->uncompressed_size < b->uncompressed_size ? -1 : 1;
+    if (a->compressed_size != b->compressed_size) return a->compressed_size < b->compressed_size ? -1 : 1;
+    return 0;
+}
+
+static int compare_sorted_keys(const void *a, const void *b) {
+    const BlockKey *x = a, *y = b;
+    int c = compare_keys(x, y);
+    return c ? c : (x->index < y->index ? -1 : 1);
+}
+
+// First position in keys that is not below key
+static size_t lower_bound(const BlockKey *keys, size_t count, const BlockKey *key) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare_keys(&keys[mid], key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int compare_block_offsets(const void *a, const void *b) {
+    const CompressedBlock *x = a, *y = b;
+    return x->offset < y->offset ? -1 : x->offset > y->offset;
+}
+
+static size_t kind_slot(uint32_t kind) {
+    return kind < DIFF_KINDS ? kind : BLOCK_KIND_BINARY;
+}
+
+int acd_diff_blocks(AcdDiff *diff, const CompressedBlock *old_blocks, size_t old_count,
+                    const CompressedBlock *new_blocks, size_t new_count) {
+    size_t total = old_count + new_count;
+    diff->block_count = 0;
+    diff->blocks_same = diff->blocks_modified = diff->blocks_added = diff->blocks_removed = 0;
+    BlockKey *keys = malloc((old_count ? old_count : 1) * sizeof(*keys));
+    uint32_t *cursor = malloc((old_count ? old_count : 1) * sizeof(*cursor));
+    long *pair = malloc((new_count ? new_count : 1) * sizeof(*pair));
+    unsigned char *taken = calloc(old_count ? old_count : 1, 1);
+    diff->blocks = malloc((total ? total : 1) * sizeof(*diff->blocks));
+    if (!keys || !cursor || !pair || !taken || !diff->blocks) {
+        free(keys);
+        free(cursor);
+        free(pair);
+        free(taken);
+        return -1;
+    }
+
+    // Identical entries: the earliest old block not yet taken. Every
+    // lookup lands on the start of its run of equal entries, so a cursor
+    // kept there walks the run once.
+    for (size_t i = 0; i < old_count; i++) {
+        keys[i] = block_key(&old_blocks[i], i);
+        cursor[i] = (uint32_t)i;
+    }
+    qsort(keys, old_count, sizeof(*keys), compare_sorted_keys);
+    for (size_t j = 0; j < new_count; j++) {
+        BlockKey key = block_key(&new_blocks[j], j);
+        size_t at = lower_bound(keys, old_count, &key);
+        pair[j] = -1;
+        if (at < old_count && cursor[at] < old_count && compare_keys(&keys[cursor[at]], &key) == 0) {
+            pair[j] = keys[cursor[at]++].index;
+            taken[pair[j]] = 1;
+        }
+    }
+
+    // Leftovers: the next unpaired old block of the same kind is the
+    // earlier version of an unpaired new one
+    size_t next_old[DIFF_KINDS] = {0};
+    size_t n = 0;
+    for (size_t j = 0; j < new_count; j++) {
+        BlockDiff *d = &diff->blocks[n++];
+        d->new_index = (long)j;
+        d->old_index = pair[j];
+        if (pair[j] >= 0) {
+            d->status = DIFF_SAME;
+            diff->blocks_same++;
+            continue;
+        }
+        size_t k = kind_slot(new_blocks[j].kind);
+        size_t *i = &next_old[k];
+        while (*i < old_count && (taken[*i] || kind_slot(old_blocks[*i].kind) != k)) (*i)++;
+        if (*i < old_count) {
+            d->status = DIFF_MODIFIED;
+            d->old_index = (long)*i;
+            taken[(*i)++] = 1;
+            diff->blocks_modified++;
+        } else {
+            d->status = DIFF_ADDED;
+            diff->blocks_added++;
+        }
+    }
+    for (size_t i = 0; i < old_count; i++) {
+        if (taken[i]) continue;
+        BlockDiff *d = &diff->blocks[n++];
+        d->status = DIFF_REMOVED;
+        d->old_index = (long)i;
+        d->new_index = -1;
+        diff->blocks_removed++;
+    }
+    diff->block_count = n;
+
+    free(keys);
+    free(cursor);
+    free(pair);
+    free(taken);
+    return 0;
+}
+
+static int same_string(const ComponentStore *a, StrRef ra, const ComponentStore *b, StrRef rb) {
+    return ra.len == rb.len && memcmp(component_str(a, ra), component_str(b, rb), ra.len) == 0;
+}
+
+static unsigned component_changes(const ComponentStore *old_store, const Component *a,
+                                  const ComponentStore *new_store, const Component *b) {
+    unsigned changed = 0;
+    if (!same_string(old_store, a->name, new_store, b->name)) changed |= COMP_DIFF_NAME;
+    if (a->parent_uid != b->parent_uid) changed |= COMP_DIFF_PARENT;
+    if (a->ordinal != b->ordinal) changed |= COMP_DIFF_ORDINAL;
+    if (!same_string(old_store, a->type, new_store, b->type)) changed |= COMP_DIFF_TYPE;
+    if (!same_string(old_store, a->ioi, new_store, b->ioi)) changed |= COMP_DIFF_IOI;
+    return changed;
+}
+
+static int compare_component_diffs(const void *a, const void *b) {
+    const ComponentDiff *x = a, *y = b;
+    if (x->uid != y->uid) return x->uid < y->uid ? -1 : 1;
+    return (int)x->status - (int)y->status;
+}
+
+// The blocks of one side that diff marked with either status
+static CompressedBlock *changed_blocks(const AcdDiff *diff, const CompressedBlock *blocks, size_t count,
+                                       int old_side, size_t *out_count) {
+    CompressedBlock *out = malloc((count ? count : 1) * sizeof(*out));
+    *out_count = 0;
+    if (!out) {
+        return NULL;
+    }
+    for (size_t i = 0; i < diff->block_count; i++) {
+        const BlockDiff *d = &diff->blocks[i];
+        long index = old_side ? d->old_index : d->new_index;
+        if (d->status != DIFF_SAME && index >= 0) {
+            out[(*out_count)++] = blocks[index];
+        }
+    }
+    return out;
+}
+
+// Decode one side's changed blocks into store (index built)
+static int parse_changed(ComponentStore *store, const ACD_File *acd, const CompressedBlock *blocks,
+                         size_t count) {
+    if (count && parse_acd_components(store, acd, blocks, count) < 0) {
+        return -1;
+    }
+    return component_store_build_index(store);
+}
+
+int acd_diff_run(AcdDiff *diff, const ACD_File *old_acd, const CompressedBlock *old_blocks,
+                 size_t old_count, const ACD_File *new_acd, const CompressedBlock *new_blocks,
+                 size_t new_count) {
+    memset(diff, 0, sizeof(*diff));
+    if (component_store_init(&diff->old_store) != 0 || component_store_init(&diff->new_store) != 0 ||
+        acd_diff_blocks(diff, old_blocks, old_count, new_blocks, new_count) != 0) {
+        return -1;
+    }
+
+    // Blocks whose Comps records can differ; the rest are never inflated.
+    // Block lists stay in file order, as the pipeline wants them.
+    size_t old_changed, new_changed;
+    CompressedBlock *old_list = changed_blocks(diff, old_blocks, old_count, 1, &old_changed);
+    CompressedBlock *new_list = changed_blocks(diff, new_blocks, new_count, 0, &new_changed);
+    int ret = -1;
+    if (old_list && new_list) {
+        qsort(old_list, old_changed, sizeof(*old_list), compare_block_offsets);
+        qsort(new_list, new_changed, sizeof(*new_list), compare_block_offsets);
+        ret = parse_changed(&diff->old_store, old_acd, old_list, old_changed) == 0 &&
+              parse_changed(&diff->new_store, new_acd, new_list, new_changed) == 0 ? 0 : -1;
+    }
+    free(old_list);
+    free(new_list);
+    if (ret != 0) {
+        return -1;
+    }
+
+    const ComponentStore *a = &diff->old_store, *b = &diff->new_store;
+    diff->components = malloc((a->count + b->count ? a->count + b->count : 1) * sizeof(*diff->components));
+    if (!diff->components) {
+        return -1;
+    }
+    for (size_t i = 0; i < b->count; i++) {
+        const Component *comp = &b->items[i];
+        if (component_store_find(b, comp->uid) != (long)i) continue;  // Repeated UID
+        long old_index = component_store_find(a, comp->uid);
+        unsigned changed = old_index >= 0 ? component_changes(a, &a->items[old_index], b, comp) : 0;
+        if (old_index >= 0 && !changed) continue;
+        ComponentDiff *d = &diff->components[diff->component_count++];
+        d->status = old_index >= 0 ? DIFF_MODIFIED : DIFF_ADDED;
+        d->uid = comp->uid;
+        d->old_index = old_index;
+        d->new_index = (long)i;
+        d->changed = changed;
+        if (old_index >= 0) {
+            diff->comps_modified++;
+        } else {
+            diff->comps_added++;
+        }
+    }
+    for (size_t i = 0; i < a->count; i++) {
+        const Component *comp = &a->items[i];
+        if (component_store_find(a, comp->uid) != (long)i || component_store_find(b, comp->uid) >= 0) continue;
+        ComponentDiff *d = &diff->components[diff->component_count++];
+        d->status = DIFF_REMOVED;
+        d->uid = comp->uid;
+        d->old_index = (long)i;
+        d->new_index = -1;
+        d->changed = 0;
+        diff->comps_removed++;
+    }
+    qsort(diff->components, diff->component_count, sizeof(*diff->components), compare_component_diffs);
+    return 0;
+}
+
+void acd_diff_free(AcdDiff *diff) {
+    free(diff->blocks);
+    free(diff->components);
+    component_store_free(&diff->old_store);
+    component_store_free(&diff->new_store);
+    memset(diff, 0, sizeof(*diff));
+}
@@ -0,0 +1,76 @@
+#ifndef ACD_DIFF_H
+#define ACD_DIFF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_store.h"
+
+// Structural diff of two revisions of a project
+//
+// Blocks are paired by their index entries (CRC32, ISIZE and compressed
+// size, in file order among equals), which needs no inflating. Blocks left
+// over on both sides are paired by kind in file order as modified, the
+// rest are added or removed. Only the Comps databases of unpaired blocks
+// are parsed, on each side into its own store, and their components are
+// matched by UID through the stores' hash indexes: added, removed, or
+// modified with a mask of the fields that differ. Components of unchanged
+// blocks are identical by construction and never decoded.
+
+typedef enum {
+    DIFF_SAME = 0,
+    DIFF_MODIFIED,
+    DIFF_ADDED,
+    DIFF_REMOVED
+} DiffStatus;
+
+// Fields of a modified component that differ
+#define COMP_DIFF_NAME 0x01
+#define COMP_DIFF_PARENT 0x02
+#define COMP_DIFF_ORDINAL 0x04
+#define COMP_DIFF_TYPE 0x08
+#define COMP_DIFF_IOI 0x10
+
+typedef struct {
+    DiffStatus status;
+    long old_index;              // Into the old block list, -1 if added
+    long new_index;              // Into the new block list, -1 if removed
+} BlockDiff;
+
+typedef struct {
+    DiffStatus status;
+    uint32_t uid;
+    long old_index;              // Into old_store, -1 if added
+    long new_index;              // Into new_store, -1 if removed
+    unsigned changed;            // COMP_DIFF_* for a modified component
+} ComponentDiff;
+
+typedef struct {
+    BlockDiff *blocks;           // New side in file order, then removed blocks
+    size_t block_count;
+    size_t blocks_same, blocks_modified, blocks_added, blocks_removed;
+
+    ComponentStore old_store;    // Components of the old side's changed blocks
+    ComponentStore new_store;
+    ComponentDiff *components;   // By UID
+    size_t component_count;
+    size_t comps_added, comps_removed, comps_modified;
+} AcdDiff;
+
+// Pair the blocks of two revisions by index entry (fills diff->blocks and
+// the block counts; no inflating). Returns 0, or -1 on allocation failure.
+int acd_diff_blocks(AcdDiff *diff, const CompressedBlock *old_blocks, size_t old_count,
+                    const CompressedBlock *new_blocks, size_t new_count);
+
+// acd_diff_blocks, then parse the changed blocks' Comps databases on both
+// sides and diff their components by UID. Returns 0, or -1 on allocation
+// failure. Free with acd_diff_free either way.
+int acd_diff_run(AcdDiff *diff, const ACD_File *old_acd, const CompressedBlock *old_blocks,
+                 size_t old_count, const ACD_File *new_acd, const CompressedBlock *new_blocks,
+                 size_t new_count);
+
+void acd_diff_free(AcdDiff *diff);
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "acd_export.h"
+#include "acd_comps.h"
+#include "acd_stats.h"
+
+typedef struct {
+    CompsParse comps;
+    RungTable *rungs;
+    TagTable *tags;
+    const ExportOptions *options;
+    ExportStats *stats;
+    const CompressedBlock *blocks;
+    size_t count;
+    size_t next;                 // Blocks arrive in file order; position of the last one
+    int failed;
+} ExportParse;
+
+// Write one inflated block under its extracted_blocks/ name
+static void dump_block(ExportParse *parse, const CompressedBlock *block, const unsigned char *data,
+                       size_t size) {
+    if (!parse->options->dump_dir) {
+        return;
+    }
+    while (parse->next < parse->count && parse->blocks[parse->next].offset < block->offset) {
+        parse->next++;
+    }
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/block_%03zu_offset_0x%lx.bin", parse->options->dump_dir,
+             parse->next + 1, block->offset);
+    FILE *out = fopen(path, "wb");
+    int ok = out && fwrite(data, 1, size, out) == size;
+    if (out && fclose(out) != 0) ok = 0;
+    if (ok) {
+        parse->stats->dumped++;
+    } else {
+        parse->stats->dump_failed++;
+    }
+}
+
+static int export_comps_handler(const CompressedBlock *block, const unsigned char *data,
+                                size_t size, void *ctx) {
+    ExportParse *parse = ctx;
+    dump_block(parse, block, data, size);
+    parse->stats->comps_blocks++;
+    return comps_block_handler(block, data, size, &parse->comps);
+}
+
+static int export_rungs_handler(const CompressedBlock *block, const unsigned char *data,
+                                size_t size, void *ctx) {
+    ExportParse *parse = ctx;
+    dump_block(parse, block, data, size);
+    long decoded = parse_rung_block(parse->rungs, data, size, parse->options->jobs);
+    if (decoded < 0) {
+        parse->failed = 1;
+        return -1;
+    }
+    if (decoded > 0 && !acd_quiet) {
+        printf("🪜 RungCode block at offset 0x%lx: %ld rungs\n", block->offset, decoded);
+    }
+    parse->stats->rung_blocks++;
+    return 0;
+}
+
+static int export_tags_handler(const CompressedBlock *block, const unsigned char *data,
+                               size_t size, void *ctx) {
+    ExportParse *parse = ctx;
+    dump_block(parse, block, data, size);
+    size_t defs = parse->tags->def_count;
+    int decoded = parse_tag_block(parse->tags, data, size);
+    if (decoded < 0) {
+        parse->failed = 1;
+        return -1;
+    }
+    if ((decoded > 0 || parse->tags->def_count > defs) && !acd_quiet) {
+        printf("🏷️  TagInfo.XML block at offset 0x%lx: %d tags, %zu data types\n", block->offset, decoded,
+               parse->tags->def_count - defs);
+    }
+    parse->stats->tag_blocks++;
+    return 0;
+}
+
+static int export_dump_handler(const CompressedBlock *block, const unsigned char *data,
+                               size_t size, void *ctx) {
+    dump_block(ctx, block, data, size);
+    return 0;
+}
+
+int acd_export_collect(ComponentStore *store, RungTable *rungs, TagTable *tags, const ACD_File *acd,
+                       const CompressedBlock *blocks, size_t count,
+                       const ExportOptions *options, ExportStats *stats) {
+    ExportStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (options->dump_dir && mkdir(options->dump_dir, 0755) != 0 && errno != EEXIST) {
+        return -1;
+    }
+
+    ExportParse parse = { .rungs = rungs, .tags = tags, .options = options, .stats = stats,
+                          .blocks = blocks, .count = count };
+    if (comps_parse_begin(&parse.comps, store, blocks, count, options->comp_cache) != 0) {
+        return -1;
+    }
+    // First match wins, so the catch-all that dumps everything else goes last
+    BlockRoute routes[4];
+    size_t route_count = 0;
+    routes[route_count++] = (BlockRoute){ "comps", "Comps", 0, export_comps_handler, &parse };
+    if (options->rungcode) {
+        routes[route_count++] = (BlockRoute){ "rungs", "RungCode", 0, export_rungs_handler, &parse };
+    }
+    if (tags) {
+        routes[route_count++] = (BlockRoute){ "tags", TAGINFO_SIGNATURE, TAGINFO_WINDOW,
+                                              export_tags_handler, &parse };
+    }
+    if (options->dump_dir) {
+        routes[route_count++] = (BlockRoute){ "dump", "", 0, export_dump_handler, &parse };
+    }
+
+    // Blocks whose components are cached stay out of the pass unless
+    // another route may want them: a cached Comps block only for the dump,
+    // a cached empty one for any of the others
+    const CompressedBlock *pending = blocks;
+    size_t pending_count = count;
+    CompressedBlock *subset = NULL;
+    if (parse.comps.cached && !options->dump_dir) {
+        subset = malloc((count ? count : 1) * sizeof(*subset));
+        if (!subset) {
+            comps_parse_finish(&parse.comps, -1);
+            return -1;
+        }
+        pending_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            const CompCacheEntry *entry = comps_parse_cached(&parse.comps, i);
+            if (!entry || (route_count > 1 && entry->component_count == 0)) {
+                subset[pending_count++] = blocks[i];
+            }
+        }
+        pending = subset;
+    }
+
+    int status = acd_pipeline_run_cached(acd, pending, pending_count, routes, route_count,
+                                         options->block_cache, &stats->pipeline);
+    free(subset);
+    if (status != 0 || parse.failed) {
+        status = -1;
+    }
+    if (comps_parse_finish(&parse.comps, status) < 0) {
+        return -1;
+    }
+    return component_store_build_index(store) == 0 ? 0 : -1;
+}
@@ -0,0 +1,49 @@
+#ifndef ACD_EXPORT_H
+#define ACD_EXPORT_H
+
+#include <stddef.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_blockcache.h"
+#include "acd_pipeline.h"
+#include "acd_store.h"
+#include "acd_rll.h"
+#include "acd_tags.h"
+
+// Single-pass ACD export: one pipeline run over the mapped file hands
+// Comps blocks to the component parser and, when asked, RungCode blocks
+// (a hypothetical format, see acd_rll.h) to the rung decoder and
+// TagInfo.XML to the tag decoder. With a component cache, blocks it holds
+// are only inflated when another route needs them. With a dump directory
+// every member is inflated in full and
+// written there as block_NNN_offset_0xOFF.bin on the way past, numbered
+// like extracted_blocks/, so no block is inflated twice or read back.
+
+typedef struct {
+    int jobs;                    // Rung decode threads (<= 1: serial)
+    const char *dump_dir;        // NULL: write no block files
+    BlockCache *block_cache;     // May be NULL
+    int rungcode;                // Decode RungCode blocks (hypothetical format)
+    const char *comp_cache;      // ACD path whose .acdcomps cache to use; NULL = none
+} ExportOptions;
+
+typedef struct {
+    PipelineStats pipeline;
+    size_t comps_blocks;
+    size_t rung_blocks;
+    size_t tag_blocks;
+    size_t dumped;               // Block files written
+    size_t dump_failed;          // Block files that couldn't be written
+} ExportStats;
+
+// Fill store, rungs and tags (initialised by the caller; tags NULL = don't
+// decode them) from the count blocks of acd in one pass and build the
+// store's index. stats may be NULL. Returns 0, or -1 on allocation
+// failure, an unusable dump directory or (with rungcode) a RungCode
+// database that couldn't be decoded.
+int acd_export_collect(ComponentStore *store, RungTable *rungs, TagTable *tags, const ACD_File *acd,
+                       const CompressedBlock *blocks, size_t count,
+                       const ExportOptions *options, ExportStats *stats);
+
+#endif
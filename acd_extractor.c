@@ -4,17 +4,55 @@
 #include <stdint.h>
 #include <zlib.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
-#define CHUNK_SIZE 16384
-#define MAX_DECOMP_SIZE (10 * 1024 * 1024) // 10MB max per block
+#include "acd_extractor.h"
+#include "acd_pool.h"
+#include "acd_stats.h"
 
-// Extract and decompress a GZIP block
-int extract_gzip_block(FILE *file, long offset, int block_num) {
-    fseek(file, offset, SEEK_SET);
+// Write a decompressed block to extracted_blocks/ (no printing; see report_block)
+void save_block(const CompressedBlock *block, int block_num, ExtractResult *result) {
+    const unsigned char *decompressed = block->data;
+    size_t decomp_size = block->uncompressed_size;
+    long offset = block->offset;
     
-    // Read GZIP header
-    unsigned char header[10];
-    if (fread(header, 1, 10, file) != 10) {
+    // Save decompressed data
+    char filename[256];
+    sprintf(filename, "extracted_blocks/block_%03d_offset_0x%lx.bin", block_num, offset);
+    
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        return;
+    }
+    fwrite(decompressed, 1, decomp_size, out);
+    fclose(out);
+    result->saved = 1;
+    
+    result->preview_len = decomp_size < sizeof(result->preview) ? decomp_size : sizeof(result->preview);
+    memcpy(result->preview, decompressed, result->preview_len);
+    
+    // Check for XML
+    if (decomp_size > 5 && memcmp(decompressed, "<?xml", 5) == 0) {
+        // Save as XML
+        sprintf(filename, "extracted_blocks/block_%03d_offset_0x%lx.xml", block_num, offset);
+        out = fopen(filename, "w");
+        if (out) {
+            fwrite(decompressed, 1, decomp_size, out);
+            fclose(out);
+            result->saved_xml = 1;
+        }
+    }
+}
+
+// Extract and decompress a GZIP block (no printing; see report_block)
+int extract_gzip_block(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block,
+                       int block_num, ExtractResult *result, BlockCache *cache) {
+    memset(result, 0, sizeof(*result));
+    result->ret = Z_DATA_ERROR;
+    
+    // Verify GZIP header
+    const unsigned char *header = acd_file_ptr(acd, block->offset, 10);
+    if (!header) {
         return -1;
     }
     
@@ -23,206 +61,350 @@ int extract_gzip_block(FILE *file, long offset, int block_num) {
         return -1;
     }
     
-    // Create output directory
-    mkdir("extracted_blocks", 0755);
+    // Another file may already have produced this member
+    BlockCacheKey key;
+    int keyed = cache && acd_block_cache_key(acd, block, &key) == 0;
+    ACD_File cached;
+    if (keyed && acd_block_cache_get(cache, &key, &cached) == 0) {
+        block->data = (unsigned char *)cached.data;
+        result->ret = Z_STREAM_END;
+        result->cached = 1;
+        save_block(block, block_num, result);
+        block->data = NULL;
+        acd_file_close(&cached);
+        return 0;
+    }
     
-    // Read compressed data (we'll read up to 1MB for each block)
-    unsigned char *compressed = malloc(1024 * 1024);
-    fseek(file, offset, SEEK_SET);
-    size_t comp_size = fread(compressed, 1, 1024 * 1024, file);
-    
-    // Setup decompression
-    z_stream strm = {0};
-    strm.next_in = compressed;
-    strm.avail_in = comp_size;
-    
-    unsigned char *decompressed = malloc(MAX_DECOMP_SIZE);
-    strm.next_out = decompressed;
-    strm.avail_out = MAX_DECOMP_SIZE;
-    
-    // Initialize with automatic header detection
-    int ret = inflateInit2(&strm, 16 + MAX_WBITS);
-    if (ret != Z_OK) {
-        free(compressed);
-        free(decompressed);
+    // Decompress the whole member straight from the mapping; the output
+    // buffer is sized to the member, and the real sizes land in block
+    result->ret = acd_block_inflate_ctx(ctx, acd, block);
+    if (result->ret != Z_STREAM_END) {
         return -1;
     }
     
-    // Decompress
-    ret = inflate(&strm, Z_FINISH);
-    size_t decomp_size = strm.total_out;
-    inflateEnd(&strm);
+    if (keyed) {
+        acd_block_cache_put(cache, &key, block->data, block->uncompressed_size);
+    }
+    save_block(block, block_num, result);
+    acd_block_free(block);
+    return 0;
+}
+
+// Print what extract_gzip_block did for one block
+void report_block(const CompressedBlock *block, int block_num, const ExtractResult *result) {
+    long offset = block->offset;
     
-    if (ret == Z_STREAM_END || ret == Z_OK) {
-        // Save decompressed data
-        char filename[256];
-        sprintf(filename, "extracted_blocks/block_%03d_offset_0x%lx.bin", block_num, offset);
-        
-        FILE *out = fopen(filename, "wb");
-        if (out) {
-            fwrite(decompressed, 1, decomp_size, out);
-            fclose(out);
-            
-            printf("✅ Block %d: Decompressed %zu bytes → %zu bytes\n", 
-                   block_num, strm.total_in, decomp_size);
-            printf("   Saved to: %s\n", filename);
-            
-            // Analyze content
-            printf("   Content preview: ");
-            int printable = 1;
-            for (int i = 0; i < 50 && i < decomp_size; i++) {
-                if (decompressed[i] < 0x20 || decompressed[i] > 0x7E) {
-                    if (decompressed[i] != '\n' && decompressed[i] != '\r' && decompressed[i] != '\t') {
-                        printable = 0;
-                        break;
-                    }
-                }
-            }
-            
-            if (printable && decomp_size > 0) {
-                printf("\"");
-                for (int i = 0; i < 50 && i < decomp_size; i++) {
-                    if (decompressed[i] >= 0x20 && decompressed[i] <= 0x7E) {
-                        printf("%c", decompressed[i]);
-                    }
-                }
-                printf("...\"\n");
-            } else {
-                printf("[Binary data]\n");
+    // Quiet runs only hear about failures
+    if (acd_quiet && (result->reused || result->ret == Z_STREAM_END)) {
+        return;
+    }
+    if (result->reused) {
+        printf("♻️  Block %d: Unchanged (CRC32 %08x, %u bytes), kept extracted_blocks/block_%03d_offset_0x%lx.bin\n",
+               block_num, block->crc32, block->uncompressed_size, block_num, offset);
+        return;
+    }
+    if (result->ret != Z_STREAM_END) {
+        printf("❌ Block %d: Decompression failed (code %d)\n", block_num, result->ret);
+        return;
+    }
+    if (!result->saved) {
+        return;
+    }
+    
+    if (result->cached) {
+        printf("✅ Block %d: Cached %u bytes → %u bytes\n",
+               block_num, block->compressed_size, block->uncompressed_size);
+    } else {
+        printf("✅ Block %d: Decompressed %u bytes → %u bytes\n", 
+               block_num, block->compressed_size, block->uncompressed_size);
+    }
+    printf("   Saved to: extracted_blocks/block_%03d_offset_0x%lx.bin\n", block_num, offset);
+    
+    // Analyze content
+    const unsigned char *preview = result->preview;
+    printf("   Content preview: ");
+    int printable = 1;
+    for (size_t i = 0; i < result->preview_len; i++) {
+        if (preview[i] < 0x20 || preview[i] > 0x7E) {
+            if (preview[i] != '\n' && preview[i] != '\r' && preview[i] != '\t') {
+                printable = 0;
+                break;
             }
-            
-            // Check for XML
-            if (decomp_size > 5 && memcmp(decompressed, "<?xml", 5) == 0) {
-                printf("   🔍 XML content detected!\n");
-                
-                // Save as XML
-                sprintf(filename, "extracted_blocks/block_%03d_offset_0x%lx.xml", block_num, offset);
-                out = fopen(filename, "w");
-                if (out) {
-                    fwrite(decompressed, 1, decomp_size, out);
-                    fclose(out);
-                    printf("   💾 Also saved as: %s\n", filename);
-                }
+        }
+    }
+    
+    if (printable && result->preview_len > 0) {
+        printf("\"");
+        for (size_t i = 0; i < result->preview_len; i++) {
+            if (preview[i] >= 0x20 && preview[i] <= 0x7E) {
+                printf("%c", preview[i]);
             }
         }
+        printf("...\"\n");
     } else {
-        printf("❌ Block %d: Decompression failed (code %d)\n", block_num, ret);
+        printf("[Binary data]\n");
     }
     
-    free(compressed);
-    free(decompressed);
-    return decomp_size > 0 ? 0 : -1;
+    if (result->preview_len > 5 && memcmp(preview, "<?xml", 5) == 0) {
+        printf("   🔍 XML content detected!\n");
+        if (result->saved_xml) {
+            printf("   💾 Also saved as: extracted_blocks/block_%03d_offset_0x%lx.xml\n", block_num, offset);
+        }
+    }
 }
 
-// Search for database files
-void find_database_files(FILE *file, long start_offset) {
-    printf("\n🔍 Searching for database file structures...\n");
-    
-    fseek(file, start_offset, SEEK_SET);
-    unsigned char buffer[8192];
-    long offset = start_offset;
+static void block_path(char *out, size_t size, int block_num, long offset, const char *ext) {
+    snprintf(out, size, "extracted_blocks/block_%03d_offset_0x%lx.%s", block_num, offset, ext);
+}
+
+// A previous block and the number its files were saved under
+typedef struct {
+    CompressedBlock block;
+    int number;
+} PreviousBlock;
+
+static int compare_content(const void *pa, const void *pb) {
+    const CompressedBlock *a = pa, *b = pb;
+    if (a->crc32 != b->crc32) return a->crc32 < b->crc32 ? -1 : 1;
+    if (a->uncompressed_size != b->uncompressed_size) return a->uncompressed_size < b->uncompressed_size ? -1 : 1;
+    if (a->compressed_size != b->compressed_size) return a->compressed_size < b->compressed_size ? -1 : 1;
+    return 0;
+}
+
+// Keep the files of blocks that didn't change since previous was extracted.
+// Moved blocks are renamed out of the way first and into place second, so
+// a block taking over another's old name can't clobber a file still needed.
+// Sets reused[i] for every block whose .bin is in place; returns the count.
+static size_t reuse_unchanged(CompressedBlock *blocks, size_t block_count,
+                              const CompressedBlock *previous, size_t previous_count,
+                              unsigned char *reused) {
+    // Previous blocks sorted by content (block comes first, so the
+    // content comparison works on both element types)
+    PreviousBlock *sorted = malloc(previous_count * sizeof(*sorted));
+    unsigned char *pending = calloc(block_count, 1);
+    if (!sorted || !pending) {
+        free(sorted);
+        free(pending);
+        return 0;
+    }
+    for (size_t j = 0; j < previous_count; j++) {
+        sorted[j].block = previous[j];
+        sorted[j].number = (int)j + 1;
+    }
+    qsort(sorted, previous_count, sizeof(*sorted), compare_content);
     
-    while (fread(buffer, 1, sizeof(buffer), file) > 0) {
-        for (int i = 0; i < sizeof(buffer) - 100; i++) {
-            // Look for "Controller" with length prefix (common in binary formats)
-            if (buffer[i] == 0x0A && buffer[i+1] == 0x00 && 
-                memcmp(buffer + i + 2, "Controller", 10) == 0) {
-                printf("   Found 'Controller' structure at: 0x%lx\n", offset + i);
-            }
-            
-            // Look for "Program" 
-            if (memcmp(buffer + i, "Program", 7) == 0) {
-                printf("   Found 'Program' at: 0x%lx\n", offset + i);
-            }
-            
-            // Look for "Routine"
-            if (memcmp(buffer + i, "Routine", 7) == 0) {
-                printf("   Found 'Routine' at: 0x%lx\n", offset + i);
-            }
-            
-            // Look for "DataType"
-            if (memcmp(buffer + i, "DataType", 8) == 0) {
-                printf("   Found 'DataType' at: 0x%lx\n", offset + i);
-            }
+    char old_path[256], new_path[256], tmp_path[256];
+    size_t count = 0;
+    for (size_t i = 0; i < block_count; i++) {
+        const PreviousBlock *match = bsearch(&blocks[i], sorted, previous_count, sizeof(*sorted), compare_content);
+        if (!match) {
+            continue;
+        }
+        const CompressedBlock *old = &match->block;
+        int old_num = match->number;
+        int new_num = (int)i + 1;
+        block_path(old_path, sizeof(old_path), old_num, old->offset, "bin");
+        
+        // The file must still be the one that block produced
+        struct stat st;
+        if (stat(old_path, &st) != 0 || (uint64_t)st.st_size != blocks[i].uncompressed_size) {
+            continue;
+        }
+        if (old_num == new_num && old->offset == blocks[i].offset) {
+            reused[i] = 1;
+            count++;
+            continue;
         }
-        offset += sizeof(buffer);
         
-        // Just scan first 100KB
-        if (offset - start_offset > 100000) break;
+        snprintf(tmp_path, sizeof(tmp_path), "extracted_blocks/.reuse_%zu.bin", i);
+        if (rename(old_path, tmp_path) != 0) {
+            continue;
+        }
+        block_path(old_path, sizeof(old_path), old_num, old->offset, "xml");
+        snprintf(tmp_path, sizeof(tmp_path), "extracted_blocks/.reuse_%zu.xml", i);
+        if (rename(old_path, tmp_path) != 0) {
+            unlink(tmp_path);
+        }
+        pending[i] = 1;
     }
+    
+    for (size_t i = 0; i < block_count; i++) {
+        if (!pending[i]) continue;
+        snprintf(tmp_path, sizeof(tmp_path), "extracted_blocks/.reuse_%zu.bin", i);
+        block_path(new_path, sizeof(new_path), (int)i + 1, blocks[i].offset, "bin");
+        if (rename(tmp_path, new_path) != 0) {
+            unlink(tmp_path);
+            continue;
+        }
+        snprintf(tmp_path, sizeof(tmp_path), "extracted_blocks/.reuse_%zu.xml", i);
+        block_path(new_path, sizeof(new_path), (int)i + 1, blocks[i].offset, "xml");
+        if (rename(tmp_path, new_path) != 0) {
+            // No copy to move; drop any stale one left under the new name
+            unlink(new_path);
+        }
+        reused[i] = 1;
+        count++;
+    }
+    
+    free(sorted);
+    free(pending);
+    return count;
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <acd_file>\n", argv[0]);
-        return 1;
+// Shared state for --jobs extraction
+typedef struct {
+    const ACD_File *acd;
+    CompressedBlock *blocks;
+    ExtractResult *results;
+    InflateContext *contexts;    // One per worker, reused across blocks
+    const unsigned char *reused;
+    BlockCache *cache;
+} ExtractJob;
+
+static void extract_task(void *arg, size_t index, int worker) {
+    ExtractJob *job = arg;
+    if (job->reused[index]) {
+        memset(&job->results[index], 0, sizeof(job->results[index]));
+        job->results[index].reused = 1;
+        return;
+    }
+    extract_gzip_block(&job->contexts[worker], job->acd, &job->blocks[index],
+                       (int)index + 1, &job->results[index], job->cache);
+}
+
+int extract_blocks(const ACD_File *acd, CompressedBlock *blocks, size_t block_count, int jobs,
+                   const CompressedBlock *previous, size_t previous_count, BlockCache *cache) {
+    if (jobs <= 0) {
+        jobs = acd_cpu_count();
     }
     
-    printf("🚀 ACD Extractor v2.0\n");
-    printf("====================\n\n");
+    // Create output directory
+    mkdir("extracted_blocks", 0755);
     
-    FILE *file = fopen(argv[1], "rb");
-    if (!file) {
-        perror("Failed to open file");
-        return 1;
+    unsigned char *reused = calloc(block_count ? block_count : 1, 1);
+    if (!reused) {
+        return -1;
     }
+    size_t reused_count = 0;
+    if (previous && previous_count) {
+        reused_count = reuse_unchanged(blocks, block_count, previous, previous_count, reused);
+        printf("♻️  %zu of %zu blocks unchanged since the last extraction\n\n", reused_count, block_count);
+    }
+    size_t work = block_count - reused_count;
     
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
-    
-    printf("📄 File: %s\n", argv[1]);
-    printf("📏 Size: %.2f MB\n\n", file_size / (1024.0 * 1024.0));
+    ThreadPool *pool = NULL;
+    if (jobs > 1 && work > 1) {
+        pool = acd_pool_create(jobs < (int)work ? jobs : (int)work);
+    }
     
-    // Find binary start (skip text header)
-    char line[1024];
-    long binary_start = 0;
-    while (fgets(line, sizeof(line), file)) {
-        int is_binary = 0;
-        for (int i = 0; line[i]; i++) {
-            if ((unsigned char)line[i] < 0x20 && line[i] != '\r' && line[i] != '\n' && line[i] != '\t') {
-                is_binary = 1;
-                break;
-            }
+    if (pool) {
+        // Discovery is finished, so members inflate independently; reports
+        // are printed afterwards in block order
+        int workers = acd_pool_size(pool);
+        InflateContext *contexts = calloc((size_t)workers, sizeof(*contexts));
+        ExtractResult *results = calloc(block_count, sizeof(*results));
+        if (!contexts || !results) {
+            acd_pool_destroy(pool);
+            free(contexts);
+            free(results);
+            free(reused);
+            return -1;
         }
-        if (is_binary) {
-            binary_start = ftell(file) - strlen(line);
-            break;
+        ExtractJob job = { acd, blocks, results, contexts, reused, cache };
+        
+        printf("🧵 Decompressing on %d threads\n\n", workers);
+        acd_pool_run(pool, block_count, extract_task, &job);
+        acd_pool_destroy(pool);
+        
+        for (int w = 0; w < workers; w++) {
+            inflate_context_end(&contexts[w]);
+        }
+        free(contexts);
+        
+        for (size_t i = 0; i < block_count; i++) {
+            report_block(&blocks[i], (int)i + 1, &results[i]);
+        }
+        free(results);
+    } else {
+        // One block in memory at a time; the iterator only sees the blocks
+        // that changed, and reused ones are reported in between
+        CompressedBlock *changed = blocks;
+        size_t *numbers = NULL;
+        if (reused_count) {
+            changed = malloc((work ? work : 1) * sizeof(*changed));
+            numbers = malloc((work ? work : 1) * sizeof(*numbers));
+            if (!changed || !numbers) {
+                free(changed);
+                free(numbers);
+                free(reused);
+                return -1;
+            }
+            for (size_t i = 0, n = 0; i < block_count; i++) {
+                if (!reused[i]) {
+                    changed[n] = blocks[i];
+                    numbers[n++] = i;
+                }
+            }
         }
-    }
-    
-    printf("📍 Binary data starts at: 0x%lx\n\n", binary_start);
-    
-    // Extract GZIP blocks
-    printf("🗜️  Extracting compressed blocks...\n\n");
-    
-    fseek(file, binary_start, SEEK_SET);
-    unsigned char buffer[4096];
-    long offset = binary_start;
-    int block_count = 0;
-    
-    while (offset < file_size - 10) {
-        fseek(file, offset, SEEK_SET);
-        size_t bytes_read = fread(buffer, 1, sizeof(buffer), file);
         
-        for (size_t i = 0; i < bytes_read - 10; i++) {
-            if (buffer[i] == 0x1F && buffer[i+1] == 0x8B) {
-                extract_gzip_block(file, offset + i, ++block_count);
-                if (block_count >= 20) goto done; // Extract first 20 blocks
+        size_t next = 0;
+        BlockIter it;
+        const CompressedBlock *block;
+        acd_block_iter_open(&it, acd, changed, work);
+        acd_block_iter_use_cache(&it, cache);
+        while (acd_block_iter_next(&it, &block) > 0) {
+            size_t index = numbers ? numbers[it.number - 1] : (size_t)it.number - 1;
+            for (; next < index; next++) {
+                ExtractResult kept = { .reused = 1 };
+                report_block(&blocks[next], (int)next + 1, &kept);
+            }
+            next = index + 1;
+            
+            ExtractResult result = {
+                .ret = block->data ? Z_STREAM_END : Z_DATA_ERROR,
+                .cached = block->data && block->data == it.cached.data,
+            };
+            if (block->data) {
+                save_block(block, (int)index + 1, &result);
             }
+            report_block(block, (int)index + 1, &result);
         }
-        offset += bytes_read - 10;
+        acd_block_iter_close(&it);
+        for (; next < block_count; next++) {
+            if (reused[next]) {
+                ExtractResult kept = { .reused = 1 };
+                report_block(&blocks[next], (int)next + 1, &kept);
+            }
+        }
+        
+        if (changed != blocks) free(changed);
+        free(numbers);
     }
+    free(reused);
+    return 0;
+}
+
+static void print_database_hit(void *arg, int id, size_t offset) {
+    const SignatureSet *sigs = arg;
+    if (acd_quiet) return;
+    printf("   Found '%s' at: 0x%zx\n", acd_signatures_name(sigs, id), offset);
+}
+
+// Search for database files
+void find_database_files(const ACD_File *acd, long start_offset, const SignatureSet *sigs) {
+    printf("\n🔍 Searching for database file structures...\n");
     
-done:
-    printf("\n📊 Extracted %d compressed blocks\n", block_count);
-    
-    // Search for database structures
-    find_database_files(file, binary_start);
+    SignatureSet *defaults = NULL;
+    if (!sigs) {
+        sigs = defaults = acd_signatures_default();
+        if (!sigs) return;
+    }
     
-    fclose(file);
+    // Whole region, all signatures, one pass
+    size_t hits = acd_signatures_scan(sigs, acd->data + start_offset,
+                                      (size_t)(acd->file_size - start_offset),
+                                      (size_t)start_offset, print_database_hit, (void *)sigs);
+    printf("   %zu signature hits\n", hits);
     
-    printf("\n✅ Extraction complete! Check 'extracted_blocks' directory\n");
-    return 0;
-} 
\ No newline at end of file
+    acd_signatures_destroy(defaults);
+}
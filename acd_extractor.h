@@ -0,0 +1,50 @@
+#ifndef ACD_EXTRACTOR_H
+#define ACD_EXTRACTOR_H
+
+#include <stddef.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_signatures.h"
+#include "acd_blockcache.h"
+
+// Outcome of extracting one block, kept so reports print in block order
+// even when blocks are decompressed on worker threads
+typedef struct {
+    int ret;                     // zlib status of the inflate
+    int reused;                  // Unchanged since the previous extraction; not inflated
+    int cached;                  // Read from the block cache instead of inflated
+    int saved;                   // .bin written
+    int saved_xml;               // .xml copy written
+    size_t preview_len;
+    unsigned char preview[50];
+} ExtractResult;
+
+// Write a decompressed block to extracted_blocks/ (no printing; see report_block)
+void save_block(const CompressedBlock *block, int block_num, ExtractResult *result);
+
+// Inflate one member with ctx and save it; the block's data is released.
+// With a cache (may be NULL), an indexed member is looked up there first
+// and added to it after inflating.
+int extract_gzip_block(InflateContext *ctx, const ACD_File *acd, CompressedBlock *block,
+                       int block_num, ExtractResult *result, BlockCache *cache);
+
+// Print what extract_gzip_block did for one block
+void report_block(const CompressedBlock *block, int block_num, const ExtractResult *result);
+
+// Decompress and save every block into extracted_blocks/, on jobs threads
+// (1 = serial, one block in memory at a time; <= 0 = one per CPU).
+//
+// previous lists the blocks extracted_blocks/ was last written from (the
+// earlier index, NULL for a full extraction). A block with the same CRC32,
+// ISIZE and compressed size as one of them keeps that block's file (renamed
+// if its number or offset moved) and is not inflated again. cache (may be
+// NULL) serves and collects the decompressed bytes of changed blocks.
+int extract_blocks(const ACD_File *acd, CompressedBlock *blocks, size_t block_count, int jobs,
+                   const CompressedBlock *previous, size_t previous_count, BlockCache *cache);
+
+// Print every signature hit from start_offset to the end of the file
+// (sigs NULL = the default database markers)
+void find_database_files(const ACD_File *acd, long start_offset, const SignatureSet *sigs);
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#else
+#include <io.h>
+#define read _read
+#define close _close
+#endif
+
+#include "acd_file.h"
+#include "acd_scan.h"
+#include "acd_stats.h"
+
+#define READ_CHUNK (1024 * 1024)
+
+// Read everything from fd into a heap buffer (fallback for non-mappable files)
+static int read_all(int fd, ACD_File *acd, size_t size_hint) {
+    // One spare byte lets a correctly sized buffer see EOF without growing
+    size_t capacity = size_hint > 0 ? size_hint + 1 : READ_CHUNK;
+    size_t used = 0;
+    unsigned char *buffer = malloc(capacity);
+    if (!buffer) {
+        return -1;
+    }
+
+    for (;;) {
+        if (used == capacity) {
+            unsigned char *grown = realloc(buffer, capacity * 2);
+            if (!grown) {
+                free(buffer);
+                return -1;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        ssize_t n = read(fd, buffer + used, capacity - used);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(buffer);
+            return -1;
+        }
+        if (n == 0) break;
+        used += (size_t)n;
+    }
+
+    acd->data = buffer;
+    acd->file_size = (long)used;
+    acd->mapped = 0;
+    return 0;
+}
+
+int acd_file_open(ACD_File *acd, const char *path) {
+    memset(acd, 0, sizeof(*acd));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    // Nanoseconds where the platform has them: a re-save within the same
+    // second must still look newer
+    acd->mtime = (long long)st.st_mtime * 1000000000LL;
+#if defined(__APPLE__)
+    acd->mtime += st.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+    acd->mtime += st.st_mtim.tv_nsec;
+#endif
+
+#ifndef _WIN32
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            // Scanners walk the file front to back
+            madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+            acd->data = map;
+            acd->file_size = (long)st.st_size;
+            acd->mapped = 1;
+            close(fd);
+            return 0;
+        }
+    }
+#endif
+
+    size_t hint = S_ISREG(st.st_mode) && st.st_size > 0 ? (size_t)st.st_size : 0;
+    int ret = read_all(fd, acd, hint);
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return ret;
+}
+
+int acd_file_prefetch(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = -1;
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    ret = posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0 ? 0 : -1;
+#endif
+    close(fd);
+    return ret;
+}
+
+void acd_file_close(ACD_File *acd) {
+    if (acd->data) {
+#ifndef _WIN32
+        if (acd->mapped) {
+            munmap((void *)acd->data, (size_t)acd->file_size);
+        } else
+#endif
+        {
+            free((void *)acd->data);
+        }
+    }
+    free(acd->header_text);
+    memset(acd, 0, sizeof(*acd));
+}
+
+long acd_find_binary_start(const ACD_File *acd) {
+    uint64_t start = acd_now_ns();
+    size_t size = (size_t)acd->file_size;
+    size_t hit = acd_scan_first_control(acd->data, size, 0);
+    if (hit >= size) {
+        hit = 0;
+    }
+
+    // Back up to the start of the line holding the first control byte
+    while (hit > 0 && acd->data[hit - 1] != '\n') {
+        hit--;
+    }
+    acd_stat_time(&acd_stats.header_ns, start);
+    return (long)hit;
+}
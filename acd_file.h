@@ -0,0 +1,47 @@
+#ifndef ACD_FILE_H
+#define ACD_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Structure to hold ACD file info
+//
+// The whole file is exposed as one read-only byte span. Regular files are
+// memory-mapped; anything mmap can't handle (pipes, special files, empty
+// files) is read into a heap buffer instead, so callers never need to care.
+typedef struct {
+    const unsigned char *data;  // Zero-copy view of the whole file
+    long file_size;
+    char *header_text;
+    long binary_start;
+    long long mtime;            // Modification time (nanoseconds) at open
+    int mapped;                 // 1 if data is an mmap, 0 if heap-buffered
+} ACD_File;
+
+// Open a file and map it into memory (or buffer it). Returns 0 on success,
+// -1 on failure with errno set.
+int acd_file_open(ACD_File *acd, const char *path);
+
+// Start reading path into the page cache in the background, so a later
+// acd_file_open of it doesn't wait on the disk. Best effort: returns 0 if
+// the OS took the hint, -1 otherwise.
+int acd_file_prefetch(const char *path);
+
+// Release the mapping/buffer and any header text
+void acd_file_close(ACD_File *acd);
+
+// Offset of the first line of the text header that contains a control
+// character other than TAB/CR/LF, i.e. where the binary region starts.
+// Returns 0 if the whole file is text.
+long acd_find_binary_start(const ACD_File *acd);
+
+// Bounds-checked pointer into the file span, or NULL if the range
+// [offset, offset + len) does not lie inside the file
+static inline const unsigned char *acd_file_ptr(const ACD_File *acd, long offset, size_t len) {
+    if (offset < 0 || offset > acd->file_size || len > (size_t)(acd->file_size - offset)) {
+        return NULL;
+    }
+    return acd->data + offset;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Find and decompress the gzip members of an ACD file
+
+Uses the libacd extension (python/libacd.c, built with
+`cd python && python setup.py build_ext --inplace`) when it is available:
+the scan and every inflate run in C without the GIL and the decompressed
+blocks come back as memoryviews over the library's buffers. Without it,
+each candidate is decompressed once with a streaming zlib object, whose
+unused_data marks exactly where the member ends, so nothing is retried
+over growing slices.
+"""
+
+import os
+import sys
+import zlib
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "python"))
+try:
+    import libacd
+except ImportError:
+    libacd = None
+
+CHUNK = 1 << 16
+
+
+def _inflate_member(data, pos):
+    """Decompress the gzip member at data[pos:]; (compressed_size, bytes) or None"""
+    view = memoryview(data)
+    d = zlib.decompressobj(16 + zlib.MAX_WBITS)
+    out = []
+    end = pos
+    try:
+        while not d.eof and end < len(view):
+            chunk = view[end:end + CHUNK]
+            end += len(chunk)
+            out.append(d.decompress(chunk))
+    except zlib.error:
+        return None
+    if not d.eof:
+        return None
+    return end - pos - len(d.unused_data), b"".join(out)
+
+
+def gzip_members(path=None, data=None, start=0):
+    """
+    Yield (offset, compressed_size, decompressed) for every complete gzip
+    member at or after start, in file order. Give the path (needed for
+    libacd), the file's bytes, or both. decompressed is a memoryview with
+    libacd and bytes without it.
+    """
+    if libacd is not None and path is not None:
+        with libacd.AcdFile(str(path)) as acd:
+            for offset, compressed, uncompressed, _crc, _kind in acd.blocks():
+                if offset >= start:
+                    yield offset, compressed, acd.inflate(offset, compressed, uncompressed)
+        return
+
+    if data is None:
+        with open(path, "rb") as f:
+            data = f.read()
+    pos = data.find(b"\x1f\x8b\x08", start)
+    while pos != -1:
+        member = _inflate_member(data, pos)
+        if member:
+            size, decompressed = member
+            yield pos, size, decompressed
+            pos += size
+        else:
+            pos += 1
+        pos = data.find(b"\x1f\x8b\x08", pos)
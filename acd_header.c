@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "acd_header.h"
+#include "acd_stats.h"
+
+static HeaderSpan trim(const char *p, size_t len) {
+    while (len && isspace((unsigned char)p[0])) { p++; len--; }
+    while (len && isspace((unsigned char)p[len - 1])) len--;
+    HeaderSpan span = { p, len };
+    return span;
+}
+
+static int span_contains(HeaderSpan span, const char *needle) {
+    size_t n = strlen(needle);
+    for (size_t i = 0; i + n <= span.len; i++) {
+        if (strncasecmp(span.ptr + i, needle, n) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int span_equals(HeaderSpan span, const char *text) {
+    return span.len == strlen(text) && strncasecmp(span.ptr, text, span.len) == 0;
+}
+
+// "=~=~=~ Section =~=~=~" -> "Section"
+static HeaderSpan banner_name(HeaderSpan line) {
+    const char *p = line.ptr;
+    size_t len = line.len;
+    while (len && (*p == '=' || *p == '~' || *p == ' ')) { p++; len--; }
+    while (len && (p[len - 1] == '=' || p[len - 1] == '~' || p[len - 1] == ' ')) len--;
+    HeaderSpan span = { p, len };
+    return span;
+}
+
+static int add_entry(ACD_Header *header, size_t *capacity, HeaderEntry entry) {
+    if (header->count == *capacity) {
+        size_t grown_capacity = *capacity ? *capacity * 2 : 32;
+        HeaderEntry *grown = realloc(header->entries, grown_capacity * sizeof(*grown));
+        if (!grown) {
+            return -1;
+        }
+        header->entries = grown;
+        *capacity = grown_capacity;
+    }
+    header->entries[header->count++] = entry;
+    return 0;
+}
+
+int acd_header_parse(const ACD_File *acd, ACD_Header *header) {
+    memset(header, 0, sizeof(*header));
+    uint64_t start = acd_now_ns();
+
+    const char *text = (const char *)acd->data;
+    size_t end = acd->binary_start > 0 ? (size_t)acd->binary_start : (size_t)acd->file_size;
+    size_t capacity = 0;
+    HeaderSpan section = { NULL, 0 };
+    int in_history = 0;
+
+    size_t pos = 0;
+    while (pos < end) {
+        const char *nl = memchr(text + pos, '\n', end - pos);
+        size_t next = nl ? (size_t)(nl - text) + 1 : end;
+        HeaderSpan line = trim(text + pos, next - pos);
+        pos = next;
+        header->lines++;
+
+        if (line.len >= 4 && memcmp(line.ptr, "=~=~", 4) == 0) {
+            section = banner_name(line);
+            in_history = span_contains(section, "History");
+            continue;
+        }
+
+        const char *colon = memchr(line.ptr, ':', line.len);
+        if (!colon) {
+            continue;
+        }
+        HeaderEntry entry = {
+            section,
+            trim(line.ptr, (size_t)(colon - line.ptr)),
+            trim(colon + 1, line.len - (size_t)(colon - line.ptr) - 1),
+        };
+        if (entry.key.len == 0) {
+            continue;
+        }
+
+        if (in_history) {
+            if (header->history_count == 0) header->history_first = header->count;
+            header->history_count++;
+        } else {
+            if (!header->name.len && (span_equals(entry.key, "Name") || span_equals(entry.key, "Project Name"))) {
+                header->name = entry.value;
+            }
+            if (!header->version.len && span_contains(entry.key, "Version")) {
+                header->version = entry.value;
+            }
+            if (!header->revision.len && span_contains(entry.key, "Revision")) {
+                header->revision = entry.value;
+            }
+        }
+        if (add_entry(header, &capacity, entry) != 0) {
+            acd_header_free(header);
+            return -1;
+        }
+    }
+    acd_stat_time(&acd_stats.header_ns, start);
+    return 0;
+}
+
+const HeaderEntry *acd_header_get(const ACD_Header *header, const char *key) {
+    for (size_t i = 0; i < header->count; i++) {
+        if (span_equals(header->entries[i].key, key)) {
+            return &header->entries[i];
+        }
+    }
+    return NULL;
+}
+
+void acd_header_free(ACD_Header *header) {
+    free(header->entries);
+    memset(header, 0, sizeof(*header));
+}
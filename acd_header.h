@@ -0,0 +1,46 @@
+#ifndef ACD_HEADER_H
+#define ACD_HEADER_H
+
+#include <stddef.h>
+
+#include "acd_file.h"
+
+// Text header of an ACD: "=~=~ Section =~=~" banner lines followed by
+// " Key: Value" lines, up to acd->binary_start. Strings are spans into the
+// mapped file (not NUL-terminated) and stay valid while the file is open.
+typedef struct {
+    const char *ptr;
+    size_t len;
+} HeaderSpan;
+
+typedef struct {
+    HeaderSpan section;          // Banner the entry appeared under (may be empty)
+    HeaderSpan key;
+    HeaderSpan value;
+} HeaderEntry;
+
+typedef struct {
+    HeaderEntry *entries;
+    size_t count;
+    size_t lines;
+
+    // Shortcuts to common entries (len 0 when absent)
+    HeaderSpan name;             // "Name" / "Project Name"
+    HeaderSpan version;          // First key containing "Version"
+    HeaderSpan revision;         // First key containing "Revision" (Studio 5000 revision)
+
+    // Entries under a "...History..." banner, in file order
+    size_t history_first;
+    size_t history_count;
+} ACD_Header;
+
+// Parse header lines in [0, acd->binary_start) (the whole file if
+// binary_start is 0). Prints nothing. Returns 0, or -1 on allocation failure.
+int acd_header_parse(const ACD_File *acd, ACD_Header *header);
+
+// First entry with exactly this key (case-insensitive), or NULL
+const HeaderEntry *acd_header_get(const ACD_Header *header, const char *key);
+
+void acd_header_free(ACD_Header *header);
+
+#endif
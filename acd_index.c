@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "acd_index.h"
+#include "acd_scan.h"
+#include "acd_stats.h"
+
+#define FINGERPRINT_SAMPLE 65536
+
+// How far ahead of the last matched previous entry to look for a trailer
+// match; blocks removed in a re-save skip at most this many
+#define REBUILD_LOOKAHEAD 8
+
+_Static_assert(sizeof(BlockIndexHeader) == 56, "index header layout changed");
+_Static_assert(sizeof(BlockIndexEntry) == 24, "index entry layout changed");
+
+uint64_t acd_index_fingerprint(const ACD_File *acd) {
+    size_t size = (size_t)acd->file_size;
+    size_t head = size < FINGERPRINT_SAMPLE ? size : FINGERPRINT_SAMPLE;
+    size_t tail = size - head < FINGERPRINT_SAMPLE ? size - head : FINGERPRINT_SAMPLE;
+
+    uLong head_crc = crc32(0L, acd->data, (uInt)head);
+    uLong tail_crc = crc32(0L, acd->data + size - tail, (uInt)tail);
+    return ((uint64_t)head_crc << 32) | (uint64_t)tail_crc;
+}
+
+int acd_index_path(const char *acd_path, char *out, size_t out_size) {
+    int n = snprintf(out, out_size, "%s%s", acd_path, ACD_INDEX_SUFFIX);
+    return n < 0 || (size_t)n >= out_size ? -1 : 0;
+}
+
+// Map path and check the layout; freshness is up to the caller
+static int map_index(BlockIndex *index, const char *acd_path) {
+    memset(index, 0, sizeof(*index));
+
+    char path[4096];
+    if (acd_index_path(acd_path, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    if (acd_file_open(&index->map, path) != 0) {
+        return -1;
+    }
+
+    const BlockIndexHeader *header = (const BlockIndexHeader *)acd_file_ptr(&index->map, 0, sizeof(*header));
+    if (!header ||
+        memcmp(header->magic, ACD_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ACD_INDEX_VERSION ||
+        header->byte_order != ACD_INDEX_BYTE_ORDER) {
+        acd_index_close(index);
+        return -1;
+    }
+
+    size_t entries_size = (size_t)header->block_count * sizeof(BlockIndexEntry);
+    const unsigned char *entries = acd_file_ptr(&index->map, sizeof(*header), entries_size);
+    if (!entries || (size_t)index->map.file_size != sizeof(*header) + entries_size) {
+        acd_index_close(index);
+        return -1;
+    }
+
+    index->header = header;
+    index->entries = (const BlockIndexEntry *)entries;
+    index->count = header->block_count;
+    return 0;
+}
+
+static uint32_t read_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Does the member at offset end the way previous entry e did?
+static int trailer_matches(const ACD_File *acd, long offset, const BlockIndexEntry *e) {
+    if (e->compressed_size < 18) {
+        return 0;
+    }
+    const unsigned char *trailer = acd_file_ptr(acd, offset + (long)e->compressed_size - 8, 8);
+    return trailer && read_le32(trailer) == e->crc32 && read_le32(trailer + 4) == e->uncompressed_size;
+}
+
+// Every entry still starts with a gzip magic and ends in the trailer it
+// recorded; catches a same-size re-save the header checks can't tell apart
+static int entries_match(const ACD_File *acd, const BlockIndex *index) {
+    for (size_t i = 0; i < index->count; i++) {
+        const BlockIndexEntry *e = &index->entries[i];
+        const unsigned char *magic =
+            e->offset <= (uint64_t)acd->file_size ? acd_file_ptr(acd, (long)e->offset, 3) : NULL;
+        if (!magic || magic[0] != 0x1f || magic[1] != 0x8b || magic[2] != 0x08 ||
+            !trailer_matches(acd, (long)e->offset, e)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int acd_index_load(BlockIndex *index, const char *acd_path, const ACD_File *acd) {
+    if (map_index(index, acd_path) != 0) {
+        return -1;
+    }
+    const BlockIndexHeader *header = index->header;
+    if (header->file_size != (uint64_t)acd->file_size ||
+        header->mtime != (int64_t)acd->mtime ||
+        header->fingerprint != acd_index_fingerprint(acd) ||
+        !entries_match(acd, index)) {
+        acd_index_close(index);
+        return -1;
+    }
+    return 0;
+}
+
+int acd_index_load_previous(BlockIndex *index, const char *acd_path) {
+    return map_index(index, acd_path);
+}
+
+void acd_index_close(BlockIndex *index) {
+    acd_file_close(&index->map);
+    memset(index, 0, sizeof(*index));
+}
+
+int acd_index_rebuild(const ACD_File *acd, const BlockIndexEntry *previous, size_t previous_count,
+                      CompressedBlock **blocks, size_t *count, size_t *reused) {
+    *blocks = NULL;
+    *count = 0;
+    if (reused) *reused = 0;
+
+    const unsigned char *region = acd->data + acd->binary_start;
+    size_t region_size = (size_t)(acd->file_size - acd->binary_start);
+    size_t capacity = 0, n = 0;
+    size_t next_previous = 0;
+    CompressedBlock *list = NULL;
+    InflateContext *ctx = inflate_context_acquire();
+    if (!ctx) {
+        return -1;
+    }
+    uint64_t start = acd_now_ns();
+
+    size_t pos = 0;
+    while ((pos = acd_scan_next_gzip(region, region_size, pos)) < region_size) {
+        if (n == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            CompressedBlock *grown = realloc(list, capacity * sizeof(*list));
+            if (!grown) {
+                free(list);
+                inflate_context_release(ctx);
+                return -1;
+            }
+            list = grown;
+        }
+
+        long offset = acd->binary_start + (long)pos;
+        CompressedBlock *block = &list[n];
+
+        // An unchanged member usually follows the last one matched; its
+        // trailer is enough to recognise it
+        size_t end = next_previous + REBUILD_LOOKAHEAD;
+        if (end > previous_count) end = previous_count;
+        size_t k = next_previous;
+        while (k < end && !trailer_matches(acd, offset, &previous[k])) {
+            k++;
+        }
+        if (k < end) {
+            memset(block, 0, sizeof(*block));
+            block->offset = offset;
+            block->compressed_size = previous[k].compressed_size;
+            block->uncompressed_size = previous[k].uncompressed_size;
+            block->crc32 = previous[k].crc32;
+            block->kind = previous[k].kind;
+            next_previous = k + 1;
+            if (reused) (*reused)++;
+            acd_stat_add(&acd_stats.candidates, 1);
+            acd_stat_add(&acd_stats.blocks, 1);
+        } else if (acd_block_probe_ctx(ctx, acd, offset, block) != 0) {
+            pos++;
+            continue;
+        }
+
+        // Resume after the member; magic bytes inside its payload are noise
+        pos += block->compressed_size;
+        n++;
+    }
+
+    // Everything but the probes' inflating is scanning and rejecting
+    acd_stat_add(&acd_stats.scan_ns, acd_now_ns() - start - ctx->probe_ns);
+    acd_stat_add(&acd_stats.scan_bytes, region_size);
+    inflate_context_release(ctx);
+    *blocks = list;
+    *count = n;
+    return 0;
+}
+
+int acd_index_build(const ACD_File *acd, CompressedBlock **blocks, size_t *count) {
+    return acd_index_rebuild(acd, NULL, 0, blocks, count, NULL);
+}
+
+int acd_index_write(const char *acd_path, const ACD_File *acd,
+                    const CompressedBlock *blocks, size_t count) {
+    char path[4096], tmp[4096 + 8];
+    if (acd_index_path(acd_path, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        return -1;
+    }
+
+    BlockIndexHeader header = {0};
+    memcpy(header.magic, ACD_INDEX_MAGIC, sizeof(header.magic));
+    header.version = ACD_INDEX_VERSION;
+    header.byte_order = ACD_INDEX_BYTE_ORDER;
+    header.file_size = (uint64_t)acd->file_size;
+    header.mtime = (int64_t)acd->mtime;
+    header.fingerprint = acd_index_fingerprint(acd);
+    header.binary_start = acd->binary_start;
+    header.block_count = (uint32_t)count;
+
+    int ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (size_t i = 0; ok && i < count; i++) {
+        BlockIndexEntry entry = {
+            .offset = (uint64_t)blocks[i].offset,
+            .compressed_size = blocks[i].compressed_size,
+            .uncompressed_size = blocks[i].uncompressed_size,
+            .crc32 = blocks[i].crc32,
+            .kind = blocks[i].kind,
+        };
+        ok = fwrite(&entry, sizeof(entry), 1, out) == 1;
+    }
+
+    if (fclose(out) != 0) ok = 0;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static CompressedBlock *copy_entries(const BlockIndex *index) {
+    CompressedBlock *list = calloc(index->count ? index->count : 1, sizeof(*list));
+    if (!list) {
+        return NULL;
+    }
+    for (size_t i = 0; i < index->count; i++) {
+        list[i].offset = (long)index->entries[i].offset;
+        list[i].compressed_size = index->entries[i].compressed_size;
+        list[i].uncompressed_size = index->entries[i].uncompressed_size;
+        list[i].crc32 = index->entries[i].crc32;
+        list[i].kind = index->entries[i].kind;
+    }
+    return list;
+}
+
+int acd_index_refresh(const char *acd_path, ACD_File *acd,
+                      CompressedBlock **blocks, size_t *count, IndexRefresh *refresh) {
+    IndexRefresh local;
+    if (!refresh) refresh = &local;
+    memset(refresh, 0, sizeof(*refresh));
+    *blocks = NULL;
+    *count = 0;
+
+    BlockIndex index;
+    if (acd_index_load(&index, acd_path, acd) == 0) {
+        acd->binary_start = (long)index.header->binary_start;
+        CompressedBlock *list = copy_entries(&index);
+        *count = index.count;
+        acd_index_close(&index);
+        if (!list) {
+            *count = 0;
+            return -1;
+        }
+        *blocks = list;
+        refresh->from_index = 1;
+        return 0;
+    }
+
+    // A stale index from an earlier save still knows most of the members
+    acd->binary_start = acd_find_binary_start(acd);
+    int ret;
+    if (acd_index_load_previous(&index, acd_path) == 0) {
+        ret = acd_index_rebuild(acd, index.entries, index.count, blocks, count, &refresh->reused);
+        if (ret == 0 && index.count) {
+            refresh->previous = copy_entries(&index);
+            refresh->previous_count = refresh->previous ? index.count : 0;
+        }
+        acd_index_close(&index);
+    } else {
+        ret = acd_index_build(acd, blocks, count);
+    }
+    if (ret != 0) {
+        return -1;
+    }
+    // A failed write only costs the next run a rescan
+    acd_index_write(acd_path, acd, *blocks, *count);
+    return 0;
+}
+
+int acd_index_blocks(const char *acd_path, ACD_File *acd,
+                     CompressedBlock **blocks, size_t *count, int *from_index) {
+    IndexRefresh refresh;
+    if (acd_index_refresh(acd_path, acd, blocks, count, &refresh) != 0) {
+        return -1;
+    }
+    free(refresh.previous);
+    if (from_index) *from_index = refresh.from_index;
+    return 0;
+}
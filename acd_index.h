@@ -0,0 +1,102 @@
+#ifndef ACD_INDEX_H
+#define ACD_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+
+// Sidecar block index: <file>.acdidx next to the ACD
+//
+// Layout is a fixed header followed by block_count fixed-width entries,
+// all little-endian, so a valid index can be mapped and used in place.
+#define ACD_INDEX_SUFFIX ".acdidx"
+#define ACD_INDEX_MAGIC "ACDIDX\0"
+#define ACD_INDEX_VERSION 2
+#define ACD_INDEX_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    int64_t mtime;
+    uint64_t fingerprint;    // CRC32 of the file head and tail samples
+    int64_t binary_start;
+    uint32_t block_count;
+    uint32_t reserved;
+} BlockIndexHeader;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t compressed_size;
+    uint32_t uncompressed_size;
+    uint32_t crc32;
+    uint32_t kind;
+} BlockIndexEntry;
+
+// A loaded (mapped) index
+typedef struct {
+    ACD_File map;
+    const BlockIndexHeader *header;
+    const BlockIndexEntry *entries;
+    size_t count;
+} BlockIndex;
+
+// Cheap identity check for an ACD: samples the first and last 64 KB
+uint64_t acd_index_fingerprint(const ACD_File *acd);
+
+// Build "<acd_path>.acdidx" into out. Returns -1 if it doesn't fit.
+int acd_index_path(const char *acd_path, char *out, size_t out_size);
+
+// Map the sidecar index for acd_path and check it still describes acd
+// (size, mtime in nanoseconds, fingerprint, and every entry's gzip magic
+// and trailer). Returns 0 on success, -1 if missing or stale.
+int acd_index_load(BlockIndex *index, const char *acd_path, const ACD_File *acd);
+
+void acd_index_close(BlockIndex *index);
+
+// Map the sidecar index for acd_path without checking it against the ACD,
+// only that it is well formed. After a re-save its entries describe the
+// previous revision. Returns 0 on success, -1 if missing or malformed.
+int acd_index_load_previous(BlockIndex *index, const char *acd_path);
+
+// Scan acd's binary region and probe each gzip candidate, resuming the
+// scan after every member that decodes. On success *blocks holds *count
+// members (data left NULL); free with free().
+int acd_index_build(const ACD_File *acd, CompressedBlock **blocks, size_t *count);
+
+// acd_index_build against a previous revision's entries (in file order).
+// A candidate whose member would end in the same CRC32/ISIZE trailer as
+// one of the next few previous entries is taken as that member without
+// inflating it; anything else is probed. *reused (if given) counts the
+// members matched by trailer.
+int acd_index_rebuild(const ACD_File *acd, const BlockIndexEntry *previous, size_t previous_count,
+                      CompressedBlock **blocks, size_t *count, size_t *reused);
+
+// Write the sidecar index for acd_path atomically (temp file + rename)
+int acd_index_write(const char *acd_path, const ACD_File *acd,
+                    const CompressedBlock *blocks, size_t count);
+
+// What acd_index_refresh found
+typedef struct {
+    int from_index;              // The sidecar was current and used as is
+    size_t reused;               // Members matched to a stale index by trailer
+    CompressedBlock *previous;   // Blocks of the stale index (NULL if none); free()
+    size_t previous_count;
+} IndexRefresh;
+
+// Blocks for the ACD at acd_path: from its sidecar index when current,
+// otherwise found with acd_index_rebuild against the stale index (or
+// acd_index_build without one) and the index rewritten. Sets
+// acd->binary_start either way. Free *blocks with free().
+int acd_index_refresh(const char *acd_path, ACD_File *acd,
+                      CompressedBlock **blocks, size_t *count, IndexRefresh *refresh);
+
+// acd_index_refresh without the details; *from_index (if given) tells
+// whether the sidecar was current
+int acd_index_blocks(const char *acd_path, ACD_File *acd,
+                     CompressedBlock **blocks, size_t *count, int *from_index);
+
+#endif
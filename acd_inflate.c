@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+
+#include "acd_inflate.h"
+
+#if defined(ACD_INFLATE_LIBDEFLATE)
+
+#include <libdeflate.h>
+
+struct AcdInflater {
+    struct libdeflate_decompressor *d;
+};
+
+AcdInflater *acd_inflater_create(void) {
+    AcdInflater *inflater = malloc(sizeof(*inflater));
+    if (!inflater) {
+        return NULL;
+    }
+    inflater->d = libdeflate_alloc_decompressor();
+    if (!inflater->d) {
+        free(inflater);
+        return NULL;
+    }
+    return inflater;
+}
+
+void acd_inflater_destroy(AcdInflater *inflater) {
+    if (!inflater) return;
+    libdeflate_free_decompressor(inflater->d);
+    free(inflater);
+}
+
+AcdInflateResult acd_inflater_gzip(AcdInflater *inflater, const void *in, size_t in_avail,
+                                   void *out, size_t out_cap, size_t *in_used, size_t *out_used) {
+    // Passing both actual sizes lets the member end before in_avail and
+    // out_cap; libdeflate checks the trailer CRC and ISIZE itself
+    enum libdeflate_result ret = libdeflate_gzip_decompress_ex(inflater->d, in, in_avail, out, out_cap,
+                                                               in_used, out_used);
+    switch (ret) {
+        case LIBDEFLATE_SUCCESS: return ACD_INFLATE_OK;
+        case LIBDEFLATE_INSUFFICIENT_SPACE: return ACD_INFLATE_SHORT_OUTPUT;
+        default: return ACD_INFLATE_BAD_DATA;
+    }
+}
+
+const char *acd_inflate_backend(void) {
+    return "libdeflate";
+}
+
+int acd_inflate_needs_whole_output(void) {
+    return 1;
+}
+
+#elif defined(ACD_INFLATE_ISAL)
+
+#include <isa-l/igzip_lib.h>
+
+struct AcdInflater {
+    struct inflate_state state;
+};
+
+AcdInflater *acd_inflater_create(void) {
+    return malloc(sizeof(AcdInflater));
+}
+
+void acd_inflater_destroy(AcdInflater *inflater) {
+    free(inflater);
+}
+
+AcdInflateResult acd_inflater_gzip(AcdInflater *inflater, const void *in, size_t in_avail,
+                                   void *out, size_t out_cap, size_t *in_used, size_t *out_used) {
+    struct inflate_state *state = &inflater->state;
+    isal_inflate_init(state);
+    state->crc_flag = ISAL_GZIP;  // Parse the header, verify the trailer
+    state->next_in = (uint8_t *)in;
+    state->avail_in = in_avail > UINT32_MAX ? UINT32_MAX : (uint32_t)in_avail;
+    state->next_out = out;
+    state->avail_out = out_cap > UINT32_MAX ? UINT32_MAX : (uint32_t)out_cap;
+
+    int ret = isal_inflate(state);
+    if (ret == ISAL_DECOMP_OK && state->block_state == ISAL_BLOCK_FINISH) {
+        // isal_inflate reads ahead into its bit buffer; those bytes belong
+        // after the member (igzip_cli rewinds by the same amount)
+        size_t consumed = (size_t)(state->next_in - (const uint8_t *)in);
+        size_t buffered = state->read_in_length / 8;
+        if (buffered > consumed || consumed - buffered < 18) {
+            return ACD_INFLATE_BAD_DATA;
+        }
+        *in_used = consumed - buffered;
+        *out_used = state->total_out;
+
+        // The member must end in the ISIZE it decoded to, or the count
+        // above is off and every later offset with it
+        const uint8_t *isize = (const uint8_t *)in + *in_used - 4;
+        uint32_t size = (uint32_t)isize[0] | ((uint32_t)isize[1] << 8) | ((uint32_t)isize[2] << 16) |
+                        ((uint32_t)isize[3] << 24);
+        return size == (uint32_t)*out_used ? ACD_INFLATE_OK : ACD_INFLATE_BAD_DATA;
+    }
+    if (ret == ISAL_DECOMP_OK && state->avail_out == 0) {
+        return ACD_INFLATE_SHORT_OUTPUT;
+    }
+    return ACD_INFLATE_BAD_DATA;
+}
+
+const char *acd_inflate_backend(void) {
+    return "isa-l";
+}
+
+int acd_inflate_needs_whole_output(void) {
+    return 1;
+}
+
+#else
+
+#include <zlib.h>
+
+struct AcdInflater {
+    z_stream strm;
+};
+
+AcdInflater *acd_inflater_create(void) {
+    AcdInflater *inflater = calloc(1, sizeof(*inflater));
+    if (!inflater) {
+        return NULL;
+    }
+    if (inflateInit2(&inflater->strm, 16 + MAX_WBITS) != Z_OK) {
+        free(inflater);
+        return NULL;
+    }
+    return inflater;
+}
+
+void acd_inflater_destroy(AcdInflater *inflater) {
+    if (!inflater) return;
+    inflateEnd(&inflater->strm);
+    free(inflater);
+}
+
+AcdInflateResult acd_inflater_gzip(AcdInflater *inflater, const void *in, size_t in_avail,
+                                   void *out, size_t out_cap, size_t *in_used, size_t *out_used) {
+    z_stream *strm = &inflater->strm;
+    inflateReset(strm);
+    strm->next_in = (Bytef *)in;
+    strm->next_out = out;
+
+    // Z_FINISH with everything in view decodes the member in one pass;
+    // the loop only matters for members past 4 GB
+    size_t in_left = in_avail, out_left = out_cap;
+    int ret;
+    do {
+        uInt in_chunk = in_left > UINT_MAX ? UINT_MAX : (uInt)in_left;
+        uInt out_chunk = out_left > UINT_MAX ? UINT_MAX : (uInt)out_left;
+        strm->avail_in = in_chunk;
+        strm->avail_out = out_chunk;
+        ret = inflate(strm, Z_FINISH);
+        in_left -= in_chunk - strm->avail_in;
+        out_left -= out_chunk - strm->avail_out;
+    } while ((ret == Z_OK || ret == Z_BUF_ERROR) && in_left && out_left &&
+             (strm->avail_in == 0 || strm->avail_out == 0));
+
+    if (ret == Z_STREAM_END) {
+        *in_used = in_avail - in_left;
+        *out_used = out_cap - out_left;
+        return ACD_INFLATE_OK;
+    }
+    if (ret == Z_MEM_ERROR) {
+        return ACD_INFLATE_NO_MEMORY;
+    }
+    if ((ret == Z_OK || ret == Z_BUF_ERROR) && out_left == 0) {
+        return ACD_INFLATE_SHORT_OUTPUT;
+    }
+    return ACD_INFLATE_BAD_DATA;
+}
+
+const char *acd_inflate_backend(void) {
+    return "zlib";
+}
+
+int acd_inflate_needs_whole_output(void) {
+    return 0;
+}
+
+#endif
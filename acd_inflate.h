@@ -0,0 +1,46 @@
+#ifndef ACD_INFLATE_H
+#define ACD_INFLATE_H
+
+#include <stddef.h>
+
+// One-shot gzip member decoder with a compile-time selectable backend
+//
+// When a member's compressed and uncompressed sizes are known (from the
+// block index), the whole member decodes in one call into an exactly
+// sized buffer, which is where the faster libraries win. Build with one of
+//   (default)               stock zlib, inflate() with Z_FINISH
+//   -DACD_INFLATE_LIBDEFLATE  libdeflate (-ldeflate)
+//   -DACD_INFLATE_ISAL       Intel ISA-L igzip (-lisal)
+// zlib-ng needs no flag: its zlib-compat build links in place of zlib and
+// speeds up this backend and every streaming inflate alike.
+//
+// Streaming decodes (head-only reads, unknown sizes) always go through the
+// zlib API in acd_block.
+
+typedef enum {
+    ACD_INFLATE_OK = 0,
+    ACD_INFLATE_SHORT_OUTPUT = 1,  // out_cap too small for the member
+    ACD_INFLATE_BAD_DATA = 2,      // Not a valid gzip member (or bad CRC)
+    ACD_INFLATE_NO_MEMORY = 3
+} AcdInflateResult;
+
+// Per-thread decoder state; not shareable between threads
+typedef struct AcdInflater AcdInflater;
+
+AcdInflater *acd_inflater_create(void);
+void acd_inflater_destroy(AcdInflater *inflater);
+
+// Decode the gzip member at the start of in (in_avail bytes readable; the
+// member may be shorter) into out. On ACD_INFLATE_OK, *in_used is the
+// member's compressed size and *out_used its decompressed size.
+AcdInflateResult acd_inflater_gzip(AcdInflater *inflater, const void *in, size_t in_avail,
+                                   void *out, size_t out_cap, size_t *in_used, size_t *out_used);
+
+// Name of the compiled-in backend ("zlib", "libdeflate", "isa-l")
+const char *acd_inflate_backend(void);
+
+// 1 when the backend can only decode into a buffer big enough for the
+// whole member (probes of unknown size then retry with a bigger buffer)
+int acd_inflate_needs_whole_output(void);
+
+#endif
@@ -0,0 +1,491 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "acd_l5x.h"
+#include "acd_pool.h"
+#include "acd_stats.h"
+
+static const struct {
+    const char *prefix;
+    L5xKind kind;
+} kind_names[] = {
+    { "Controller", L5X_CONTROLLER },
+    { "DataType", L5X_DATATYPE },
+    { "UDT", L5X_DATATYPE },
+    { "Module", L5X_MODULE },
+    { "Tag", L5X_TAG },
+    { "Program", L5X_PROGRAM },
+    { "Routine", L5X_ROUTINE },
+    { "Rung", L5X_RUNG },
+};
+
+L5xKind acd_l5x_kind(const ComponentStore *store, const Component *comp) {
+    const char *type = component_str(store, comp->type);
+    for (size_t i = 0; i < sizeof(kind_names) / sizeof(kind_names[0]); i++) {
+        if (strncasecmp(type, kind_names[i].prefix, strlen(kind_names[i].prefix)) == 0) {
+            return kind_names[i].kind;
+        }
+    }
+    return L5X_NONE;
+}
+
+void acd_l5x_options_from_header(L5xOptions *options, const ACD_Header *header,
+                                 char *buf, size_t buf_size) {
+    memset(options, 0, sizeof(*options));
+    size_t used = 0;
+    HeaderSpan spans[2] = { header->name, header->revision };
+    const char **targets[2] = { &options->controller_name, &options->software_revision };
+    for (int i = 0; i < 2; i++) {
+        if (!spans[i].len || used + spans[i].len + 1 > buf_size) continue;
+        memcpy(buf + used, spans[i].ptr, spans[i].len);
+        buf[used + spans[i].len] = '\0';
+        *targets[i] = buf + used;
+        used += spans[i].len + 1;
+    }
+}
+
+// Growable list of component indices
+typedef struct {
+    uint32_t *items;
+    size_t count;
+    size_t capacity;
+} IndexList;
+
+static int list_push(IndexList *list, uint32_t value) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        uint32_t *grown = realloc(list->items, capacity * sizeof(*grown));
+        if (!grown) {
+            return -1;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = value;
+    return 0;
+}
+
+// Preorder walk of the subtree under start (start itself excluded),
+// children in ordinal order. Descent stops at components of kind stop.
+// Every component of kind want is appended to out.
+static int collect(const ComponentStore *store, const uint8_t *kinds, uint32_t start,
+                   L5xKind want, L5xKind stop, IndexList *stack, IndexList *out) {
+    stack->count = 0;
+    size_t n;
+    const uint32_t *children = component_children(store, start, &n);
+    // Push in reverse so the first child is visited first
+    for (size_t i = n; i-- > 0;) {
+        if (list_push(stack, children[i]) != 0) return -1;
+    }
+    while (stack->count) {
+        uint32_t c = stack->items[--stack->count];
+        if (kinds[c] == want && list_push(out, c) != 0) return -1;
+        if (kinds[c] == stop) continue;
+        children = component_children(store, c, &n);
+        for (size_t i = n; i-- > 0;) {
+            if (list_push(stack, children[i]) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+static void write_name_attr(XmlWriter *w, const ComponentStore *store, uint32_t c) {
+    const Component *comp = &store->items[c];
+    xml_attr(w, "Name", component_str(store, comp->name), comp->name.len);
+}
+
+// Optional <Description> from the component's IOI path
+static void write_description(XmlWriter *w, const ComponentStore *store, uint32_t c,
+                              const char *indent) {
+    const Component *comp = &store->items[c];
+    if (!comp->ioi.len) return;
+    xml_puts(w, indent);
+    xml_puts(w, "<Description>");
+    xml_cdata(w, component_str(store, comp->ioi), comp->ioi.len);
+    xml_puts(w, "</Description>\n");
+}
+
+static void write_tag(XmlWriter *w, const ComponentStore *store, uint32_t c, const char *indent) {
+    xml_puts(w, indent);
+    xml_puts(w, "<Tag");
+    write_name_attr(w, store, c);
+    xml_puts(w, " TagType=\"Base\"");
+    if (store->items[c].ioi.len) {
+        xml_puts(w, ">\n");
+        char inner[32];
+        snprintf(inner, sizeof(inner), "%s  ", indent);
+        write_description(w, store, c, inner);
+        xml_puts(w, indent);
+        xml_puts(w, "</Tag>\n");
+    } else {
+        xml_puts(w, "/>\n");
+    }
+}
+
+// Rung text from logic when it has the rung, else a NOP() placeholder
+static int write_routine(XmlWriter *w, const ComponentStore *store, const uint8_t *kinds,
+                         const RungTable *logic, uint32_t routine, IndexList *stack, IndexList *rungs) {
+    rungs->count = 0;
+    if (collect(store, kinds, routine, L5X_RUNG, L5X_ROUTINE, stack, rungs) != 0) {
+        return -1;
+    }
+
+    xml_puts(w, "          <Routine");
+    write_name_attr(w, store, routine);
+    xml_puts(w, " Type=\"RLL\">\n");
+    xml_puts(w, "            <RLLContent>\n");
+    for (size_t r = 0; r < rungs->count; r++) {
+        const Component *rung = &store->items[rungs->items[r]];
+        xml_puts(w, "              <Rung Number=\"");
+        xml_uint(w, r);
+        xml_puts(w, "\" Type=\"N\">\n");
+        if (rung->name.len) {
+            xml_puts(w, "                <Comment>");
+            xml_cdata(w, component_str(store, rung->name), rung->name.len);
+            xml_puts(w, "</Comment>\n");
+        }
+        long decoded = logic ? rung_table_find(logic, rung->uid) : -1;
+        xml_puts(w, "                <Text>");
+        if (decoded >= 0) {
+            xml_cdata(w, rung_text(logic, (size_t)decoded), logic->text_len[decoded]);
+        } else {
+            xml_cdata(w, "NOP();", 6);
+        }
+        xml_puts(w, "</Text>\n");
+        xml_puts(w, "              </Rung>\n");
+    }
+    xml_puts(w, "            </RLLContent>\n");
+    xml_puts(w, "          </Routine>\n");
+    return 0;
+}
+
+static int write_program(XmlWriter *w, const ComponentStore *store, const uint8_t *kinds,
+                         const RungTable *logic, uint32_t program, IndexList *stack, IndexList *items,
+                         IndexList *rungs) {
+    xml_puts(w, "      <Program");
+    write_name_attr(w, store, program);
+    xml_puts(w, ">\n");
+
+    items->count = 0;
+    if (collect(store, kinds, program, L5X_TAG, L5X_PROGRAM, stack, items) != 0) {
+        return -1;
+    }
+    if (items->count) {
+        xml_puts(w, "        <Tags>\n");
+        for (size_t i = 0; i < items->count; i++) {
+            write_tag(w, store, items->items[i], "          ");
+        }
+        xml_puts(w, "        </Tags>\n");
+    }
+
+    items->count = 0;
+    if (collect(store, kinds, program, L5X_ROUTINE, L5X_PROGRAM, stack, items) != 0) {
+        return -1;
+    }
+    xml_puts(w, "        <Routines>\n");
+    for (size_t i = 0; i < items->count; i++) {
+        if (write_routine(w, store, kinds, logic, items->items[i], stack, rungs) != 0) {
+            return -1;
+        }
+    }
+    xml_puts(w, "        </Routines>\n");
+    xml_puts(w, "      </Program>\n");
+    return 0;
+}
+
+// Components reachable from the roots, bucketed by section. Controller
+// tags are those without a Program above them.
+typedef struct {
+    IndexList datatypes;
+    IndexList modules;
+    IndexList tags;
+    IndexList programs;
+    long controller;             // Controller component, or -1
+    const RungTable *logic;      // Decoded rung text, or NULL
+} Sections;
+
+static int collect_sections(const ComponentStore *store, const uint8_t *kinds, Sections *s) {
+    // Stack entries are index << 1 | inside-a-program
+    IndexList stack = {0};
+    int ok = 0;
+    s->controller = -1;
+    for (size_t r = store->root_count; r-- > 0;) {
+        if (list_push(&stack, store->roots[r] << 1) != 0) goto done;
+    }
+    while (stack.count) {
+        uint32_t entry = stack.items[--stack.count];
+        uint32_t c = entry >> 1;
+        int in_program = entry & 1;
+        int push_ok = 0;
+        switch (kinds[c]) {
+            case L5X_CONTROLLER: if (s->controller < 0) s->controller = c; push_ok = 1; break;
+            case L5X_DATATYPE: push_ok = list_push(&s->datatypes, c) == 0; break;
+            case L5X_MODULE: push_ok = list_push(&s->modules, c) == 0; break;
+            case L5X_TAG: push_ok = in_program || list_push(&s->tags, c) == 0; break;
+            case L5X_PROGRAM: push_ok = list_push(&s->programs, c) == 0; in_program = 1; break;
+            default: push_ok = 1; break;
+        }
+        if (!push_ok) goto done;
+
+        size_t n;
+        const uint32_t *children = component_children(store, c, &n);
+        for (size_t i = n; i-- > 0;) {
+            if (list_push(&stack, children[i] << 1 | (uint32_t)in_program) != 0) goto done;
+        }
+    }
+    ok = 1;
+done:
+    free(stack.items);
+    return ok ? 0 : -1;
+}
+
+static void free_sections(Sections *s) {
+    free(s->datatypes.items);
+    free(s->modules.items);
+    free(s->tags.items);
+    free(s->programs.items);
+}
+
+static void write_header(XmlWriter *w, const ComponentStore *store, const L5xOptions *options,
+                         const Sections *s) {
+    const char *revision = options && options->software_revision ? options->software_revision : "34.01";
+    const char *name = options ? options->controller_name : NULL;
+    size_t name_len = name ? strlen(name) : 0;
+    if (!name && s->controller >= 0) {
+        const Component *controller = &store->items[s->controller];
+        name = component_str(store, controller->name);
+        name_len = controller->name.len;
+    }
+    if (!name || !name_len) {
+        name = "Controller";
+        name_len = strlen(name);
+    }
+
+    char date[64];
+    const char *export_date = options ? options->export_date : NULL;
+    if (!export_date) {
+        time_t now = time(NULL);
+        strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y", localtime(&now));
+        export_date = date;
+    }
+
+    // "34.01" -> MajorRev 34, MinorRev 01
+    char major[16] = "34", minor[16] = "01";
+    const char *dot = strchr(revision, '.');
+    if (dot && (size_t)(dot - revision) < sizeof(major) && strlen(dot + 1) < sizeof(minor)) {
+        memcpy(major, revision, (size_t)(dot - revision));
+        major[dot - revision] = '\0';
+        strcpy(minor, dot + 1);
+    }
+
+    xml_puts(w, "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n");
+    xml_puts(w, "<RSLogix5000Content SchemaRevision=\"1.0\"");
+    xml_attr(w, "SoftwareRevision", revision, strlen(revision));
+    xml_attr(w, "TargetName", name, name_len);
+    xml_puts(w, " TargetType=\"Controller\" ContainsContext=\"true\" Owner=\"ACD Parser\"");
+    xml_attr(w, "ExportDate", export_date, strlen(export_date));
+    xml_puts(w, ">\n");
+
+    xml_puts(w, "  <Controller Use=\"Target\"");
+    xml_attr(w, "Name", name, name_len);
+    xml_attr(w, "MajorRev", major, strlen(major));
+    xml_attr(w, "MinorRev", minor, strlen(minor));
+    xml_puts(w, ">\n");
+}
+
+// Per-thread walk state
+typedef struct {
+    IndexList stack;
+    IndexList items;
+    IndexList rungs;
+} Scratch;
+
+static void free_scratch(Scratch *scratch) {
+    free(scratch->stack.items);
+    free(scratch->items.items);
+    free(scratch->rungs.items);
+}
+
+// Sections in schema order: DataTypes, Modules, controller Tags, then
+// one per program
+#define FIXED_SECTIONS 3
+
+static int write_section(XmlWriter *w, const ComponentStore *store, const uint8_t *kinds,
+                         const Sections *s, size_t section, Scratch *scratch) {
+    switch (section) {
+        case 0:
+            xml_puts(w, "    <DataTypes>\n");
+            for (size_t i = 0; i < s->datatypes.count; i++) {
+                xml_puts(w, "      <DataType");
+                write_name_attr(w, store, s->datatypes.items[i]);
+                xml_puts(w, " Family=\"NoFamily\" Class=\"User\"/>\n");
+            }
+            xml_puts(w, "    </DataTypes>\n");
+            return 0;
+        case 1:
+            xml_puts(w, "    <Modules>\n");
+            for (size_t i = 0; i < s->modules.count; i++) {
+                xml_puts(w, "      <Module");
+                write_name_attr(w, store, s->modules.items[i]);
+                xml_puts(w, "/>\n");
+            }
+            xml_puts(w, "    </Modules>\n");
+            return 0;
+        case 2:
+            xml_puts(w, "    <Tags>\n");
+            for (size_t i = 0; i < s->tags.count; i++) {
+                write_tag(w, store, s->tags.items[i], "      ");
+            }
+            xml_puts(w, "    </Tags>\n");
+            return 0;
+        default:
+            return write_program(w, store, kinds, s->logic, s->programs.items[section - FIXED_SECTIONS],
+                                 &scratch->stack, &scratch->items, &scratch->rungs);
+    }
+}
+
+// Shared state for rendering sections on the pool
+typedef struct {
+    const ComponentStore *store;
+    const uint8_t *kinds;
+    const Sections *sections;
+    XmlWriter *parts;
+    Scratch *scratch;            // One per worker
+    int *failed;                 // One per section
+} SectionJob;
+
+static void section_task(void *arg, size_t index, int worker) {
+    SectionJob *job = arg;
+    XmlWriter *part = &job->parts[index];
+    if (xml_writer_init(part, NULL, 64 * 1024) != 0 ||
+        write_section(part, job->store, job->kinds, job->sections, index, &job->scratch[worker]) != 0 ||
+        part->error) {
+        job->failed[index] = 1;
+    }
+}
+
+// Render every section into its own buffer on the pool and append them in
+// order; the bytes are the same as writing them one after another
+static int write_sections_parallel(XmlWriter *w, const ComponentStore *store, const uint8_t *kinds,
+                                   const Sections *s, size_t count, int jobs) {
+    ThreadPool *pool = acd_pool_create(jobs < (int)count ? jobs : (int)count);
+    if (!pool) {
+        return -1;
+    }
+    int workers = acd_pool_size(pool);
+    XmlWriter *parts = calloc(count, sizeof(*parts));
+    Scratch *scratch = calloc((size_t)workers, sizeof(*scratch));
+    int *failed = calloc(count, sizeof(*failed));
+    int ret = -1;
+
+    if (parts && scratch && failed) {
+        SectionJob job = { store, kinds, s, parts, scratch, failed };
+        acd_pool_run(pool, count, section_task, &job);
+
+        ret = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (failed[i]) ret = -1;
+            if (ret == 0) {
+                if (i == FIXED_SECTIONS) xml_puts(w, "    <Programs>\n");
+                xml_append(w, &parts[i]);
+            }
+        }
+        if (ret == 0 && count == FIXED_SECTIONS) xml_puts(w, "    <Programs>\n");
+    }
+
+    acd_pool_destroy(pool);
+    for (size_t i = 0; parts && i < count; i++) {
+        xml_writer_close(&parts[i]);
+    }
+    for (int i = 0; scratch && i < workers; i++) {
+        free_scratch(&scratch[i]);
+    }
+    free(parts);
+    free(scratch);
+    free(failed);
+    return ret;
+}
+
+static int write_l5x(XmlWriter *w, const ComponentStore *store, const L5xOptions *options) {
+    uint8_t *kinds = malloc(store->count ? store->count : 1);
+    Sections s = {0};
+    Scratch scratch = {0};
+    int ret = -1;
+    // Section stacks pack an index and a flag into 32 bits
+    if (!kinds || store->count >= 0x80000000u) {
+        free(kinds);
+        return -1;
+    }
+    for (size_t i = 0; i < store->count; i++) {
+        kinds[i] = (uint8_t)acd_l5x_kind(store, &store->items[i]);
+    }
+    if (collect_sections(store, kinds, &s) != 0) {
+        goto done;
+    }
+    s.logic = options ? options->rungs : NULL;
+
+    write_header(w, store, options, &s);
+
+    size_t sections = FIXED_SECTIONS + s.programs.count;
+    int jobs = options ? options->jobs : 1;
+    if (jobs > 1 && sections > 1) {
+        if (write_sections_parallel(w, store, kinds, &s, sections, jobs) != 0) {
+            goto done;
+        }
+    } else {
+        for (size_t i = 0; i < sections; i++) {
+            if (i == FIXED_SECTIONS) xml_puts(w, "    <Programs>\n");
+            if (write_section(w, store, kinds, &s, i, &scratch) != 0) {
+                goto done;
+            }
+        }
+        if (sections == FIXED_SECTIONS) xml_puts(w, "    <Programs>\n");
+    }
+    xml_puts(w, "    </Programs>\n");
+
+    xml_puts(w, "  </Controller>\n");
+    xml_puts(w, "</RSLogix5000Content>\n");
+    ret = w->error ? -1 : 0;
+
+done:
+    free(kinds);
+    free_sections(&s);
+    free_scratch(&scratch);
+    return ret;
+}
+
+int acd_l5x_write(XmlWriter *w, const ComponentStore *store, const L5xOptions *options) {
+    uint64_t start = acd_now_ns();
+    unsigned long long before = xml_writer_total(w);
+    int ret = write_l5x(w, store, options);
+    acd_stat_time(&acd_stats.emit_ns, start);
+    acd_stat_add(&acd_stats.emit_bytes, xml_writer_total(w) - before);
+    return ret;
+}
+
+int generate_detailed_l5x(const ComponentStore *store, const L5xOptions *options,
+                          const char *output_file) {
+    FILE *f = fopen(output_file, "wb");
+    if (!f) {
+        perror("Failed to create L5X file");
+        return -1;
+    }
+
+    XmlWriter w;
+    int ret = xml_writer_init(&w, f, 0);
+    if (ret == 0) {
+        ret = acd_l5x_write(&w, store, options);
+    }
+    if (xml_writer_close(&w) != 0) ret = -1;
+    if (fclose(f) != 0) ret = -1;
+
+    if (ret != 0) {
+        fprintf(stderr, "Failed to write L5X file: %s\n", output_file);
+        return -1;
+    }
+    printf("\n✅ Generated detailed L5X: %s\n", output_file);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ACD_L5X_H
+#define ACD_L5X_H
+
+#include <stdio.h>
+
+#include "acd_store.h"
+#include "acd_header.h"
+#include "acd_xml.h"
+#include "acd_rll.h"
+
+// What an L5X element a component becomes, from its type string
+typedef enum {
+    L5X_NONE = 0,                // Untyped: not emitted, children still walked
+    L5X_CONTROLLER,
+    L5X_DATATYPE,
+    L5X_MODULE,
+    L5X_TAG,
+    L5X_PROGRAM,
+    L5X_ROUTINE,
+    L5X_RUNG
+} L5xKind;
+
+typedef struct {
+    const char *controller_name;     // NULL: a Controller component, else "Controller"
+    const char *software_revision;   // e.g. "34.01"; NULL = "34.01"
+    const char *export_date;         // NULL = now
+    int jobs;                        // > 1: render sections on this many threads
+    const RungTable *rungs;          // Decoded rung logic by rung UID; NULL = NOP(); rungs
+} L5xOptions;
+
+L5xKind acd_l5x_kind(const ComponentStore *store, const Component *comp);
+
+// Fill options from a parsed ACD text header (spans are copied into buf)
+void acd_l5x_options_from_header(L5xOptions *options, const ACD_Header *header,
+                                 char *buf, size_t buf_size);
+
+// Write the whole controller as L5X to w, walking the component tree
+// (store's index must be built): DataTypes, Modules, controller Tags, then
+// each Program with its Tags and Routines, Routines with their Rungs in
+// ordinal order, each rung's text from options->rungs (NOP(); for rungs
+// it lacks). With options->jobs > 1 each section (and each program) is
+// rendered into its own buffer on a thread pool and the buffers are
+// appended in schema order, giving byte-identical output. Returns 0, or -1
+// if the writer failed.
+int acd_l5x_write(XmlWriter *w, const ComponentStore *store, const L5xOptions *options);
+
+// Generate detailed L5X from extracted data
+int generate_detailed_l5x(const ComponentStore *store, const L5xOptions *options,
+                          const char *output_file);
+
+#endif
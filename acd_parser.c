@@ -2,188 +2,179 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-#include <zlib.h>
 
-#define BUFFER_SIZE 4096
-#define GZIP_MAGIC 0x8b1f
-
-// Structure to hold ACD file info
-typedef struct {
-    FILE *file;
-    long file_size;
-    char *header_text;
-    long binary_start;
-} ACD_File;
-
-// Structure for a compressed block
-typedef struct {
-    long offset;
-    uint32_t compressed_size;
-    uint32_t uncompressed_size;
-    unsigned char *data;
-} CompressedBlock;
+#include "acd_parser.h"
+#include "acd_header.h"
+#include "acd_scan.h"
+#include "acd_block.h"
+#include "acd_inflate.h"
+#include "acd_stats.h"
 
 // Read the text header
 int read_text_header(ACD_File *acd) {
-    char buffer[BUFFER_SIZE];
     int header_lines = 0;
     long pos = 0;
     
     printf("📖 Reading ACD text header...\n");
     
-    while (fgets(buffer, sizeof(buffer), acd->file)) {
-        // Check if we've hit binary data (non-printable characters)
-        int is_text = 1;
-        for (int i = 0; buffer[i] && buffer[i] != '\n'; i++) {
-            if ((unsigned char)buffer[i] < 0x20 && buffer[i] != '\r' && buffer[i] != '\n' && buffer[i] != '\t') {
-                is_text = 0;
-                break;
-            }
-        }
-        
-        if (!is_text) {
-            acd->binary_start = pos;
-            printf("✅ Found binary data start at offset: 0x%lx (%ld)\n", pos, pos);
-            break;
-        }
+    acd->binary_start = acd_find_binary_start(acd);
+    long header_end = acd->binary_start > 0 ? acd->binary_start : acd->file_size;
+    
+    while (pos < header_end) {
+        const unsigned char *line = acd->data + pos;
+        const unsigned char *nl = memchr(line, '\n', (size_t)(header_end - pos));
+        size_t len = nl ? (size_t)(nl - line) + 1 : (size_t)(header_end - pos);
         
         if (header_lines < 5) {
-            printf("   %s", buffer);
+            printf("   %.*s", (int)len, (const char *)line);
         }
         
-        pos = ftell(acd->file);
+        pos += (long)len;
         header_lines++;
     }
     
+    if (acd->binary_start > 0) {
+        printf("✅ Found binary data start at offset: 0x%lx (%ld)\n", acd->binary_start, acd->binary_start);
+    }
     printf("📊 Header lines: %d\n", header_lines);
+    
+    ACD_Header header;
+    if (acd_header_parse(acd, &header) == 0) {
+        if (header.name.len) {
+            printf("🏷️  Project: %.*s\n", (int)header.name.len, header.name.ptr);
+        }
+        if (header.revision.len) {
+            printf("🔖 Revision: %.*s\n", (int)header.revision.len, header.revision.ptr);
+        }
+        if (header.version.len) {
+            printf("🔖 Version: %.*s\n", (int)header.version.len, header.version.ptr);
+        }
+        printf("📋 Header entries: %zu (%zu save history)\n", header.count, header.history_count);
+        acd_header_free(&header);
+    }
     return 0;
 }
 
 // Search for GZIP compressed blocks
 int find_compressed_blocks(ACD_File *acd) {
-    fseek(acd->file, acd->binary_start, SEEK_SET);
-    
-    unsigned char buffer[BUFFER_SIZE];
-    long offset = acd->binary_start;
+    const unsigned char *region = acd->data + acd->binary_start;
+    size_t region_size = (size_t)(acd->file_size - acd->binary_start);
     int block_count = 0;
     
-    printf("\n🔍 Searching for compressed blocks...\n");
+    printf("\n🔍 Searching for compressed blocks (%s scanner, %s inflate)...\n",
+           acd_scan_impl(), acd_inflate_backend());
     
-    while (offset < acd->file_size - 2) {
-        fseek(acd->file, offset, SEEK_SET);
-        size_t bytes_read = fread(buffer, 1, BUFFER_SIZE, acd->file);
+    InflateContext ctx;
+    inflate_context_init(&ctx);
+    uint64_t start = acd_now_ns();
+    size_t pos = 0;
+    while ((pos = acd_scan_next_gzip(region, region_size, pos)) < region_size) {
+        long offset = acd->binary_start + (long)pos;
         
-        for (size_t i = 0; i < bytes_read - 10; i++) {
-            // Check for GZIP magic number (1F 8B)
-            if (buffer[i] == 0x1F && buffer[i+1] == 0x8B) {
-                long block_offset = offset + i;
-                
-                // Read GZIP header
-                unsigned char method = buffer[i+2];
-                unsigned char flags = buffer[i+3];
-                
-                printf("\n🗜️  Found GZIP block #%d at offset: 0x%lx\n", ++block_count, block_offset);
-                printf("   Compression method: %02x\n", method);
-                printf("   Flags: %02x\n", flags);
-                
-                // Try to decompress a small portion to verify
-                if (i + 100 < bytes_read) {
-                    unsigned char test_decomp[1024];
-                    z_stream strm = {0};
-                    strm.next_in = buffer + i;
-                    strm.avail_in = 100;
-                    strm.next_out = test_decomp;
-                    strm.avail_out = sizeof(test_decomp);
-                    
-                    if (inflateInit2(&strm, 16 + MAX_WBITS) == Z_OK) {
-                        int ret = inflate(&strm, Z_NO_FLUSH);
-                        if (ret == Z_OK || ret == Z_STREAM_END) {
-                            printf("   ✅ Valid GZIP data (decompressed %lu bytes)\n", strm.total_out);
-                        }
-                        inflateEnd(&strm);
-                    }
-                }
-                
-                if (block_count >= 10) {
-                    printf("\n... (showing first 10 blocks)\n");
-                    return block_count;
-                }
-            }
+        // Decode the member to find where it really ends; only members
+        // that decode are blocks (as in the index)
+        CompressedBlock block;
+        if (acd_block_probe_ctx(&ctx, acd, offset, &block) != 0) {
+            if (!acd_quiet) printf("   ⚠️  Candidate at 0x%lx rejected: not a complete GZIP member\n", offset);
+            pos++;
+            continue;
         }
         
-        offset += bytes_read - 10; // Overlap to catch boundaries
+        ++block_count;
+        if (!acd_quiet) {
+            printf("\n🗜️  Found GZIP block #%d at offset: 0x%lx\n", block_count, offset);
+            printf("   Compression method: %02x\n", region[pos + 2]);
+            printf("   Flags: %02x\n", region[pos + 3]);
+            printf("   ✅ Valid GZIP data (%u bytes → %u bytes, %s)\n",
+                   block.compressed_size, block.uncompressed_size, acd_block_kind_name(block.kind));
+        }
+        pos += block.compressed_size;
     }
     
+    acd_stat_add(&acd_stats.scan_ns, acd_now_ns() - start - ctx.probe_ns);
+    acd_stat_add(&acd_stats.scan_bytes, region_size);
+    inflate_context_end(&ctx);
     return block_count;
 }
 
+// List blocks found by the index (acd_index_blocks) without touching the
+// binary region
+int list_indexed_blocks(const CompressedBlock *blocks, size_t count) {
+    printf("\n⚡ Listing compressed blocks from index...\n");
+    
+    for (size_t i = 0; i < count && !acd_quiet; i++) {
+        const CompressedBlock *b = &blocks[i];
+        printf("\n🗜️  GZIP block #%zu at offset: 0x%lx\n", i + 1, b->offset);
+        printf("   Compressed: %u bytes, uncompressed: %u bytes\n", b->compressed_size, b->uncompressed_size);
+        printf("   CRC32: %08x, content: %s\n", b->crc32, acd_block_kind_name(b->kind));
+    }
+    return (int)count;
+}
+
+typedef struct {
+    const SignatureSet *sigs;
+    int block;                   // 0 for the raw binary region
+} SignatureReport;
+
+static void print_signature_hit(void *arg, int id, size_t offset) {
+    const SignatureReport *report = arg;
+    if (acd_quiet) {
+        return;
+    }
+    if (report->block) {
+        printf("   Found '%s' in block #%d at: 0x%zx\n",
+               acd_signatures_name(report->sigs, id), report->block, offset);
+    } else {
+        printf("   Found '%s' at offset: 0x%zx\n", acd_signatures_name(report->sigs, id), offset);
+    }
+}
+
 // Analyze the file structure
-void analyze_structure(ACD_File *acd) {
+void analyze_structure(ACD_File *acd, const SignatureSet *sigs) {
     printf("\n📊 Analyzing ACD file structure...\n");
     
-    // Look for specific patterns
-    fseek(acd->file, acd->binary_start, SEEK_SET);
-    
-    unsigned char buffer[4096];
-    fread(buffer, 1, sizeof(buffer), acd->file);
+    SignatureSet *defaults = NULL;
+    if (!sigs) {
+        sigs = defaults = acd_signatures_default();
+        if (!sigs) return;
+    }
     
-    // Look for database signatures
+    // One pass over the whole binary region for every signature
     printf("\n🔍 Looking for database signatures...\n");
     
-    for (int i = 0; i < sizeof(buffer) - 16; i++) {
-        // Check for "Comps" database
-        if (memcmp(buffer + i, "Comps", 5) == 0) {
-            printf("   Found 'Comps' at offset: 0x%lx\n", acd->binary_start + i);
-        }
-        // Check for "Controller" 
-        if (memcmp(buffer + i, "Controller", 10) == 0) {
-            printf("   Found 'Controller' at offset: 0x%lx\n", acd->binary_start + i);
-        }
-        // Check for XML signatures
-        if (memcmp(buffer + i, "<?xml", 5) == 0) {
-            printf("   Found XML at offset: 0x%lx\n", acd->binary_start + i);
-        }
-    }
+    SignatureReport report = { sigs, 0 };
+    size_t hits = acd_signatures_scan(sigs, acd->data + acd->binary_start,
+                                      (size_t)(acd->file_size - acd->binary_start),
+                                      (size_t)acd->binary_start, print_signature_hit, &report);
+    printf("   %zu signature hits in the binary region\n", hits);
+    
+    acd_signatures_destroy(defaults);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Usage: %s <acd_file>\n", argv[0]);
-        return 1;
+// Search every decompressed block for signatures (offsets within the block)
+void analyze_blocks(ACD_File *acd, const CompressedBlock *known, size_t known_count,
+                    const SignatureSet *sigs) {
+    printf("\n🔍 Looking for signatures in decompressed blocks...\n");
+    
+    SignatureSet *defaults = NULL;
+    if (!sigs) {
+        sigs = defaults = acd_signatures_default();
+        if (!sigs) return;
     }
     
-    ACD_File acd = {0};
-    
-    printf("🚀 ACD Binary Parser v1.0\n");
-    printf("========================\n\n");
-    
-    // Open file
-    acd.file = fopen(argv[1], "rb");
-    if (!acd.file) {
-        perror("Failed to open file");
-        return 1;
+    BlockIter it;
+    const CompressedBlock *block;
+    size_t hits = 0;
+    acd_block_iter_open(&it, acd, known, known_count);
+    while (acd_block_iter_next(&it, &block) > 0) {
+        if (!block->data) continue;
+        SignatureReport report = { sigs, it.number };
+        hits += acd_signatures_scan(sigs, block->data, block->uncompressed_size, 0,
+                                    print_signature_hit, &report);
     }
+    int blocks = it.number;
+    acd_block_iter_close(&it);
+    printf("   %zu signature hits in %d blocks\n", hits, blocks);
     
-    // Get file size
-    fseek(acd.file, 0, SEEK_END);
-    acd.file_size = ftell(acd.file);
-    rewind(acd.file);
-    
-    printf("📄 File: %s\n", argv[1]);
-    printf("📏 Size: %.2f MB (%ld bytes)\n\n", acd.file_size / (1024.0 * 1024.0), acd.file_size);
-    
-    // Read header
-    read_text_header(&acd);
-    
-    // Find compressed blocks
-    int blocks = find_compressed_blocks(&acd);
-    printf("\n📦 Total compressed blocks found: %d\n", blocks);
-    
-    // Analyze structure
-    analyze_structure(&acd);
-    
-    fclose(acd.file);
-    
-    printf("\n✅ Analysis complete!\n");
-    return 0;
-} 
\ No newline at end of file
+    acd_signatures_destroy(defaults);
+}
@@ -0,0 +1,27 @@
+#ifndef ACD_PARSER_H
+#define ACD_PARSER_H
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_signatures.h"
+
+// Print the text header and set acd->binary_start
+int read_text_header(ACD_File *acd);
+
+// Scan the binary region and print each gzip member that decodes;
+// returns the number of members (rejected candidates are not counted)
+int find_compressed_blocks(ACD_File *acd);
+
+// Print the members of a block index (from acd_index_blocks); returns
+// the count
+int list_indexed_blocks(const CompressedBlock *blocks, size_t count);
+
+// Print every signature hit in the binary region (sigs NULL = defaults)
+void analyze_structure(ACD_File *acd, const SignatureSet *sigs);
+
+// Print every signature hit inside each decompressed block; known may be
+// NULL to scan for the blocks
+void analyze_blocks(ACD_File *acd, const CompressedBlock *known, size_t known_count,
+                    const SignatureSet *sigs);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "acd_pipeline.h"
+#include "acd_index.h"
+
+#define DEFAULT_WINDOW 4096
+
+static size_t route_window(const BlockRoute *route) {
+    return route->window ? route->window : DEFAULT_WINDOW;
+}
+
+static int head_has(const unsigned char *data, size_t len, const char *signature) {
+    size_t n = strlen(signature);
+    if (!n) {
+        return 1;
+    }
+    const unsigned char *p = data;
+    const unsigned char *end = data + len;
+    while ((size_t)(end - p) >= n) {
+        p = memchr(p, (unsigned char)signature[0], (size_t)(end - p) - n + 1);
+        if (!p) break;
+        if (memcmp(p, signature, n) == 0) {
+            return 1;
+        }
+        p++;
+    }
+    return 0;
+}
+
+static const BlockRoute *match_route(const BlockRoute *routes, size_t route_count,
+                                     const unsigned char *head, size_t len) {
+    for (size_t r = 0; r < route_count; r++) {
+        size_t window = route_window(&routes[r]);
+        if (head_has(head, len < window ? len : window, routes[r].signature)) {
+            return &routes[r];
+        }
+    }
+    return NULL;
+}
+
+int acd_pipeline_run(const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                     const BlockRoute *routes, size_t route_count, PipelineStats *stats) {
+    return acd_pipeline_run_cached(acd, blocks, count, routes, route_count, NULL, stats);
+}
+
+int acd_pipeline_run_cached(const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                            const BlockRoute *routes, size_t route_count, BlockCache *cache,
+                            PipelineStats *stats) {
+    PipelineStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+
+    // Without a block list, find the members first (bounded memory probe)
+    CompressedBlock *found = NULL;
+    if (!blocks) {
+        if (acd_index_build(acd, &found, &count) != 0) {
+            return -1;
+        }
+        blocks = found;
+    }
+
+    size_t head = 0;
+    for (size_t r = 0; r < route_count; r++) {
+        if (route_window(&routes[r]) > head) head = route_window(&routes[r]);
+    }
+
+    InflateContext *ctx = inflate_context_acquire();
+    if (!ctx) {
+        free(found);
+        return -1;
+    }
+    unsigned char *buffer = NULL;
+    size_t capacity = 0;
+    int status = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        CompressedBlock block = blocks[i];
+        block.data = NULL;
+        stats->blocks++;
+
+        // A cached block is routed from its mapping without inflating
+        BlockCacheKey key;
+        int keyed = cache && acd_block_cache_key(acd, &block, &key) == 0;
+        ACD_File cached;
+        if (keyed && acd_block_cache_get(cache, &key, &cached) == 0) {
+            stats->cache_hits++;
+            const BlockRoute *route = match_route(routes, route_count, cached.data, (size_t)cached.file_size);
+            if (route) {
+                block.data = (unsigned char *)cached.data;
+                route->handler(&block, cached.data, (size_t)cached.file_size, route->ctx);
+                stats->routed++;
+            } else {
+                stats->skipped++;
+            }
+            acd_file_close(&cached);
+            continue;
+        }
+
+        int ret = acd_block_inflate_begin(ctx, acd, &block);
+        if (ret == Z_OK) {
+            ret = acd_block_inflate_until(ctx, acd, &block, &buffer, &capacity, head);
+        }
+        if (ret == Z_MEM_ERROR) {
+            status = -1;
+            break;
+        }
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            stats->failed++;
+            continue;
+        }
+
+        const BlockRoute *route = match_route(routes, route_count, buffer, ctx->strm.total_out);
+        if (!route) {
+            stats->skipped++;
+            stats->bytes_inflated += ctx->strm.total_out;
+            continue;
+        }
+
+        if (ret == Z_OK) {
+            ret = acd_block_inflate_until(ctx, acd, &block, &buffer, &capacity, SIZE_MAX);
+        }
+        stats->bytes_inflated += ctx->strm.total_out;
+        if (ret == Z_MEM_ERROR) {
+            status = -1;
+            break;
+        }
+        if (ret != Z_STREAM_END) {
+            stats->failed++;
+            continue;
+        }
+
+        if (keyed) {
+            acd_block_cache_put(cache, &key, buffer, block.uncompressed_size);
+        }
+        block.data = buffer;
+        route->handler(&block, buffer, block.uncompressed_size, route->ctx);
+        stats->routed++;
+    }
+
+    inflate_context_release(ctx);
+    free(buffer);
+    free(found);
+    return status;
+}
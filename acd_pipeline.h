@@ -0,0 +1,50 @@
+#ifndef ACD_PIPELINE_H
+#define ACD_PIPELINE_H
+
+#include <stddef.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_blockcache.h"
+
+// In-memory block pipeline: each member's head is inflated and matched
+// against a table of database signatures; a matching block is inflated
+// the rest of the way into one reused buffer and handed to its parser,
+// anything else is dropped after the head. Nothing touches the filesystem
+// and memory stays at the largest routed block.
+
+// Parser for a routed block; data is valid only for the call
+typedef int (*acd_block_handler)(const CompressedBlock *block, const unsigned char *data,
+                                 size_t size, void *ctx);
+
+typedef struct {
+    const char *name;
+    const char *signature;       // Bytes to look for (NUL-terminated; "" = every block)
+    size_t window;               // Search the first window bytes (0 = 4 KB)
+    acd_block_handler handler;
+    void *ctx;
+} BlockRoute;
+
+typedef struct {
+    size_t blocks;
+    size_t routed;
+    size_t skipped;              // No signature in the head; rest not inflated
+    size_t failed;               // Corrupt or truncated members
+    size_t bytes_inflated;
+    size_t cache_hits;           // Blocks read from the block cache
+} PipelineStats;
+
+// Route every block of acd (blocks may be NULL to scan for them) through
+// routes, first match wins. stats may be NULL. Returns 0, or -1 on
+// allocation failure.
+int acd_pipeline_run(const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                     const BlockRoute *routes, size_t route_count, PipelineStats *stats);
+
+// acd_pipeline_run with a block cache: a cached block is routed and parsed
+// straight from its mapping, and routed blocks that had to be inflated are
+// added to the cache. cache NULL is acd_pipeline_run.
+int acd_pipeline_run_cached(const ACD_File *acd, const CompressedBlock *blocks, size_t count,
+                            const BlockRoute *routes, size_t route_count, BlockCache *cache,
+                            PipelineStats *stats);
+
+#endif
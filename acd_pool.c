@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "acd_pool.h"
+
+// A worker's remaining task range [lo, hi) packed into one word so the
+// owner's pop and a thief's split are both a single CAS
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];  // Keep each range on its own cache line
+} WorkerRange;
+
+#define RANGE_PACK(lo, hi) (((uint64_t)(hi) << 32) | (uint32_t)(lo))
+#define RANGE_LO(r) ((uint32_t)(r))
+#define RANGE_HI(r) ((uint32_t)((r) >> 32))
+
+// Largest batch handed out per run; ranges are 32-bit
+#define MAX_BATCH 0xFFFFFFFFu
+
+typedef struct {
+    ThreadPool *pool;
+    int id;
+} WorkerArg;
+
+struct ThreadPool {
+    int workers;
+    pthread_t *threads;
+    WorkerArg *args;
+    WorkerRange *ranges;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned long generation;
+    int active;
+    int shutdown;
+
+    acd_task_fn fn;
+    void *ctx;
+    size_t base;
+};
+
+int acd_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static int pop_task(WorkerRange *own, uint32_t *index) {
+    uint64_t r = atomic_load(&own->range);
+    while (RANGE_LO(r) < RANGE_HI(r)) {
+        if (atomic_compare_exchange_weak(&own->range, &r, RANGE_PACK(RANGE_LO(r) + 1, RANGE_HI(r)))) {
+            *index = RANGE_LO(r);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Take the upper half of the fullest other range into our own (empty) one
+static int steal_tasks(ThreadPool *pool, int self) {
+    for (;;) {
+        int victim = -1;
+        uint32_t best = 0;
+        uint64_t seen = 0;
+        for (int w = 0; w < pool->workers; w++) {
+            if (w == self) continue;
+            uint64_t r = atomic_load(&pool->ranges[w].range);
+            uint32_t left = RANGE_HI(r) - RANGE_LO(r);
+            if (RANGE_LO(r) < RANGE_HI(r) && left > best) {
+                best = left;
+                victim = w;
+                seen = r;
+            }
+        }
+        if (victim < 0) {
+            return 0;
+        }
+
+        uint32_t lo = RANGE_LO(seen), hi = RANGE_HI(seen);
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (atomic_compare_exchange_strong(&pool->ranges[victim].range, &seen, RANGE_PACK(lo, mid))) {
+            atomic_store(&pool->ranges[self].range, RANGE_PACK(mid, hi));
+            return 1;
+        }
+        // Lost a race with the owner or another thief; look again
+    }
+}
+
+static void *worker_main(void *arg) {
+    WorkerArg *wa = arg;
+    ThreadPool *pool = wa->pool;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        acd_task_fn fn = pool->fn;
+        void *ctx = pool->ctx;
+        size_t base = pool->base;
+        pthread_mutex_unlock(&pool->lock);
+
+        WorkerRange *own = &pool->ranges[wa->id];
+        uint32_t index;
+        do {
+            while (pop_task(own, &index)) {
+                fn(ctx, base + index, wa->id);
+            }
+        } while (steal_tasks(pool, wa->id));
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+ThreadPool *acd_pool_create(int workers) {
+    if (workers <= 0) {
+        workers = acd_cpu_count();
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = calloc((size_t)workers, sizeof(*pool->threads));
+    pool->args = calloc((size_t)workers, sizeof(*pool->args));
+    pool->ranges = calloc((size_t)workers, sizeof(*pool->ranges));
+    if (!pool->threads || !pool->args || !pool->ranges) {
+        free(pool->threads);
+        free(pool->args);
+        free(pool->ranges);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (int w = 0; w < workers; w++) {
+        pool->args[w].pool = pool;
+        pool->args[w].id = w;
+        if (pthread_create(&pool->threads[w], NULL, worker_main, &pool->args[w]) != 0) {
+            break;
+        }
+        pool->workers++;
+    }
+
+    if (pool->workers == 0) {
+        acd_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int acd_pool_size(const ThreadPool *pool) {
+    return pool->workers;
+}
+
+void acd_pool_run(ThreadPool *pool, size_t count, acd_task_fn fn, void *ctx) {
+    for (size_t base = 0; base < count; base += MAX_BATCH) {
+        size_t batch = count - base < MAX_BATCH ? count - base : MAX_BATCH;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->fn = fn;
+        pool->ctx = ctx;
+        pool->base = base;
+
+        // Contiguous split; stealing evens out whatever this gets wrong
+        size_t per = batch / (size_t)pool->workers;
+        size_t extra = batch % (size_t)pool->workers;
+        size_t lo = 0;
+        for (int w = 0; w < pool->workers; w++) {
+            size_t n = per + ((size_t)w < extra ? 1 : 0);
+            atomic_store(&pool->ranges[w].range, RANGE_PACK(lo, lo + n));
+            lo += n;
+        }
+
+        pool->active = pool->workers;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->start);
+        while (pool->active > 0) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void acd_pool_destroy(ThreadPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int w = 0; w < pool->workers; w++) {
+        pthread_join(pool->threads[w], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->args);
+    free(pool->ranges);
+    free(pool);
+}
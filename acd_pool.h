@@ -0,0 +1,30 @@
+#ifndef ACD_POOL_H
+#define ACD_POOL_H
+
+#include <stddef.h>
+
+// Work-stealing thread pool for independent, uneven tasks (gzip members,
+// L5X sections, routines). Each run splits [0, count) into one contiguous
+// range per worker; a worker that drains its range steals half of the
+// largest remaining one, so a few huge blocks don't serialize the run.
+typedef struct ThreadPool ThreadPool;
+
+// Task body: index is the task number, worker is 0..workers-1 and can be
+// used to pick per-thread state (e.g. a reusable z_stream)
+typedef void (*acd_task_fn)(void *ctx, size_t index, int worker);
+
+// Start a pool with the given number of worker threads (<= 0 means one
+// per online CPU). Returns NULL on failure.
+ThreadPool *acd_pool_create(int workers);
+
+int acd_pool_size(const ThreadPool *pool);
+
+// Run fn for every index in [0, count) and wait for all of them to finish
+void acd_pool_run(ThreadPool *pool, size_t count, acd_task_fn fn, void *ctx);
+
+void acd_pool_destroy(ThreadPool *pool);
+
+// Number of online CPUs (at least 1)
+int acd_cpu_count(void);
+
+#endif
@@ -6,7 +6,6 @@ Tools for analyzing and understanding the ACD binary format
 
 import os
 import sys
-import gzip
 import struct
 import hashlib
 import difflib
@@ -14,6 +13,8 @@ from pathlib import Path
 from typing import Dict, List, Tuple, Optional
 import json
 
+from acd_gzip_members import gzip_members
+
 class ACDAnalyzer:
     """Comprehensive ACD file analyzer for reverse engineering"""
     
@@ -43,87 +44,20 @@ class ACDAnalyzer:
     def find_gzip_blocks(self):
         """Find all GZIP compressed blocks"""
         self.gzip_blocks = []
-        offset = self.binary_offset
         
-        while offset < len(self.data):
-            # Look for GZIP magic bytes (1F 8B)
-            pos = self.data.find(b'\x1F\x8B', offset)
-            if pos == -1:
-                break
-            
-            print(f"🔍 Found GZIP header at 0x{pos:X}")
-            
-            # Try to decompress to verify it's valid GZIP
-            # For large blocks, we need to be smarter about finding the end
-            found = False
-            
-            # Try common block sizes first
-            test_sizes = [1000, 10000, 100000, 1000000, 10000000, 20000000]
-            
-            for test_size in test_sizes:
-                if pos + test_size > len(self.data):
-                    test_size = len(self.data) - pos
-                
-                try:
-                    # Try to decompress
-                    test_data = self.data[pos:pos + test_size]
-                    decompressed = gzip.decompress(test_data)
-                    
-                    # If successful, we found a valid GZIP block
-                    self.gzip_blocks.append({
-                        'index': len(self.gzip_blocks),
-                        'offset': pos,
-                        'compressed_size': test_size,
-                        'decompressed_size': len(decompressed),
-                        'data': decompressed[:1000]  # Store only first 1KB for analysis
-                    })
-                    print(f"✅ Block {len(self.gzip_blocks)-1}: offset=0x{pos:X}, "
-                          f"compressed={test_size:,}, decompressed={len(decompressed):,}")
-                    offset = pos + test_size
-                    found = True
-                    break
-                except gzip.BadGzipFile:
-                    continue
-                except Exception as e:
-                    continue
-            
-            if not found:
-                # Try to find exact size by looking for the end marker
-                # GZIP ends with CRC32 (4 bytes) + uncompressed size (4 bytes)
-                try:
-                    # Read GZIP header to get more info
-                    header = self.data[pos:pos+10]
-                    if len(header) >= 10:
-                        flags = header[3]
-                        # Skip past header and any extra fields
-                        current = pos + 10
-                        
-                        # Try progressively larger chunks
-                        for chunk_size in range(100, min(20000000, len(self.data) - pos), 10000):
-                            try:
-                                test_data = self.data[pos:pos + chunk_size]
-                                decompressed = gzip.decompress(test_data)
-                                
-                                self.gzip_blocks.append({
-                                    'index': len(self.gzip_blocks),
-                                    'offset': pos,
-                                    'compressed_size': chunk_size,
-                                    'decompressed_size': len(decompressed),
-                                    'data': decompressed[:1000]
-                                })
-                                print(f"✅ Block {len(self.gzip_blocks)-1}: offset=0x{pos:X}, "
-                                      f"compressed={chunk_size:,}, decompressed={len(decompressed):,}")
-                                offset = pos + chunk_size
-                                found = True
-                                break
-                            except:
-                                continue
-                except:
-                    pass
-            
-            if not found:
-                print(f"⚠️  Could not determine size of GZIP block at 0x{pos:X}")
-                offset = pos + 2
+        # One pass: every member is decompressed once, its end taken from
+        # the stream rather than found by retrying larger slices
+        for pos, compressed_size, decompressed in gzip_members(self.filepath, self.data,
+                                                               self.binary_offset):
+            self.gzip_blocks.append({
+                'index': len(self.gzip_blocks),
+                'offset': pos,
+                'compressed_size': compressed_size,
+                'decompressed_size': len(decompressed),
+                'data': bytes(decompressed[:1000])  # Store only first 1KB for analysis
+            })
+            print(f"✅ Block {len(self.gzip_blocks)-1}: offset=0x{pos:X}, "
+                  f"compressed={compressed_size:,}, decompressed={len(decompressed):,}")
         
         print(f"\n📊 Found {len(self.gzip_blocks)} GZIP blocks total")
         return self.gzip_blocks
@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_rll.h"
+#include "acd_comps.h"
+#include "acd_pipeline.h"
+#include "acd_pool.h"
+#include "acd_stats.h"
+
+typedef struct {
+    const char *mnemonic;        // NULL: not an opcode
+    uint8_t len;
+    uint8_t operands;
+    char punct;                  // Branch opcodes: the character they emit
+} RllOpcode;
+
+// One entry per byte, filled in from ACD_RLL_INSTRUCTIONS at compile time
+#define RLL_OPCODE_ENTRY(code, name, n) [code] = { #name, sizeof(#name) - 1, n, 0 },
+static const RllOpcode opcodes[256] = {
+    ACD_RLL_INSTRUCTIONS(RLL_OPCODE_ENTRY)
+    [RLL_BRANCH_START] = { "BST", 3, 0, '[' },
+    [RLL_BRANCH_NEXT] = { "NXB", 3, 0, ',' },
+    [RLL_BRANCH_END] = { "BND", 3, 0, ']' },
+};
+#undef RLL_OPCODE_ENTRY
+
+const char *rll_mnemonic(unsigned char opcode) {
+    return opcodes[opcode].punct ? NULL : opcodes[opcode].mnemonic;
+}
+
+static uint32_t read_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Shortest %g spelling that reads back as the same float
+static int format_real(char *out, size_t size, float value) {
+    int n = 0;
+    for (int precision = 6; precision <= 9; precision++) {
+        n = snprintf(out, size, "%.*g", precision, (double)value);
+        if (strtof(out, NULL) == value) break;
+    }
+    return n;
+}
+
+// Append one operand at code[*pos] to out; returns the new length, or -1
+static long decode_operand(const unsigned char *code, size_t len, size_t *pos, char *out, long n) {
+    size_t p = *pos;
+    if (p >= len) return -1;
+    unsigned char kind = code[p++];
+    char number[32];
+    int m;
+    switch (kind) {
+        case RLL_OPERAND_TEXT:
+            if (p >= len || len - p - 1 < code[p]) return -1;
+            memcpy(out + n, code + p + 1, code[p]);
+            n += code[p];
+            p += 1 + (size_t)code[p];
+            break;
+        case RLL_OPERAND_INT:
+        case RLL_OPERAND_REAL:
+            if (len - p < 4) return -1;
+            if (kind == RLL_OPERAND_INT) {
+                m = snprintf(number, sizeof(number), "%ld", (long)(int32_t)read_u32(code + p));
+            } else {
+                uint32_t bits = read_u32(code + p);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                m = format_real(number, sizeof(number), value);
+            }
+            memcpy(out + n, number, (size_t)m);
+            n += m;
+            p += 4;
+            break;
+        default:
+            return -1;
+    }
+    *pos = p;
+    return n;
+}
+
+long rll_decode_rung(const unsigned char *code, size_t len, char *out) {
+    long n = 0;
+    int depth = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        const RllOpcode *op = &opcodes[code[pos++]];
+        if (!op->mnemonic) {
+            return -1;
+        }
+        if (op->punct) {
+            // NXB and BND only inside a branch
+            if (op->punct != '[' && depth == 0) return -1;
+            depth += op->punct == '[' ? 1 : op->punct == ']' ? -1 : 0;
+            out[n++] = op->punct;
+            continue;
+        }
+        memcpy(out + n, op->mnemonic, op->len);
+        n += op->len;
+        out[n++] = '(';
+        for (int i = 0; i < op->operands; i++) {
+            if (i) out[n++] = ',';
+            n = decode_operand(code, len, &pos, out, n);
+            if (n < 0) return -1;
+        }
+        out[n++] = ')';
+    }
+    if (depth != 0) {
+        return -1;
+    }
+    out[n++] = ';';
+    out[n] = '\0';
+    return n;
+}
+
+int rung_table_init(RungTable *table) {
+    memset(table, 0, sizeof(*table));
+    return 0;
+}
+
+void rung_table_free(RungTable *table) {
+    free(table->uid);
+    free(table->routine);
+    free(table->text);
+    free(table->text_len);
+    free(table->text_data);
+    free(table->uid_slots);
+    memset(table, 0, sizeof(*table));
+}
+
+// Grow one column to capacity elements of size bytes
+static int grow_column(void **column, size_t capacity, size_t size) {
+    void *grown = realloc(*column, capacity * size);
+    if (!grown) {
+        return -1;
+    }
+    *column = grown;
+    return 0;
+}
+
+static int rung_table_reserve(RungTable *table, size_t n) {
+    if (table->capacity - table->count >= n) {
+        return 0;
+    }
+    size_t capacity = table->capacity ? table->capacity : 1024;
+    while (capacity - table->count < n) capacity *= 2;
+    if (grow_column((void **)&table->uid, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->routine, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->text, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->text_len, capacity, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+    table->capacity = capacity;
+    return 0;
+}
+
+static int reserve_text(RungTable *table, size_t n) {
+    if (table->text_capacity - table->text_size >= n) {
+        return 0;
+    }
+    size_t capacity = table->text_capacity ? table->text_capacity : 64 * 1024;
+    while (capacity - table->text_size < n) capacity *= 2;
+    if (capacity > UINT32_MAX || grow_column((void **)&table->text_data, capacity, 1) != 0) {
+        return -1;
+    }
+    table->text_capacity = capacity;
+    return 0;
+}
+
+static uint32_t hash_uid(uint32_t uid) {
+    return uid * 2654435761u;
+}
+
+static int build_uid_index(RungTable *table) {
+    size_t count = 64;
+    while (count < table->count * 2) count *= 2;
+    uint32_t *slots = calloc(count, sizeof(*slots));
+    if (!slots) {
+        return -1;
+    }
+    for (size_t i = 0; i < table->count; i++) {
+        size_t j = hash_uid(table->uid[i]) & (count - 1);
+        while (slots[j] && table->uid[slots[j] - 1] != table->uid[i]) j = (j + 1) & (count - 1);
+        if (!slots[j]) slots[j] = (uint32_t)i + 1;
+    }
+    free(table->uid_slots);
+    table->uid_slots = slots;
+    table->uid_slot_count = count;
+    return 0;
+}
+
+long rung_table_find(const RungTable *table, uint32_t uid) {
+    if (!table->uid_slot_count) {
+        return -1;
+    }
+    size_t mask = table->uid_slot_count - 1;
+    for (size_t j = hash_uid(uid) & mask; table->uid_slots[j]; j = (j + 1) & mask) {
+        if (table->uid[table->uid_slots[j] - 1] == uid) return (long)table->uid_slots[j] - 1;
+    }
+    return -1;
+}
+
+typedef enum {
+    RUNG_FIELD_SKIP = 0,
+    RUNG_FIELD_UID,
+    RUNG_FIELD_ROUTINE,
+    RUNG_FIELD_CODE
+} RungTarget;
+
+typedef enum {
+    RUNG_VALUE_STR8 = 0,
+    RUNG_VALUE_U32,
+    RUNG_VALUE_BLOB              // u32 length, bytes
+} RungValue;
+
+typedef struct {
+    RungValue value;
+    RungTarget target;
+} RungField;
+
+static int field_is(const char *name, size_t len, const char *want) {
+    return strlen(want) == len && memcmp(name, want, len) == 0;
+}
+
+static RungField rung_field(const char *name, size_t len) {
+    RungField field = { RUNG_VALUE_STR8, RUNG_FIELD_SKIP };
+    if ((len >= 3 && memcmp(name + len - 3, "UId", 3) == 0) || field_is(name, len, "Ordinal")) {
+        field.value = RUNG_VALUE_U32;
+    }
+    if (field_is(name, len, "RungUId") || field_is(name, len, "CompUId")) field.target = RUNG_FIELD_UID;
+    else if (field_is(name, len, "RoutineUId") || field_is(name, len, "ParentUId")) field.target = RUNG_FIELD_ROUTINE;
+    else if (field_is(name, len, "Code")) {
+        field.value = RUNG_VALUE_BLOB;
+        field.target = RUNG_FIELD_CODE;
+    }
+    return field;
+}
+
+// Where one record's code lies, and the order the rungs decode in
+typedef struct {
+    uint32_t uid;
+    uint32_t routine;
+    uint32_t code;               // Offset in the block
+    uint32_t code_len;
+    uint32_t row;                // Row in the table
+} RungRecord;
+
+// Locate the fields of the record at data[pos, end). Returns 0, or 1 if
+// it runs past end.
+static int locate_rung(const unsigned char *data, size_t pos, size_t end, const RungField *schema,
+                       int field_count, RungRecord *record) {
+    memset(record, 0, sizeof(*record));
+    for (int f = 0; f < field_count; f++) {
+        if (schema[f].value == RUNG_VALUE_STR8) {
+            if (end - pos < 1 || end - pos - 1 < data[pos]) return 1;
+            pos += 1 + (size_t)data[pos];
+            continue;
+        }
+        if (end - pos < 4) return 1;
+        uint32_t value = read_uint32_le(data, pos);
+        pos += 4;
+        if (schema[f].value == RUNG_VALUE_BLOB) {
+            if (end - pos < value) return 1;
+            record->code = (uint32_t)pos;
+            record->code_len = value;
+            pos += value;
+        } else if (schema[f].target == RUNG_FIELD_UID) {
+            record->uid = value;
+        } else if (schema[f].target == RUNG_FIELD_ROUTINE) {
+            record->routine = value;
+        }
+    }
+    return 0;
+}
+
+// Routine, then record order: rungs of a routine stay in sequence
+static int compare_records(const void *a, const void *b) {
+    const RungRecord *x = a, *y = b;
+    if (x->routine != y->routine) return x->routine < y->routine ? -1 : 1;
+    return x->row < y->row ? -1 : x->row > y->row;
+}
+
+// Per-worker output: texts of the rungs this worker decoded
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} RungScratch;
+
+// Where a rung's text ended up before the merge
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+    int32_t worker;              // -1: didn't decode
+} RungPlacement;
+
+typedef struct {
+    const unsigned char *data;
+    const RungRecord *records;   // Sorted by routine
+    const size_t *group_start;   // group_count + 1 entries
+    RungPlacement *placements;   // By row
+    RungScratch *scratch;        // One per worker
+} RungJob;
+
+static void decode_routine(void *arg, size_t group, int worker) {
+    RungJob *job = arg;
+    RungScratch *s = &job->scratch[worker];
+    for (size_t r = job->group_start[group]; r < job->group_start[group + 1]; r++) {
+        const RungRecord *record = &job->records[r];
+        RungPlacement *placement = &job->placements[record->row];
+        placement->worker = -1;
+        size_t bound = RLL_TEXT_BOUND(record->code_len);
+        if (s->capacity - s->size < bound) {
+            size_t capacity = s->capacity ? s->capacity : 64 * 1024;
+            while (capacity - s->size < bound) capacity *= 2;
+            char *grown = realloc(s->data, capacity);
+            if (!grown) {
+                s->failed = 1;
+                return;
+            }
+            s->data = grown;
+            s->capacity = capacity;
+        }
+        long n = rll_decode_rung(job->data + record->code, record->code_len, s->data + s->size);
+        if (n < 0) continue;
+        placement->offset = (uint32_t)s->size;
+        placement->len = (uint32_t)n;
+        placement->worker = worker;
+        s->size += (size_t)n + 1;
+    }
+}
+
+// Decode every record on the pool (or here), then append the texts to the
+// table in record order
+static long decode_rungs(RungTable *table, const unsigned char *data, RungRecord *records,
+                         size_t count, int jobs) {
+    qsort(records, count, sizeof(*records), compare_records);
+    size_t *group_start = malloc((count + 1) * sizeof(*group_start));
+    RungPlacement *placements = calloc(count ? count : 1, sizeof(*placements));
+    size_t groups = 0;
+    for (size_t r = 0; group_start && r < count; r++) {
+        if (r == 0 || records[r].routine != records[r - 1].routine) group_start[groups++] = r;
+    }
+    if (group_start) group_start[groups] = count;
+
+    ThreadPool *pool = NULL;
+    int workers = 1;
+    if (jobs > 1 && groups > 1) {
+        pool = acd_pool_create(jobs < (int)groups ? jobs : (int)groups);
+        if (pool) workers = acd_pool_size(pool);
+    }
+    RungScratch *scratch = calloc((size_t)workers, sizeof(*scratch));
+    long ret = -1;
+
+    if (group_start && placements && scratch) {
+        RungJob job = { data, records, group_start, placements, scratch };
+        if (pool) {
+            acd_pool_run(pool, groups, decode_routine, &job);
+        } else {
+            for (size_t g = 0; g < groups; g++) decode_routine(&job, g, 0);
+        }
+        ret = 0;
+        for (int w = 0; w < workers; w++) {
+            if (scratch[w].failed) ret = -1;
+        }
+    }
+
+    // Rows in table order; records are sorted, so map them back first
+    size_t base = table->count;
+    if (ret == 0 && rung_table_reserve(table, count) != 0) ret = -1;
+    for (size_t r = 0; ret == 0 && r < count; r++) {
+        size_t row = base + records[r].row;
+        table->uid[row] = records[r].uid;
+        table->routine[row] = records[r].routine;
+    }
+    for (size_t row = 0; ret == 0 && row < count; row++) {
+        const RungPlacement *p = &placements[row];
+        const char *text = p->worker >= 0 ? scratch[p->worker].data + p->offset : "NOP();";
+        size_t len = p->worker >= 0 ? p->len : 6;
+        if (reserve_text(table, len + 1) != 0) {
+            ret = -1;
+            break;
+        }
+        memcpy(table->text_data + table->text_size, text, len + 1);
+        table->text[base + row] = (uint32_t)table->text_size;
+        table->text_len[base + row] = (uint32_t)len;
+        table->text_size += len + 1;
+        if (p->worker < 0) table->bad++;
+    }
+    if (ret == 0) {
+        table->count += count;
+        ret = build_uid_index(table) == 0 ? (long)count : -1;
+    }
+
+    acd_pool_destroy(pool);
+    for (int w = 0; scratch && w < workers; w++) {
+        free(scratch[w].data);
+    }
+    free(scratch);
+    free(placements);
+    free(group_start);
+    return ret;
+}
+
+static long parse_rung_database(RungTable *table, const unsigned char *data, size_t size,
+                                size_t name_offset, int jobs) {
+    DatabaseHeader header;
+    if (read_database_header(data, size, name_offset, &header) != 0) {
+        return 0;
+    }
+    RungField schema[DATABASE_MAX_FIELDS];
+    int has_code = 0;
+    for (int f = 0; f < header.field_count; f++) {
+        schema[f] = rung_field(header.fields[f], header.field_lens[f]);
+        has_code |= schema[f].target == RUNG_FIELD_CODE;
+    }
+    if (!has_code) {
+        return 0;
+    }
+
+    uint32_t record_count = header.record_count;
+    size_t room = (size_t)(size - header.index_offset) / 4;
+    if (record_count > room) {
+        if (!acd_quiet) printf("   ⚠️  RungCode .idx claims %u records, only room for %zu\n", record_count, room);
+        record_count = (uint32_t)room;
+    }
+    RungRecord *records = malloc((record_count ? record_count : 1) * sizeof(*records));
+    if (!records) {
+        return -1;
+    }
+
+    size_t dat_end = (size_t)header.data_offset + header.record_size;
+    size_t count = 0;
+    int bad = 0;
+    for (uint32_t r = 0; r < record_count; r++) {
+        size_t record = header.data_offset + (size_t)read_uint32_le(data, header.index_offset + (size_t)r * 4);
+        if (record >= dat_end || locate_rung(data, record, dat_end, schema, header.field_count,
+                                             &records[count]) != 0) {
+            bad++;
+            continue;
+        }
+        records[count].row = (uint32_t)count;
+        count++;
+    }
+    if (bad && !acd_quiet) {
+        printf("   ⚠️  %d rung records out of bounds\n", bad);
+    }
+
+    long decoded = decode_rungs(table, data, records, count, jobs);
+    free(records);
+    return decoded;
+}
+
+long parse_rung_block(RungTable *table, const unsigned char *data, size_t size, int jobs) {
+    // "RungCode" with its NUL, after a path like Comps'
+    static const char name[] = "RungCode";
+    for (size_t i = 0; i + sizeof(name) <= size; i++) {
+        const unsigned char *p = memchr(data + i, 'R', size - i);
+        if (!p || (size_t)(p - data) + sizeof(name) > size) {
+            break;
+        }
+        i = (size_t)(p - data);
+        if (memcmp(p, name, sizeof(name)) != 0) {
+            continue;
+        }
+        uint64_t start = acd_now_ns();
+        long decoded = parse_rung_database(table, data, size, i, jobs);
+        acd_stat_time(&acd_stats.parse_ns, start);
+        if (decoded != 0) {
+            if (decoded > 0) acd_stat_add(&acd_stats.rungs, (uint64_t)decoded);
+            return decoded;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    RungTable *table;
+    int jobs;
+    long rungs;
+    int failed;
+} RungsParse;
+
+static int rungs_block_handler(const CompressedBlock *block, const unsigned char *data,
+                               size_t size, void *ctx) {
+    RungsParse *parse = ctx;
+    size_t bad = parse->table->bad;
+    long decoded = parse_rung_block(parse->table, data, size, parse->jobs);
+    if (decoded < 0) {
+        parse->failed = 1;
+        return -1;
+    }
+    if (decoded > 0 && !acd_quiet) {
+        printf("🪜 RungCode block at offset 0x%lx: %ld rungs", block->offset, decoded);
+        if (parse->table->bad > bad) printf(", %zu not decoded", parse->table->bad - bad);
+        printf("\n");
+    }
+    parse->rungs += decoded;
+    return 0;
+}
+
+long parse_acd_rungs(RungTable *table, const ACD_File *acd, const CompressedBlock *blocks,
+                     size_t count, int jobs) {
+    RungsParse parse = { .table = table, .jobs = jobs };
+    BlockRoute routes[] = {
+        { "rungs", "RungCode", 0, rungs_block_handler, &parse },
+    };
+    if (acd_pipeline_run(acd, blocks, count, routes, sizeof(routes) / sizeof(routes[0]), NULL) != 0 ||
+        parse.failed) {
+        return -1;
+    }
+    return parse.rungs;
+}
@@ -0,0 +1,135 @@
+#ifndef ACD_RLL_H
+#define ACD_RLL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+
+// Ladder logic (RLL) rung decoder for a HYPOTHETICAL encoding
+//
+// Neither the RungCode database nor its opcode bytes below have been
+// seen in a real project: the format is this decoder's own design, and
+// the only writer of it is the synthetic generator (bench/acd_synth.c),
+// which benchmarks and fuzzes the decoder. Real projects keep ladder
+// logic in SbRegion.Dat as UTF-16LE rung text, which nothing here reads
+// yet. The CLI therefore only decodes RungCode when asked (--rungcode);
+// by default every rung is exported as NOP();.
+//
+// Rung logic comes from the RungCode database, framed like Comps (see
+// read_database_header). Fields named *UId and Ordinal are u32
+// little-endian, Code is a u32 length followed by that many bytes, and
+// everything else is a string with a u8 length prefix. Recognised fields:
+//   RungUId / CompUId                the Rung component in the Comps tree
+//   RoutineUId / ParentUId           its Routine component
+//   Code                             the rung's instruction stream
+//
+// The instruction stream is a sequence of opcode bytes, each followed by
+// the operands its table entry calls for. An operand is a u8 kind and a
+// value: 0 text (u8 length, bytes: a tag name or a literal as written),
+// 1 integer (i32), 2 real (f32). BST, NXB and BND open a branch, start
+// its next leg and close it. Decoding gives neutral rung text as in an
+// L5X export: XIC(Start)[OTE(Run),TON(T1,1000,0)];
+
+// X(code, mnemonic, operands): every instruction the decoder knows. The
+// dispatch table in acd_rll.c is generated from this list.
+#define ACD_RLL_INSTRUCTIONS(X) \
+    X(0x01, XIC, 1)             \
+    X(0x02, XIO, 1)             \
+    X(0x03, OTE, 1)             \
+    X(0x04, OTL, 1)             \
+    X(0x05, OTU, 1)             \
+    X(0x06, ONS, 1)             \
+    X(0x07, OSR, 2)             \
+    X(0x08, OSF, 2)             \
+    X(0x10, TON, 3)             \
+    X(0x11, TOF, 3)             \
+    X(0x12, RTO, 3)             \
+    X(0x13, CTU, 3)             \
+    X(0x14, CTD, 3)             \
+    X(0x15, RES, 1)             \
+    X(0x20, MOV, 2)             \
+    X(0x21, ADD, 3)             \
+    X(0x22, SUB, 3)             \
+    X(0x23, MUL, 3)             \
+    X(0x24, DIV, 3)             \
+    X(0x25, CLR, 1)             \
+    X(0x26, CPT, 2)             \
+    X(0x27, COP, 3)             \
+    X(0x30, EQU, 2)             \
+    X(0x31, NEQ, 2)             \
+    X(0x32, LES, 2)             \
+    X(0x33, LEQ, 2)             \
+    X(0x34, GRT, 2)             \
+    X(0x35, GEQ, 2)             \
+    X(0x36, LIM, 3)             \
+    X(0x40, JSR, 2)             \
+    X(0x41, RET, 0)             \
+    X(0x42, JMP, 1)             \
+    X(0x43, LBL, 1)             \
+    X(0x44, AFI, 0)             \
+    X(0x45, NOP, 0)
+
+#define RLL_BRANCH_START 0xF0    // BST: "["
+#define RLL_BRANCH_NEXT 0xF1     // NXB: ","
+#define RLL_BRANCH_END 0xF2      // BND: "]"
+
+#define RLL_OPERAND_TEXT 0
+#define RLL_OPERAND_INT 1
+#define RLL_OPERAND_REAL 2
+
+// Longest text (with its NUL) rll_decode_rung can write for len code bytes
+#define RLL_TEXT_BOUND(len) (8 * (size_t)(len) + 8)
+
+// Decoded rungs, one array per column, with their text in one buffer
+typedef struct {
+    size_t count;
+    size_t capacity;
+    uint32_t *uid;               // Rung component UID
+    uint32_t *routine;           // Routine component UID
+    uint32_t *text;              // Offset of the NUL-terminated text in text_data
+    uint32_t *text_len;
+
+    char *text_data;
+    size_t text_size;
+    size_t text_capacity;
+
+    size_t bad;                  // Rungs whose code didn't decode (kept as NOP();)
+
+    // Open addressing: rung UID -> index + 1, rebuilt after each parse
+    uint32_t *uid_slots;
+    size_t uid_slot_count;       // Power of two
+} RungTable;
+
+int rung_table_init(RungTable *table);
+void rung_table_free(RungTable *table);
+
+// Index of the rung with this UID (the first, if repeated), or -1
+long rung_table_find(const RungTable *table, uint32_t uid);
+
+static inline const char *rung_text(const RungTable *table, size_t i) {
+    return table->text_data + table->text[i];
+}
+
+// Mnemonic of an opcode byte, NULL if it isn't an instruction
+const char *rll_mnemonic(unsigned char opcode);
+
+// Decode one rung's instruction stream into out, which must hold
+// RLL_TEXT_BOUND(len) bytes. Returns the text length (NUL not counted),
+// or -1 on an unknown opcode, a bad operand, unbalanced branches or code
+// that ends mid-instruction. An empty stream is the empty rung ";".
+long rll_decode_rung(const unsigned char *code, size_t len, char *out);
+
+// Find and decode the RungCode database inside one decompressed block,
+// appending to table. Rungs are grouped by routine and the routines
+// decoded on jobs threads (<= 1: on this one). Returns the number of rungs
+// added (0 if the block has none), or -1 on allocation failure.
+long parse_rung_block(RungTable *table, const unsigned char *data, size_t size, int jobs);
+
+// Decode the RungCode blocks of a whole ACD through the block pipeline
+// (blocks may be NULL to scan for them). Returns the number of rungs or -1.
+long parse_acd_rungs(RungTable *table, const ACD_File *acd, const CompressedBlock *blocks,
+                     size_t count, int jobs);
+
+#endif
@@ -0,0 +1,324 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#include <immintrin.h>
+#define ACD_SCAN_X86 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define ACD_SCAN_NEON 1
+#endif
+
+#include "acd_scan.h"
+
+// A candidate needs ID1, ID2, CM and a FLG byte with bits 5-7 clear
+#define GZIP_ID1 0x1F
+#define GZIP_ID2 0x8B
+#define GZIP_CM_DEFLATE 0x08
+#define GZIP_FLG_RESERVED 0xE0
+
+static inline int is_gzip_header(const unsigned char *p) {
+    return p[0] == GZIP_ID1 && p[1] == GZIP_ID2 && p[2] == GZIP_CM_DEFLATE &&
+           (p[3] & GZIP_FLG_RESERVED) == 0;
+}
+
+static inline unsigned count_trailing_zeros64(uint64_t x) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Scalar fallback: memchr for ID1 is already vectorized by most libcs
+static size_t scan_scalar(const unsigned char *data, size_t last, size_t pos) {
+    while (pos < last) {
+        const unsigned char *hit = memchr(data + pos, GZIP_ID1, last - pos);
+        if (!hit) {
+            return last;
+        }
+        pos = (size_t)(hit - data);
+        if (is_gzip_header(hit)) {
+            return pos;
+        }
+        pos++;
+    }
+    return last;
+}
+
+#if defined(ACD_SCAN_X86)
+// 16 candidate positions per step; the four shifted loads read up to
+// pos + 19, which the caller guarantees is inside the buffer
+static size_t scan_sse2(const unsigned char *data, size_t last, size_t pos) {
+    const __m128i id1 = _mm_set1_epi8((char)GZIP_ID1);
+    const __m128i id2 = _mm_set1_epi8((char)GZIP_ID2);
+    const __m128i cm = _mm_set1_epi8((char)GZIP_CM_DEFLATE);
+    const __m128i reserved = _mm_set1_epi8((char)GZIP_FLG_RESERVED);
+    const __m128i zero = _mm_setzero_si128();
+
+    while (pos + 16 <= last) {
+        const unsigned char *p = data + pos;
+        __m128i b0 = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_cmpeq_epi8(b0, id1);
+        if (_mm_movemask_epi8(m)) {
+            __m128i b1 = _mm_loadu_si128((const __m128i *)(p + 1));
+            __m128i b2 = _mm_loadu_si128((const __m128i *)(p + 2));
+            __m128i b3 = _mm_loadu_si128((const __m128i *)(p + 3));
+            m = _mm_and_si128(m, _mm_cmpeq_epi8(b1, id2));
+            m = _mm_and_si128(m, _mm_cmpeq_epi8(b2, cm));
+            m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_and_si128(b3, reserved), zero));
+            unsigned mask = (unsigned)_mm_movemask_epi8(m);
+            if (mask) {
+                return pos + count_trailing_zeros64(mask);
+            }
+        }
+        pos += 16;
+    }
+    return scan_scalar(data, last, pos);
+}
+
+#if defined(__GNUC__)
+#define ACD_SCAN_AVX2 1
+__attribute__((target("avx2")))
+static size_t scan_avx2(const unsigned char *data, size_t last, size_t pos) {
+    const __m256i id1 = _mm256_set1_epi8((char)GZIP_ID1);
+    const __m256i id2 = _mm256_set1_epi8((char)GZIP_ID2);
+    const __m256i cm = _mm256_set1_epi8((char)GZIP_CM_DEFLATE);
+    const __m256i reserved = _mm256_set1_epi8((char)GZIP_FLG_RESERVED);
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (pos + 32 <= last) {
+        const unsigned char *p = data + pos;
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)p);
+        __m256i m = _mm256_cmpeq_epi8(b0, id1);
+        if (_mm256_movemask_epi8(m)) {
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(p + 1));
+            __m256i b2 = _mm256_loadu_si256((const __m256i *)(p + 2));
+            __m256i b3 = _mm256_loadu_si256((const __m256i *)(p + 3));
+            m = _mm256_and_si256(m, _mm256_cmpeq_epi8(b1, id2));
+            m = _mm256_and_si256(m, _mm256_cmpeq_epi8(b2, cm));
+            m = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_and_si256(b3, reserved), zero));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+            if (mask) {
+                return pos + count_trailing_zeros64(mask);
+            }
+        }
+        pos += 32;
+    }
+    return scan_sse2(data, last, pos);
+}
+#endif
+#endif
+
+#if defined(ACD_SCAN_NEON)
+static size_t scan_neon(const unsigned char *data, size_t last, size_t pos) {
+    const uint8x16_t id1 = vdupq_n_u8(GZIP_ID1);
+    const uint8x16_t id2 = vdupq_n_u8(GZIP_ID2);
+    const uint8x16_t cm = vdupq_n_u8(GZIP_CM_DEFLATE);
+    const uint8x16_t reserved = vdupq_n_u8(GZIP_FLG_RESERVED);
+
+    while (pos + 16 <= last) {
+        const unsigned char *p = data + pos;
+        uint8x16_t m = vceqq_u8(vld1q_u8(p), id1);
+        if (vmaxvq_u8(m)) {
+            m = vandq_u8(m, vceqq_u8(vld1q_u8(p + 1), id2));
+            m = vandq_u8(m, vceqq_u8(vld1q_u8(p + 2), cm));
+            m = vandq_u8(m, vceqzq_u8(vandq_u8(vld1q_u8(p + 3), reserved)));
+            // Narrow to one nibble per lane to get a scalar bitmask
+            uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+            uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+            if (bits) {
+                return pos + (count_trailing_zeros64(bits) >> 2);
+            }
+        }
+        pos += 16;
+    }
+    return scan_scalar(data, last, pos);
+}
+#endif
+
+// A header byte that isn't text: anything below 0x20 except TAB, LF, CR
+static inline int is_control(unsigned char c) {
+    return c < 0x20 && c != '\t' && c != '\n' && c != '\r';
+}
+
+static size_t control_scalar(const unsigned char *data, size_t len, size_t pos) {
+    while (pos < len && !is_control(data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+#if defined(ACD_SCAN_X86)
+// Unsigned c <= 0x1F is min(c, 0x1F) == c; TAB/LF/CR are masked back out
+static size_t control_sse2(const unsigned char *data, size_t len, size_t pos) {
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    while (pos + 16 <= len) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(data + pos));
+        __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(b, limit), b);
+        __m128i text = _mm_or_si128(_mm_cmpeq_epi8(b, tab),
+                                    _mm_or_si128(_mm_cmpeq_epi8(b, lf), _mm_cmpeq_epi8(b, cr)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_andnot_si128(text, low));
+        if (mask) {
+            return pos + count_trailing_zeros64(mask);
+        }
+        pos += 16;
+    }
+    return control_scalar(data, len, pos);
+}
+
+#if defined(ACD_SCAN_AVX2)
+__attribute__((target("avx2")))
+static size_t control_avx2(const unsigned char *data, size_t len, size_t pos) {
+    const __m256i limit = _mm256_set1_epi8(0x1F);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+
+    while (pos + 32 <= len) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(data + pos));
+        __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(b, limit), b);
+        __m256i text = _mm256_or_si256(_mm256_cmpeq_epi8(b, tab),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(b, lf), _mm256_cmpeq_epi8(b, cr)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_andnot_si256(text, low));
+        if (mask) {
+            return pos + count_trailing_zeros64(mask);
+        }
+        pos += 32;
+    }
+    return control_sse2(data, len, pos);
+}
+#endif
+#endif
+
+#if defined(ACD_SCAN_NEON)
+static size_t control_neon(const unsigned char *data, size_t len, size_t pos) {
+    const uint8x16_t limit = vdupq_n_u8(0x1F);
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+
+    while (pos + 16 <= len) {
+        uint8x16_t b = vld1q_u8(data + pos);
+        uint8x16_t text = vorrq_u8(vceqq_u8(b, tab), vorrq_u8(vceqq_u8(b, lf), vceqq_u8(b, cr)));
+        uint8x16_t m = vbicq_u8(vcleq_u8(b, limit), text);
+        if (vmaxvq_u8(m)) {
+            uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+            uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+            return pos + (count_trailing_zeros64(bits) >> 2);
+        }
+        pos += 16;
+    }
+    return control_scalar(data, len, pos);
+}
+#endif
+
+typedef size_t (*scan_fn)(const unsigned char *, size_t, size_t);
+
+static scan_fn select_scanner(const char **name) {
+#if defined(ACD_SCAN_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return scan_avx2;
+    }
+#endif
+#if defined(ACD_SCAN_X86)
+    *name = "sse2";
+    return scan_sse2;
+#elif defined(ACD_SCAN_NEON)
+    *name = "neon";
+    return scan_neon;
+#else
+    *name = "scalar";
+    return scan_scalar;
+#endif
+}
+
+// Chosen once per process; batch workers and GIL-free Python calls may
+// make the first scan at the same time
+static pthread_once_t scanner_once = PTHREAD_ONCE_INIT;
+static scan_fn active_scanner;
+static scan_fn active_control;
+static const char *active_name;
+
+static scan_fn select_control(void) {
+#if defined(ACD_SCAN_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return control_avx2;
+    }
+#endif
+#if defined(ACD_SCAN_X86)
+    return control_sse2;
+#elif defined(ACD_SCAN_NEON)
+    return control_neon;
+#else
+    return control_scalar;
+#endif
+}
+
+static void choose_scanner(void) {
+    active_scanner = select_scanner(&active_name);
+    active_control = select_control();
+}
+
+static scan_fn get_scanner(void) {
+    pthread_once(&scanner_once, choose_scanner);
+    return active_scanner;
+}
+
+const char *acd_scan_impl(void) {
+    get_scanner();
+    return active_name;
+}
+
+size_t acd_scan_next_gzip(const unsigned char *data, size_t len, size_t pos) {
+    if (len < GZIP_HEADER_SIZE || pos > len - GZIP_HEADER_SIZE) {
+        return len;
+    }
+
+    // Candidates may start anywhere up to len - 10. The vector loops read
+    // 3 bytes past each lane, which stays inside the 10-byte header.
+    size_t last = len - GZIP_HEADER_SIZE + 1;
+    size_t hit = get_scanner()(data, last, pos);
+    return hit < last ? hit : len;
+}
+
+size_t acd_scan_first_control(const unsigned char *data, size_t len, size_t pos) {
+    if (pos >= len) {
+        return len;
+    }
+    get_scanner();
+    return active_control(data, len, pos);
+}
+
+int acd_scan_gzip(const unsigned char *data, size_t len, long base, CandidateList *out) {
+    size_t pos = 0;
+    while ((pos = acd_scan_next_gzip(data, len, pos)) < len) {
+        if (out->count == out->capacity) {
+            size_t capacity = out->capacity ? out->capacity * 2 : 256;
+            long *grown = realloc(out->offsets, capacity * sizeof(*grown));
+            if (!grown) {
+                return -1;
+            }
+            out->offsets = grown;
+            out->capacity = capacity;
+        }
+        out->offsets[out->count++] = base + (long)pos;
+        pos++;
+    }
+    return 0;
+}
+
+void candidate_list_free(CandidateList *list) {
+    free(list->offsets);
+    list->offsets = NULL;
+    list->count = list->capacity = 0;
+}
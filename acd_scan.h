@@ -0,0 +1,37 @@
+#ifndef ACD_SCAN_H
+#define ACD_SCAN_H
+
+#include <stddef.h>
+
+// Smallest possible gzip member header (RFC 1952)
+#define GZIP_HEADER_SIZE 10
+
+// Growable list of file offsets where a gzip header may start
+typedef struct {
+    long *offsets;
+    size_t count;
+    size_t capacity;
+} CandidateList;
+
+// Return the first position >= pos where data holds a plausible gzip
+// header (1F 8B, CM=08, reserved FLG bits clear, 10 header bytes
+// available), or len if there is none. Vectorized where supported.
+size_t acd_scan_next_gzip(const unsigned char *data, size_t len, size_t pos);
+
+// Append every gzip header candidate in data[0, len) to out. Offsets are
+// reported relative to base (pass the file offset of data[0]).
+// Returns 0 on success, -1 on allocation failure.
+int acd_scan_gzip(const unsigned char *data, size_t len, long base, CandidateList *out);
+
+// Return the first position >= pos holding a control byte (below 0x20,
+// other than TAB, LF and CR), or len if the rest is text. Same
+// vectorized implementations as the gzip scan.
+size_t acd_scan_first_control(const unsigned char *data, size_t len, size_t pos);
+
+void candidate_list_free(CandidateList *list);
+
+// Name of the scanner implementation selected at runtime ("avx2", "sse2",
+// "neon" or "scalar")
+const char *acd_scan_impl(void);
+
+#endif
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "acd_signatures.h"
+
+typedef struct {
+    char *name;
+    unsigned char *bytes;
+    size_t len;
+} Signature;
+
+// The automaton is a full DFA: next[state * 256 + byte] already folds in
+// the failure links, so the scan loop is one table load per byte. A
+// state's out is the pattern spelled by it; patterns that are proper
+// suffixes of it are found by following out_link.
+struct SignatureSet {
+    Signature *patterns;
+    int count;
+    int capacity;
+
+    int32_t *next;
+    int32_t *out;       // Pattern id ending at this state, or -1
+    int32_t *out_link;  // Next state down the suffix chain with an output, or -1
+    int32_t *fail;
+    int states;
+    int compiled;
+};
+
+static const struct {
+    const char *name;
+    const char *bytes;
+    size_t len;
+} default_signatures[] = {
+    { "Comps",      "Comps",            5 },
+    { "Controller", "Controller",       10 },
+    { "Controller structure", "\x0A\x00" "Controller", 12 },  // Length-prefixed record name
+    { "XML",        "<?xml",            5 },
+    { "Program",    "Program",          7 },
+    { "Routine",    "Routine",          7 },
+    { "DataType",   "DataType",         8 },
+    { "SbRegion",   "SbRegion",         8 },
+    { "TagInfo",    "TagInfo",          7 },
+    { "Nameless",   "Nameless",         8 },
+    { "RxGeneric",  "RxGeneric",        9 },
+};
+
+SignatureSet *acd_signatures_create(void) {
+    return calloc(1, sizeof(SignatureSet));
+}
+
+static void free_automaton(SignatureSet *set) {
+    free(set->next);
+    free(set->out);
+    free(set->out_link);
+    free(set->fail);
+    set->next = set->out = set->out_link = set->fail = NULL;
+    set->states = 0;
+    set->compiled = 0;
+}
+
+int acd_signatures_add(SignatureSet *set, const char *name, const void *pattern, size_t len) {
+    if (len == 0) {
+        return -1;
+    }
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 16;
+        Signature *grown = realloc(set->patterns, (size_t)capacity * sizeof(*grown));
+        if (!grown) {
+            return -1;
+        }
+        set->patterns = grown;
+        set->capacity = capacity;
+    }
+
+    Signature *sig = &set->patterns[set->count];
+    sig->name = strdup(name ? name : "");
+    sig->bytes = malloc(len);
+    if (!sig->name || !sig->bytes) {
+        free(sig->name);
+        free(sig->bytes);
+        return -1;
+    }
+    memcpy(sig->bytes, pattern, len);
+    sig->len = len;
+    free_automaton(set);
+    return set->count++;
+}
+
+int acd_signatures_add_defaults(SignatureSet *set) {
+    for (size_t i = 0; i < sizeof(default_signatures) / sizeof(default_signatures[0]); i++) {
+        if (acd_signatures_add(set, default_signatures[i].name,
+                               default_signatures[i].bytes, default_signatures[i].len) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int acd_signatures_compile(SignatureSet *set) {
+    free_automaton(set);
+
+    size_t max_states = 1;
+    for (int p = 0; p < set->count; p++) {
+        max_states += set->patterns[p].len;
+    }
+
+    set->next = malloc(max_states * 256 * sizeof(int32_t));
+    set->out = malloc(max_states * sizeof(int32_t));
+    set->out_link = malloc(max_states * sizeof(int32_t));
+    set->fail = calloc(max_states, sizeof(int32_t));
+    int32_t *queue = malloc(max_states * sizeof(int32_t));
+    if (!set->next || !set->out || !set->out_link || !set->fail || !queue) {
+        free(queue);
+        free_automaton(set);
+        return -1;
+    }
+
+    // Trie; -1 marks a missing edge until the failure pass fills it in
+    memset(set->next, 0xFF, 256 * sizeof(int32_t));
+    set->out[0] = -1;
+    int states = 1;
+    for (int p = 0; p < set->count; p++) {
+        int s = 0;
+        for (size_t i = 0; i < set->patterns[p].len; i++) {
+            int32_t *edge = &set->next[(size_t)s * 256 + set->patterns[p].bytes[i]];
+            if (*edge < 0) {
+                memset(set->next + (size_t)states * 256, 0xFF, 256 * sizeof(int32_t));
+                set->out[states] = -1;
+                *edge = states++;
+            }
+            s = *edge;
+        }
+        // First pattern wins if the same bytes were added twice
+        if (set->out[s] < 0) set->out[s] = p;
+    }
+
+    // Breadth-first: a state's failure target is always shallower, so it
+    // is complete by the time the state itself is reached
+    size_t head = 0, tail = 0;
+    set->out_link[0] = -1;
+    for (int c = 0; c < 256; c++) {
+        int32_t t = set->next[c];
+        if (t < 0) {
+            set->next[c] = 0;
+        } else {
+            set->fail[t] = 0;
+            set->out_link[t] = -1;
+            queue[tail++] = t;
+        }
+    }
+    while (head < tail) {
+        int32_t s = queue[head++];
+        for (int c = 0; c < 256; c++) {
+            int32_t *edge = &set->next[(size_t)s * 256 + c];
+            int32_t f = set->next[(size_t)set->fail[s] * 256 + c];
+            if (*edge < 0) {
+                *edge = f;
+            } else {
+                int32_t t = *edge;
+                set->fail[t] = f;
+                set->out_link[t] = set->out[f] >= 0 ? f : set->out_link[f];
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    free(queue);
+    set->states = states;
+    set->compiled = 1;
+    return 0;
+}
+
+SignatureSet *acd_signatures_default(void) {
+    SignatureSet *set = acd_signatures_create();
+    if (!set) {
+        return NULL;
+    }
+    if (acd_signatures_add_defaults(set) != 0 || acd_signatures_compile(set) != 0) {
+        acd_signatures_destroy(set);
+        return NULL;
+    }
+    return set;
+}
+
+int acd_signatures_count(const SignatureSet *set) {
+    return set->count;
+}
+
+const char *acd_signatures_name(const SignatureSet *set, int id) {
+    return id >= 0 && id < set->count ? set->patterns[id].name : NULL;
+}
+
+size_t acd_signatures_scan_stream(const SignatureSet *set, int *state,
+                                  const unsigned char *data, size_t len,
+                                  size_t base, acd_signature_hit_fn fn, void *ctx) {
+    if (!set->compiled) {
+        return 0;
+    }
+
+    const int32_t *next = set->next;
+    const int32_t *out = set->out;
+    const int32_t *out_link = set->out_link;
+    size_t hits = 0;
+    int32_t s = *state;
+
+    for (size_t i = 0; i < len; i++) {
+        s = next[(size_t)s * 256 + data[i]];
+        if (out[s] < 0 && out_link[s] < 0) continue;
+
+        // Report the longest match here and every suffix that is also a pattern
+        for (int32_t t = out[s] >= 0 ? s : out_link[s]; t >= 0; t = out_link[t]) {
+            int id = out[t];
+            size_t end = base + i + 1;
+            if (fn) fn(ctx, id, end - set->patterns[id].len);
+            hits++;
+        }
+    }
+
+    *state = s;
+    return hits;
+}
+
+size_t acd_signatures_scan(const SignatureSet *set, const unsigned char *data, size_t len,
+                           size_t base, acd_signature_hit_fn fn, void *ctx) {
+    int state = 0;
+    return acd_signatures_scan_stream(set, &state, data, len, base, fn, ctx);
+}
+
+void acd_signatures_destroy(SignatureSet *set) {
+    if (!set) {
+        return;
+    }
+    for (int p = 0; p < set->count; p++) {
+        free(set->patterns[p].name);
+        free(set->patterns[p].bytes);
+    }
+    free(set->patterns);
+    free_automaton(set);
+    free(set);
+}
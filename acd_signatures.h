@@ -0,0 +1,47 @@
+#ifndef ACD_SIGNATURES_H
+#define ACD_SIGNATURES_H
+
+#include <stddef.h>
+
+// Multi-pattern signature search (Aho-Corasick). All patterns of a set are
+// found in one pass over the data, so the per-byte cost doesn't grow with
+// the number of signatures. Patterns are arbitrary bytes and may overlap.
+typedef struct SignatureSet SignatureSet;
+
+// Called for every hit; offset is where the pattern starts (base + index)
+typedef void (*acd_signature_hit_fn)(void *ctx, int id, size_t offset);
+
+// An empty set; add patterns, then compile before scanning
+SignatureSet *acd_signatures_create(void);
+
+// Add a pattern (len bytes, not NUL-terminated). Returns its id or -1.
+// Adding to a compiled set makes it uncompiled again.
+int acd_signatures_add(SignatureSet *set, const char *name, const void *pattern, size_t len);
+
+// Build the automaton. Returns 0 or -1 (allocation failure).
+int acd_signatures_compile(SignatureSet *set);
+
+// The built-in database markers (Comps, Controller, <?xml, Program,
+// Routine, DataType, SbRegion, TagInfo, Nameless, RxGeneric, ...)
+int acd_signatures_add_defaults(SignatureSet *set);
+
+// acd_signatures_create + add_defaults + compile
+SignatureSet *acd_signatures_default(void);
+
+int acd_signatures_count(const SignatureSet *set);
+const char *acd_signatures_name(const SignatureSet *set, int id);
+
+// Scan data[0, len) and report every hit; returns the number of hits
+size_t acd_signatures_scan(const SignatureSet *set, const unsigned char *data, size_t len,
+                           size_t base, acd_signature_hit_fn fn, void *ctx);
+
+// Resumable scan for data arriving in chunks: *state starts at 0 and is
+// carried between calls, so hits spanning a chunk boundary are found.
+// base is the offset of data[0] in the whole stream.
+size_t acd_signatures_scan_stream(const SignatureSet *set, int *state,
+                                  const unsigned char *data, size_t len,
+                                  size_t base, acd_signature_hit_fn fn, void *ctx);
+
+void acd_signatures_destroy(SignatureSet *set);
+
+#endif
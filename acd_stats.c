@@ -0,0 +1,74 @@
+#include <time.h>
+
+#include "acd_stats.h"
+
+AcdStats acd_stats;
+int acd_quiet;
+
+uint64_t acd_now_ns(void) {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void acd_stats_reset(void) {
+    _Atomic uint64_t *counters = (_Atomic uint64_t *)&acd_stats;
+    for (size_t i = 0; i < sizeof(acd_stats) / sizeof(*counters); i++) {
+        atomic_store_explicit(&counters[i], 0, memory_order_relaxed);
+    }
+}
+
+static uint64_t load(_Atomic uint64_t *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+void acd_json_write_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; s && *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int acd_stats_write_json(FILE *out, const char *command, const char *path, uint64_t wall_ns) {
+    AcdStats *s = &acd_stats;
+    uint64_t candidates = load(&s->candidates);
+    uint64_t rejected = load(&s->rejected_header) + load(&s->rejected_block) + load(&s->rejected_inflate);
+
+    fputs("{\"command\":", out);
+    acd_json_write_string(out, command);
+    fputs(",\"file\":", out);
+    acd_json_write_string(out, path);
+    fprintf(out, ",\"wall_ns\":%llu", (unsigned long long)wall_ns);
+    fprintf(out, ",\"header\":{\"ns\":%llu}", (unsigned long long)load(&s->header_ns));
+    fprintf(out, ",\"scan\":{\"ns\":%llu,\"bytes\":%llu,\"candidates\":%llu,\"rejected_header\":%llu,"
+                 "\"rejected_block\":%llu,\"rejected_inflate\":%llu,\"blocks\":%llu,"
+                 "\"false_positive_rate\":%.4f}",
+            (unsigned long long)load(&s->scan_ns), (unsigned long long)load(&s->scan_bytes),
+            (unsigned long long)candidates, (unsigned long long)load(&s->rejected_header),
+            (unsigned long long)load(&s->rejected_block), (unsigned long long)load(&s->rejected_inflate),
+            (unsigned long long)load(&s->blocks), candidates ? (double)rejected / (double)candidates : 0.0);
+    fprintf(out, ",\"probe\":{\"ns\":%llu}", (unsigned long long)load(&s->probe_ns));
+    fprintf(out, ",\"inflate\":{\"ns\":%llu,\"members\":%llu,\"bytes_in\":%llu,\"bytes_out\":%llu}",
+            (unsigned long long)load(&s->inflate_ns), (unsigned long long)load(&s->inflate_members),
+            (unsigned long long)load(&s->inflate_bytes_in), (unsigned long long)load(&s->inflate_bytes_out));
+    fprintf(out, ",\"parse\":{\"ns\":%llu,\"components\":%llu,\"reused\":%llu,\"tags\":%llu,\"rungs\":%llu}",
+            (unsigned long long)load(&s->parse_ns), (unsigned long long)load(&s->components),
+            (unsigned long long)load(&s->components_reused), (unsigned long long)load(&s->tags),
+            (unsigned long long)load(&s->rungs));
+    fprintf(out, ",\"emit\":{\"ns\":%llu,\"bytes\":%llu}}\n",
+            (unsigned long long)load(&s->emit_ns), (unsigned long long)load(&s->emit_bytes));
+    return fflush(out) == 0 && !ferror(out) ? 0 : -1;
+}
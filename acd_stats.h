@@ -0,0 +1,70 @@
+#ifndef ACD_STATS_H
+#define ACD_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Process-wide counters and monotonic timers for the hot paths. Every
+// stage adds to them as it runs (relaxed atomics, so worker threads can
+// too); times are nanoseconds of thread time, so parallel stages can sum
+// to more than the wall clock.
+typedef struct {
+    _Atomic uint64_t header_ns;          // Binary start detection and header parse
+
+    // Candidate scan: time finding magic hits and rejecting them on their
+    // header bytes, and how each candidate ended up
+    _Atomic uint64_t scan_ns;
+    _Atomic uint64_t scan_bytes;
+    _Atomic uint64_t candidates;
+    _Atomic uint64_t rejected_header;    // acd_gzip_check, member header
+    _Atomic uint64_t rejected_block;     // acd_gzip_check, first deflate block
+    _Atomic uint64_t rejected_inflate;   // Passed the check, didn't decode
+    _Atomic uint64_t blocks;             // Complete members found
+
+    _Atomic uint64_t probe_ns;           // Inflating candidates to find their end
+
+    // Decoding of member contents (probes not included)
+    _Atomic uint64_t inflate_ns;
+    _Atomic uint64_t inflate_members;
+    _Atomic uint64_t inflate_bytes_in;
+    _Atomic uint64_t inflate_bytes_out;
+
+    _Atomic uint64_t parse_ns;           // Comps, TagInfo and RungCode decoding
+    _Atomic uint64_t components;
+    _Atomic uint64_t components_reused;  // From the component cache
+    _Atomic uint64_t tags;               // TagInfo records
+    _Atomic uint64_t rungs;              // RungCode records
+
+    _Atomic uint64_t emit_ns;            // L5X generation
+    _Atomic uint64_t emit_bytes;
+} AcdStats;
+
+extern AcdStats acd_stats;
+
+// Nonzero suppresses per-block and per-record progress lines. Set it
+// before starting work.
+extern int acd_quiet;
+
+// Monotonic clock in nanoseconds
+uint64_t acd_now_ns(void);
+
+static inline void acd_stat_add(_Atomic uint64_t *counter, uint64_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+// Add the time since start (from acd_now_ns) to counter
+static inline void acd_stat_time(_Atomic uint64_t *counter, uint64_t start) {
+    acd_stat_add(counter, acd_now_ns() - start);
+}
+
+void acd_stats_reset(void);
+
+// One JSON object (single line) with every counter, grouped by stage,
+// plus the command, file and wall time. Returns 0 or -1 on write error.
+int acd_stats_write_json(FILE *out, const char *command, const char *path, uint64_t wall_ns);
+
+// s as a quoted JSON string, control characters as \u escapes (NULL = "")
+void acd_json_write_string(FILE *out, const char *s);
+
+#endif
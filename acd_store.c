@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_store.h"
+
+#define POOL_INITIAL (64 * 1024)
+#define SLOTS_INITIAL 1024
+
+struct StringSlot {
+    uint32_t hash;               // 0 = empty
+    StrRef ref;
+};
+
+// FNV-1a, forced non-zero so 0 can mark an empty slot
+static uint32_t hash_bytes(const unsigned char *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h ? h : 1;
+}
+
+int string_pool_init(StringPool *pool) {
+    memset(pool, 0, sizeof(*pool));
+    pool->data = malloc(POOL_INITIAL);
+    pool->slots = calloc(SLOTS_INITIAL, sizeof(*pool->slots));
+    if (!pool->data || !pool->slots) {
+        string_pool_free(pool);
+        return -1;
+    }
+    pool->capacity = POOL_INITIAL;
+    pool->slot_count = SLOTS_INITIAL;
+    // Offset 0 holds "", so a zeroed StrRef is a valid empty string
+    pool->data[0] = '\0';
+    pool->size = 1;
+    return 0;
+}
+
+void string_pool_free(StringPool *pool) {
+    free(pool->data);
+    free(pool->slots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+static int grow_slots(StringPool *pool) {
+    size_t count = pool->slot_count * 2;
+    struct StringSlot *slots = calloc(count, sizeof(*slots));
+    if (!slots) {
+        return -1;
+    }
+    for (size_t i = 0; i < pool->slot_count; i++) {
+        if (!pool->slots[i].hash) continue;
+        size_t j = pool->slots[i].hash & (count - 1);
+        while (slots[j].hash) j = (j + 1) & (count - 1);
+        slots[j] = pool->slots[i];
+    }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->slot_count = count;
+    return 0;
+}
+
+int string_pool_intern(StringPool *pool, const void *s, size_t len, StrRef *ref) {
+    if (len == 0) {
+        ref->offset = ref->len = 0;
+        return 0;
+    }
+    if (len > UINT32_MAX - 1 || pool->size + len + 1 > UINT32_MAX) {
+        return -1;
+    }
+
+    // Keep the table at most half full
+    if ((pool->used + 1) * 2 > pool->slot_count && grow_slots(pool) != 0) {
+        return -1;
+    }
+
+    uint32_t hash = hash_bytes(s, len);
+    size_t mask = pool->slot_count - 1;
+    size_t i = hash & mask;
+    for (; pool->slots[i].hash; i = (i + 1) & mask) {
+        const struct StringSlot *slot = &pool->slots[i];
+        if (slot->hash == hash && slot->ref.len == len &&
+            memcmp(pool->data + slot->ref.offset, s, len) == 0) {
+            *ref = slot->ref;
+            return 0;
+        }
+    }
+
+    if (pool->size + len + 1 > pool->capacity) {
+        size_t capacity = pool->capacity;
+        while (pool->size + len + 1 > capacity) capacity *= 2;
+        char *grown = realloc(pool->data, capacity);
+        if (!grown) {
+            return -1;
+        }
+        pool->data = grown;
+        pool->capacity = capacity;
+    }
+
+    StrRef added = { (uint32_t)pool->size, (uint32_t)len };
+    memcpy(pool->data + pool->size, s, len);
+    pool->data[pool->size + len] = '\0';
+    pool->size += len + 1;
+
+    pool->slots[i].hash = hash;
+    pool->slots[i].ref = added;
+    pool->used++;
+    *ref = added;
+    return 0;
+}
+
+int component_store_init(ComponentStore *store) {
+    memset(store, 0, sizeof(*store));
+    return string_pool_init(&store->strings);
+}
+
+static void free_index(ComponentStore *store) {
+    free(store->uid_slots);
+    free(store->child_start);
+    free(store->children);
+    free(store->roots);
+    store->uid_slots = store->child_start = store->children = store->roots = NULL;
+    store->uid_slot_count = store->root_count = 0;
+}
+
+void component_store_free(ComponentStore *store) {
+    free_index(store);
+    free(store->items);
+    string_pool_free(&store->strings);
+    memset(store, 0, sizeof(*store));
+}
+
+int component_store_reserve(ComponentStore *store, size_t n) {
+    if (n <= store->capacity - store->count) {
+        return 0;
+    }
+    size_t capacity = store->capacity ? store->capacity : 256;
+    while (capacity - store->count < n) capacity *= 2;
+    Component *grown = realloc(store->items, capacity * sizeof(*grown));
+    if (!grown) {
+        return -1;
+    }
+    store->items = grown;
+    store->capacity = capacity;
+    return 0;
+}
+
+Component *component_store_add(ComponentStore *store) {
+    if (store->count == store->capacity && component_store_reserve(store, 1) != 0) {
+        return NULL;
+    }
+    Component *comp = &store->items[store->count++];
+    memset(comp, 0, sizeof(*comp));
+    return comp;
+}
+
+// Multiplicative hash; UIDs are small dense integers, so mix the high bits in
+static size_t uid_slot(uint32_t uid, size_t mask) {
+    return (size_t)((uid * 2654435761u) ^ (uid >> 16)) & mask;
+}
+
+long component_store_find(const ComponentStore *store, uint32_t uid) {
+    if (!store->uid_slots) {
+        return -1;
+    }
+    size_t mask = store->uid_slot_count - 1;
+    for (size_t i = uid_slot(uid, mask); store->uid_slots[i]; i = (i + 1) & mask) {
+        uint32_t index = store->uid_slots[i] - 1;
+        if (store->items[index].uid == uid) {
+            return (long)index;
+        }
+    }
+    return -1;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+int component_store_build_index(ComponentStore *store) {
+    free_index(store);
+    size_t n = store->count;
+    if (n >= UINT32_MAX) {
+        return -1;
+    }
+
+    size_t slot_count = 16;
+    while (slot_count < n * 2) slot_count *= 2;
+
+    store->uid_slots = calloc(slot_count, sizeof(uint32_t));
+    store->child_start = calloc(n + 1, sizeof(uint32_t));
+    store->children = malloc((n ? n : 1) * sizeof(uint32_t));
+    store->roots = malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t *parent = malloc((n ? n : 1) * sizeof(uint32_t));
+    uint64_t *order = malloc((n ? n : 1) * sizeof(uint64_t));
+    if (!store->uid_slots || !store->child_start || !store->children || !store->roots ||
+        !parent || !order) {
+        free(parent);
+        free(order);
+        free_index(store);
+        return -1;
+    }
+    store->uid_slot_count = slot_count;
+
+    // UID -> index; a repeated UID keeps its first component
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t uid = store->items[i].uid;
+        size_t slot = uid_slot(uid, mask);
+        while (store->uid_slots[slot] && store->items[store->uid_slots[slot] - 1].uid != uid) {
+            slot = (slot + 1) & mask;
+        }
+        if (!store->uid_slots[slot]) store->uid_slots[slot] = (uint32_t)i + 1;
+    }
+
+    // Resolve parents and count children per component
+    for (size_t i = 0; i < n; i++) {
+        const Component *comp = &store->items[i];
+        long p = comp->parent_uid != comp->uid ? component_store_find(store, comp->parent_uid) : -1;
+        parent[i] = p < 0 || (size_t)p == i ? UINT32_MAX : (uint32_t)p;
+        if (parent[i] != UINT32_MAX) store->child_start[parent[i] + 1]++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        store->child_start[i + 1] += store->child_start[i];
+    }
+
+    // Place components in (ordinal, index) order; each row then comes out
+    // sorted because placement into a row is stable
+    for (size_t i = 0; i < n; i++) {
+        order[i] = ((uint64_t)store->items[i].ordinal << 32) | (uint32_t)i;
+    }
+    qsort(order, n, sizeof(*order), compare_u64);
+
+    uint32_t *next = malloc((n ? n : 1) * sizeof(uint32_t));
+    if (!next) {
+        free(parent);
+        free(order);
+        free_index(store);
+        return -1;
+    }
+    memcpy(next, store->child_start, n * sizeof(uint32_t));
+    for (size_t k = 0; k < n; k++) {
+        uint32_t i = (uint32_t)order[k];
+        if (parent[i] == UINT32_MAX) {
+            store->roots[store->root_count++] = i;
+        } else {
+            store->children[next[parent[i]]++] = i;
+        }
+    }
+
+    free(next);
+    free(parent);
+    free(order);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef ACD_STORE_H
+#define ACD_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Interned string: offset and length in a StringPool. {0, 0} is "".
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+} StrRef;
+
+// Append-only string pool. Every distinct string is stored once,
+// NUL-terminated, in one growing buffer; refs stay valid as it grows
+// (pointers from string_pool_get do not).
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+
+    // Open-addressing intern table over the stored strings
+    struct StringSlot *slots;
+    size_t slot_count;           // Power of two
+    size_t used;
+} StringPool;
+
+int string_pool_init(StringPool *pool);
+void string_pool_free(StringPool *pool);
+
+// Intern len bytes of s (no NUL needed). Returns 0 and sets *ref, or -1.
+int string_pool_intern(StringPool *pool, const void *s, size_t len, StrRef *ref);
+
+static inline const char *string_pool_get(const StringPool *pool, StrRef ref) {
+    return pool->data + ref.offset;
+}
+
+// Component structure based on database fields
+typedef struct {
+    uint32_t uid;
+    uint32_t parent_uid;
+    uint32_t ordinal;
+    StrRef name;
+    StrRef ioi;
+    StrRef type;
+} Component;
+
+// All components parsed from a project, plus the strings they refer to.
+// Grows geometrically with no fixed limit; component_store_free releases
+// everything at once.
+typedef struct {
+    Component *items;
+    size_t count;
+    size_t capacity;
+    StringPool strings;
+
+    // Hierarchy, built by component_store_build_index: open-addressing
+    // UID -> index table, and children of every component in CSR form
+    // (children[child_start[i] .. child_start[i + 1]) sorted by ordinal).
+    // Components without a known parent are roots.
+    uint32_t *uid_slots;         // Component index + 1, 0 = empty
+    size_t uid_slot_count;       // Power of two
+    uint32_t *child_start;       // count + 1 entries
+    uint32_t *children;
+    uint32_t *roots;
+    size_t root_count;
+} ComponentStore;
+
+int component_store_init(ComponentStore *store);
+void component_store_free(ComponentStore *store);
+
+// Make room for n more components (one allocation for a known record count)
+int component_store_reserve(ComponentStore *store, size_t n);
+
+// Append a zeroed component; returns it, or NULL on allocation failure
+Component *component_store_add(ComponentStore *store);
+
+// (Re)build the UID index and child lists for the current components (O(n)
+// apart from the ordinal sort); call again after adding components.
+// Returns 0 or -1 on allocation failure.
+int component_store_build_index(ComponentStore *store);
+
+// Index of the component with this UID (the first, if repeated), or -1
+long component_store_find(const ComponentStore *store, uint32_t uid);
+
+// Children of component index in ordinal order
+static inline const uint32_t *component_children(const ComponentStore *store, size_t index,
+                                                 size_t *count) {
+    *count = store->child_start[index + 1] - store->child_start[index];
+    return store->children + store->child_start[index];
+}
+
+static inline const char *component_str(const ComponentStore *store, StrRef ref) {
+    return string_pool_get(&store->strings, ref);
+}
+
+#endif
@@ -0,0 +1,730 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "acd_tags.h"
+#include "acd_pipeline.h"
+#include "acd_stats.h"
+
+#define TYPE_SLOTS_INITIAL 64
+
+int tag_table_init(TagTable *table) {
+    memset(table, 0, sizeof(*table));
+    table->type_slots = calloc(TYPE_SLOTS_INITIAL, sizeof(*table->type_slots));
+    if (!table->type_slots || string_pool_init(&table->strings) != 0) {
+        free(table->type_slots);
+        memset(table, 0, sizeof(*table));
+        return -1;
+    }
+    table->type_slot_count = TYPE_SLOTS_INITIAL;
+    return 0;
+}
+
+void tag_table_free(TagTable *table) {
+    free(table->name);
+    free(table->type);
+    free(table->dim0);
+    free(table->dim1);
+    free(table->dim2);
+    free(table->scope);
+    free(table->access);
+    free(table->alias);
+    free(table->type_name);
+    free(table->type_slots);
+    free(table->program_name);
+    free(table->def_type);
+    free(table->def_family);
+    free(table->def_class);
+    free(table->def_member_start);
+    free(table->member_name);
+    free(table->member_type);
+    free(table->member_dim);
+    free(table->member_hidden);
+    string_pool_free(&table->strings);
+    memset(table, 0, sizeof(*table));
+}
+
+// Grow one column to capacity elements of size bytes
+static int grow_column(void **column, size_t capacity, size_t size) {
+    void *grown = realloc(*column, capacity * size);
+    if (!grown) {
+        return -1;
+    }
+    *column = grown;
+    return 0;
+}
+
+int tag_table_reserve(TagTable *table, size_t n) {
+    if (table->capacity - table->count >= n) {
+        return 0;
+    }
+    size_t capacity = table->capacity ? table->capacity : 1024;
+    while (capacity - table->count < n) capacity *= 2;
+    if (grow_column((void **)&table->name, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->type, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->dim0, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->dim1, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->dim2, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->scope, capacity, sizeof(uint32_t)) != 0 ||
+        grow_column((void **)&table->access, capacity, sizeof(uint8_t)) != 0 ||
+        grow_column((void **)&table->alias, capacity, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+    table->capacity = capacity;
+    return 0;
+}
+
+// FNV-1a over the lower-cased name: type names compare case-insensitively
+static uint32_t hash_type(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)tolower((unsigned char)s[i])) * 16777619u;
+    }
+    return h;
+}
+
+static int type_matches(const TagTable *table, uint32_t type, const char *s, size_t len) {
+    const char *name = tag_type_name(table, type);
+    return strlen(name) == len && strncasecmp(name, s, len) == 0;
+}
+
+// Slot holding the type spelled s, or the empty slot where it would go
+static size_t find_type_slot(const TagTable *table, const char *s, size_t len) {
+    size_t mask = table->type_slot_count - 1;
+    size_t i = hash_type(s, len) & mask;
+    while (table->type_slots[i] && !type_matches(table, table->type_slots[i] - 1, s, len)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static int grow_type_slots(TagTable *table) {
+    size_t count = table->type_slot_count * 2;
+    uint32_t *slots = calloc(count, sizeof(*slots));
+    if (!slots) {
+        return -1;
+    }
+    for (uint32_t t = 0; t < table->type_count; t++) {
+        const char *name = tag_type_name(table, t);
+        size_t j = hash_type(name, strlen(name)) & (count - 1);
+        while (slots[j]) j = (j + 1) & (count - 1);
+        slots[j] = t + 1;
+    }
+    free(table->type_slots);
+    table->type_slots = slots;
+    table->type_slot_count = count;
+    return 0;
+}
+
+// Type id for s, adding it on first sight; UINT32_MAX on allocation failure
+static uint32_t intern_type(TagTable *table, const char *s, size_t len) {
+    size_t slot = find_type_slot(table, s, len);
+    if (table->type_slots[slot]) {
+        return table->type_slots[slot] - 1;
+    }
+    if (table->type_count == table->type_capacity) {
+        size_t capacity = table->type_capacity ? table->type_capacity * 2 : 64;
+        if (grow_column((void **)&table->type_name, capacity, sizeof(uint32_t)) != 0) {
+            return UINT32_MAX;
+        }
+        table->type_capacity = capacity;
+    }
+    StrRef ref;
+    if (string_pool_intern(&table->strings, s, len, &ref) != 0) {
+        return UINT32_MAX;
+    }
+    uint32_t type = (uint32_t)table->type_count++;
+    table->type_name[type] = ref.offset;
+    table->type_slots[slot] = type + 1;
+
+    // Keep the table at most half full
+    if (table->type_count * 2 > table->type_slot_count && grow_type_slots(table) != 0) {
+        return UINT32_MAX;
+    }
+    return type;
+}
+
+long tag_table_add(TagTable *table, const char *name, size_t name_len, const char *type,
+                   size_t type_len, const uint32_t *dims, uint32_t scope, TagAccess access,
+                   const char *alias, size_t alias_len) {
+    StrRef ref, alias_ref = {0};
+    if (tag_table_reserve(table, 1) != 0 || string_pool_intern(&table->strings, name, name_len, &ref) != 0 ||
+        (alias_len && string_pool_intern(&table->strings, alias, alias_len, &alias_ref) != 0)) {
+        return -1;
+    }
+    uint32_t type_id = intern_type(table, type, type_len);
+    if (type_id == UINT32_MAX) {
+        return -1;
+    }
+    size_t i = table->count++;
+    table->name[i] = ref.offset;
+    table->type[i] = type_id;
+    table->dim0[i] = dims ? dims[0] : 0;
+    table->dim1[i] = dims ? dims[1] : 0;
+    table->dim2[i] = dims ? dims[2] : 0;
+    table->scope[i] = scope;
+    table->access[i] = (uint8_t)access;
+    table->alias[i] = alias_ref.offset;
+    return (long)i;
+}
+
+static uint32_t find_program(const TagTable *table, const char *name, size_t len) {
+    for (size_t p = 0; p < table->program_count; p++) {
+        const char *s = tag_str(table, table->program_name[p]);
+        if (strlen(s) == len && strncasecmp(s, name, len) == 0) {
+            return (uint32_t)p + 1;
+        }
+    }
+    return TAG_SCOPE_ANY;
+}
+
+uint32_t tag_table_add_program(TagTable *table, const char *name, size_t len) {
+    uint32_t scope = find_program(table, name, len);
+    if (scope != TAG_SCOPE_ANY) {
+        return scope;
+    }
+    if (table->program_count == table->program_capacity) {
+        size_t capacity = table->program_capacity ? table->program_capacity * 2 : 16;
+        if (grow_column((void **)&table->program_name, capacity, sizeof(uint32_t)) != 0) {
+            return TAG_SCOPE_ANY;
+        }
+        table->program_capacity = capacity;
+    }
+    StrRef ref;
+    if (table->program_count >= TAG_SCOPE_ANY - 1 || string_pool_intern(&table->strings, name, len, &ref) != 0) {
+        return TAG_SCOPE_ANY;
+    }
+    table->program_name[table->program_count++] = ref.offset;
+    return (uint32_t)table->program_count;
+}
+
+uint32_t tag_table_program_scope(const TagTable *table, const char *name) {
+    return find_program(table, name, strlen(name));
+}
+
+long tag_table_add_datatype(TagTable *table, const char *name, size_t name_len, const char *family,
+                            size_t family_len, const char *cls, size_t class_len) {
+    if (table->def_count + 1 >= table->def_capacity) {
+        size_t capacity = table->def_capacity ? table->def_capacity * 2 : 64;
+        if (grow_column((void **)&table->def_type, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->def_family, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->def_class, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->def_member_start, capacity, sizeof(uint32_t)) != 0) {
+            return -1;
+        }
+        table->def_capacity = capacity;
+    }
+    StrRef family_ref, class_ref;
+    uint32_t type = intern_type(table, name, name_len);
+    if (type == UINT32_MAX || string_pool_intern(&table->strings, family, family_len, &family_ref) != 0 ||
+        string_pool_intern(&table->strings, cls, class_len, &class_ref) != 0) {
+        return -1;
+    }
+    size_t d = table->def_count++;
+    table->def_type[d] = type;
+    table->def_family[d] = family_ref.offset;
+    table->def_class[d] = class_ref.offset;
+    table->def_member_start[d] = (uint32_t)table->member_count;
+    table->def_member_start[d + 1] = (uint32_t)table->member_count;
+    return (long)d;
+}
+
+long tag_table_add_member(TagTable *table, const char *name, size_t name_len, const char *type,
+                          size_t type_len, uint32_t dim, int hidden) {
+    if (!table->def_count || table->member_count >= UINT32_MAX) {
+        return -1;
+    }
+    if (table->member_count == table->member_capacity) {
+        size_t capacity = table->member_capacity ? table->member_capacity * 2 : 256;
+        if (grow_column((void **)&table->member_name, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->member_type, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->member_dim, capacity, sizeof(uint32_t)) != 0 ||
+            grow_column((void **)&table->member_hidden, capacity, sizeof(uint8_t)) != 0) {
+            return -1;
+        }
+        table->member_capacity = capacity;
+    }
+    StrRef ref;
+    uint32_t type_id = intern_type(table, type, type_len);
+    if (type_id == UINT32_MAX || string_pool_intern(&table->strings, name, name_len, &ref) != 0) {
+        return -1;
+    }
+    size_t m = table->member_count++;
+    table->member_name[m] = ref.offset;
+    table->member_type[m] = type_id;
+    table->member_dim[m] = dim;
+    table->member_hidden[m] = (uint8_t)(hidden != 0);
+    table->def_member_start[table->def_count] = (uint32_t)table->member_count;
+    return (long)m;
+}
+
+long tag_table_find_datatype(const TagTable *table, uint32_t type) {
+    for (size_t d = 0; d < table->def_count; d++) {
+        if (table->def_type[d] == type) return (long)d;
+    }
+    return -1;
+}
+
+uint32_t tag_table_type_id(const TagTable *table, const char *type) {
+    if (!table->type_slot_count) {
+        return TAG_TYPE_ANY;
+    }
+    size_t slot = find_type_slot(table, type, strlen(type));
+    return table->type_slots[slot] ? table->type_slots[slot] - 1 : TAG_TYPE_ANY;
+}
+
+size_t tag_table_select(const TagTable *table, uint32_t type, uint32_t scope, uint32_t *out, size_t max) {
+    size_t matches = 0;
+    const uint32_t *types = table->type, *scopes = table->scope;
+    // Branch-free per tag: a match is written, then kept by advancing
+    for (size_t i = 0; i < table->count; i++) {
+        int hit = (type == TAG_TYPE_ANY || types[i] == type) & (scope == TAG_SCOPE_ANY || scopes[i] == scope);
+        if (out && matches < max) out[matches] = (uint32_t)i;
+        matches += (size_t)hit;
+    }
+    return matches;
+}
+
+const char *tag_access_name(uint8_t access) {
+    switch (access) {
+        case TAG_ACCESS_READ_ONLY: return "Read Only";
+        case TAG_ACCESS_NONE: return "None";
+        default: return "Read/Write";
+    }
+}
+
+// Append code point c to out as UTF-8; returns the bytes written
+static size_t put_utf8(char *out, uint32_t c) {
+    if (c < 0x80) {
+        out[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+// Mutable UTF-8 copy of a document, NUL-terminated. UTF-16LE (with its
+// byte order mark, or starting "<\0") is converted up to the first NUL
+// unit, unpaired surrogates becoming U+FFFD; anything else is copied from
+// after any UTF-8 byte order mark. NULL on allocation failure.
+static char *document_utf8(const unsigned char *data, size_t size, size_t *len) {
+    int utf16 = 0;
+    size_t pos = 0;
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+        utf16 = 1;
+        pos = 2;
+    } else if (size >= 2 && data[0] == '<' && data[1] == 0) {
+        utf16 = 1;
+    } else if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        pos = 3;
+    }
+    if (!utf16) {
+        char *doc = malloc(size - pos + 1);
+        if (!doc) {
+            return NULL;
+        }
+        memcpy(doc, data + pos, size - pos);
+        doc[size - pos] = '\0';
+        *len = size - pos;
+        return doc;
+    }
+
+    // A unit becomes at most 3 bytes (a surrogate pair, 4 for 2 units)
+    size_t units = (size - pos) / 2;
+    char *doc = malloc(units * 3 + 1);
+    if (!doc) {
+        return NULL;
+    }
+    size_t out = 0;
+    for (size_t u = 0; u < units; u++) {
+        uint32_t c = data[pos + 2 * u] | ((uint32_t)data[pos + 2 * u + 1] << 8);
+        if (c == 0) break;
+        if (c >= 0xD800 && c < 0xDC00 && u + 1 < units) {
+            uint32_t low = data[pos + 2 * u + 2] | ((uint32_t)data[pos + 2 * u + 3] << 8);
+            if (low >= 0xDC00 && low < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                u++;
+            } else {
+                c = 0xFFFD;
+            }
+        } else if (c >= 0xD800 && c < 0xE000) {
+            c = 0xFFFD;
+        }
+        out += put_utf8(doc + out, c);
+    }
+    doc[out] = '\0';
+    *len = out;
+    return doc;
+}
+
+// Replace character and entity references in s[0, len) in place (the
+// text only shrinks); unknown references are kept as written. Returns
+// the new length.
+static size_t decode_entities(char *s, size_t len) {
+    static const struct { const char *name; char c; } named[] = {
+        { "amp", '&' }, { "lt", '<' }, { "gt", '>' }, { "quot", '"' }, { "apos", '\'' },
+    };
+    size_t in = 0, out = 0;
+    while (in < len) {
+        char *semi = s[in] == '&' ? memchr(s + in, ';', len - in) : NULL;
+        if (!semi || semi - (s + in) > 10) {
+            s[out++] = s[in++];
+            continue;
+        }
+        const char *ref = s + in + 1;
+        size_t ref_len = (size_t)(semi - ref);
+        size_t step = ref_len + 2;
+        if (ref_len >= 2 && ref[0] == '#') {
+            int hex = ref[1] == 'x' || ref[1] == 'X';
+            uint32_t c = 0;
+            size_t digits = 0;
+            for (size_t i = hex ? 2 : 1; i < ref_len && c <= 0x10FFFF; i++, digits++) {
+                int v = isdigit((unsigned char)ref[i]) ? ref[i] - '0' :
+                        hex && isxdigit((unsigned char)ref[i]) ? tolower((unsigned char)ref[i]) - 'a' + 10 : -1;
+                if (v < 0) {
+                    digits = 0;
+                    break;
+                }
+                c = c * (hex ? 16 : 10) + (uint32_t)v;
+            }
+            // A reference is at least as long as its UTF-8 encoding
+            if (digits && c && c <= 0x10FFFF) {
+                out += put_utf8(s + out, c);
+                in += step;
+                continue;
+            }
+        } else {
+            size_t k = 0;
+            while (k < sizeof(named) / sizeof(named[0]) &&
+                   !(strlen(named[k].name) == ref_len && memcmp(named[k].name, ref, ref_len) == 0)) {
+                k++;
+            }
+            if (k < sizeof(named) / sizeof(named[0])) {
+                s[out++] = named[k].c;
+                in += step;
+                continue;
+            }
+        }
+        s[out++] = s[in++];
+    }
+    return out;
+}
+
+#define XML_MAX_ATTRS 16
+
+typedef struct {
+    const char *name;
+    size_t name_len;
+    const char *value;
+    size_t value_len;
+} XmlAttr;
+
+typedef struct {
+    const char *name;
+    size_t name_len;
+    XmlAttr attrs[XML_MAX_ATTRS];
+    int attr_count;
+    int empty;                   // <.../>
+} XmlStartTag;
+
+static int span_is(const char *s, size_t len, const char *want) {
+    return strlen(want) == len && memcmp(s, want, len) == 0;
+}
+
+// Value of attribute name, or "" (len 0) when the element lacks it
+static const char *attr(const XmlStartTag *tag, const char *name, size_t *len) {
+    for (int a = 0; a < tag->attr_count; a++) {
+        if (span_is(tag->attrs[a].name, tag->attrs[a].name_len, name)) {
+            *len = tag->attrs[a].value_len;
+            return tag->attrs[a].value;
+        }
+    }
+    *len = 0;
+    return "";
+}
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parse the start tag whose name begins at p, decoding attribute values
+// in place. Returns the character after its '>', or NULL if the document
+// ends inside it.
+static char *parse_start_tag(char *p, char *end, XmlStartTag *tag) {
+    tag->name = p;
+    while (p < end && !is_space(*p) && *p != '/' && *p != '>') p++;
+    tag->name_len = (size_t)(p - tag->name);
+    tag->attr_count = 0;
+    tag->empty = 0;
+    for (;;) {
+        while (p < end && is_space(*p)) p++;
+        if (p >= end) {
+            return NULL;
+        }
+        if (*p == '>') {
+            return p + 1;
+        }
+        if (*p == '/') {
+            tag->empty = 1;
+            p++;
+            continue;
+        }
+        const char *name = p;
+        while (p < end && !is_space(*p) && *p != '=' && *p != '/' && *p != '>') p++;
+        size_t name_len = (size_t)(p - name);
+        while (p < end && is_space(*p)) p++;
+        if (p >= end || *p != '=') {
+            continue;                // Not name="value"; step over it
+        }
+        p++;
+        while (p < end && is_space(*p)) p++;
+        if (p >= end || (*p != '"' && *p != '\'')) {
+            continue;
+        }
+        char quote = *p++;
+        char *value = p;
+        char *close = memchr(p, quote, (size_t)(end - p));
+        if (!close) {
+            return NULL;
+        }
+        p = close + 1;
+        if (tag->attr_count < XML_MAX_ATTRS) {
+            XmlAttr *a = &tag->attrs[tag->attr_count++];
+            a->name = name;
+            a->name_len = name_len;
+            a->value = value;
+            a->value_len = decode_entities(value, (size_t)(close - value));
+        }
+    }
+}
+
+// Up to 3 array dimensions from "10", "2 3" or "2,3,4"
+static void parse_dims(const char *s, size_t len, uint32_t dims[3]) {
+    dims[0] = dims[1] = dims[2] = 0;
+    int d = 0;
+    for (size_t i = 0; i < len && d < 3;) {
+        if (!isdigit((unsigned char)s[i])) {
+            i++;
+            continue;
+        }
+        uint64_t v = 0;
+        while (i < len && isdigit((unsigned char)s[i])) {
+            v = v * 10 + (uint64_t)(s[i++] - '0');
+            if (v > UINT32_MAX) v = UINT32_MAX;
+        }
+        dims[d++] = (uint32_t)v;
+    }
+}
+
+static TagAccess parse_access(const char *s, size_t len) {
+    if (len == 9 && strncasecmp(s, "Read Only", 9) == 0) return TAG_ACCESS_READ_ONLY;
+    if (len == 4 && strncasecmp(s, "None", 4) == 0) return TAG_ACCESS_NONE;
+    return TAG_ACCESS_READ_WRITE;
+}
+
+typedef struct {
+    TagTable *table;
+    int depth;
+    int program_depth;           // Depth of the open Program element, 0 = none
+    uint32_t program_scope;
+    int datatype_depth;          // Depth of the open DataType element, 0 = none
+    int tags;
+} TagDecode;
+
+// One start tag at the current depth; 0, or -1 on allocation failure
+static int decode_element(TagDecode *d, const XmlStartTag *tag) {
+    TagTable *table = d->table;
+    size_t name_len, type_len, len;
+    const char *name = attr(tag, "Name", &name_len);
+
+    if (span_is(tag->name, tag->name_len, "Tag")) {
+        if (d->datatype_depth) {
+            return 0;
+        }
+        const char *type = attr(tag, "DataType", &type_len);
+        const char *dims_text = attr(tag, "Dimensions", &len);
+        uint32_t dims[3];
+        parse_dims(dims_text, len, dims);
+        const char *access = attr(tag, "ExternalAccess", &len);
+        TagAccess access_value = parse_access(access, len);
+        const char *alias = attr(tag, "AliasFor", &len);
+
+        uint32_t scope = d->program_depth ? d->program_scope : TAG_SCOPE_CONTROLLER;
+        size_t scope_len;
+        const char *scope_text = attr(tag, "Scope", &scope_len);
+        if (!d->program_depth && scope_len && !(scope_len == 10 && strncasecmp(scope_text, "Controller", 10) == 0)) {
+            scope = tag_table_add_program(table, scope_text, scope_len);
+            if (scope == TAG_SCOPE_ANY) return -1;
+        }
+        if (tag_table_add(table, name, name_len, type, type_len, dims, scope, access_value, alias, len) < 0) {
+            return -1;
+        }
+        d->tags++;
+    } else if (span_is(tag->name, tag->name_len, "Member")) {
+        if (!d->datatype_depth) {
+            return 0;
+        }
+        const char *type = attr(tag, "DataType", &type_len);
+        const char *dim = attr(tag, "Dimension", &len);
+        uint32_t dims[3];
+        parse_dims(dim, len, dims);
+        const char *hidden = attr(tag, "Hidden", &len);
+        if (tag_table_add_member(table, name, name_len, type, type_len, dims[0],
+                                 len == 4 && strncasecmp(hidden, "true", 4) == 0) < 0) {
+            return -1;
+        }
+    } else if (span_is(tag->name, tag->name_len, "DataType")) {
+        if (d->datatype_depth) {
+            return 0;
+        }
+        size_t class_len;
+        const char *family = attr(tag, "Family", &len);
+        const char *cls = attr(tag, "Class", &class_len);
+        if (tag_table_add_datatype(table, name, name_len, family, len, cls, class_len) < 0) {
+            return -1;
+        }
+        if (!tag->empty) d->datatype_depth = d->depth;
+    } else if (span_is(tag->name, tag->name_len, "Program")) {
+        if (d->program_depth) {
+            return 0;
+        }
+        d->program_scope = tag_table_add_program(table, name, name_len);
+        if (d->program_scope == TAG_SCOPE_ANY) {
+            return -1;
+        }
+        if (!tag->empty) d->program_depth = d->depth;
+    } else if (span_is(tag->name, tag->name_len, "Controller")) {
+        if (!table->controller_name && name_len) {
+            StrRef ref;
+            if (string_pool_intern(&table->strings, name, name_len, &ref) != 0) {
+                return -1;
+            }
+            table->controller_name = ref.offset;
+        }
+    }
+    return 0;
+}
+
+// Skip from p past the first occurrence of terminator; NULL if absent
+static char *skip_past(char *p, char *end, const char *terminator) {
+    size_t n = strlen(terminator);
+    while ((size_t)(end - p) >= n) {
+        char *hit = memchr(p, terminator[0], (size_t)(end - p) - n + 1);
+        if (!hit) break;
+        if (memcmp(hit, terminator, n) == 0) {
+            return hit + n;
+        }
+        p = hit + 1;
+    }
+    return NULL;
+}
+
+// Walk every markup construct of doc; the number of tags, or -1
+static int decode_document(TagTable *table, char *doc, size_t len) {
+    TagDecode d = { .table = table };
+    char *p = doc, *end = doc + len;
+    while ((p = memchr(p, '<', (size_t)(end - p))) != NULL && ++p < end) {
+        if (*p == '?') {
+            p = skip_past(p, end, "?>");
+        } else if ((size_t)(end - p) >= 3 && memcmp(p, "!--", 3) == 0) {
+            p = skip_past(p + 3, end, "-->");
+        } else if ((size_t)(end - p) >= 8 && memcmp(p, "![CDATA[", 8) == 0) {
+            p = skip_past(p + 8, end, "]]>");
+        } else if (*p == '!') {
+            p = skip_past(p, end, ">");
+        } else if (*p == '/') {
+            p = skip_past(p, end, ">");
+            if (d.depth == d.program_depth) d.program_depth = 0;
+            if (d.depth == d.datatype_depth) d.datatype_depth = 0;
+            if (d.depth > 0) d.depth--;
+        } else {
+            XmlStartTag tag;
+            p = parse_start_tag(p, end, &tag);
+            if (p) {
+                d.depth++;
+                if (decode_element(&d, &tag) != 0) {
+                    return -1;
+                }
+                if (tag.empty) d.depth--;
+            }
+        }
+        if (!p) {
+            if (!acd_quiet) printf("   ⚠️  TagInfo.XML ends inside markup; decoded what came before\n");
+            break;
+        }
+    }
+    return d.tags;
+}
+
+int parse_tag_block(TagTable *table, const unsigned char *data, size_t size) {
+    size_t i = 0;
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) i = 2;
+    else if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) i = 3;
+    while (i < size && is_space((char)data[i])) i++;
+    if (i >= size || data[i] != '<') {
+        return 0;                    // Not an XML document
+    }
+
+    uint64_t start = acd_now_ns();
+    size_t len;
+    char *doc = document_utf8(data, size, &len);
+    if (!doc) {
+        return -1;
+    }
+    int decoded = decode_document(table, doc, len);
+    free(doc);
+    acd_stat_time(&acd_stats.parse_ns, start);
+    if (decoded > 0) acd_stat_add(&acd_stats.tags, (uint64_t)decoded);
+    return decoded;
+}
+
+typedef struct {
+    TagTable *table;
+    long tags;
+    int failed;
+} TagsParse;
+
+static int tags_block_handler(const CompressedBlock *block, const unsigned char *data,
+                              size_t size, void *ctx) {
+    TagsParse *parse = ctx;
+    size_t defs = parse->table->def_count;
+    int decoded = parse_tag_block(parse->table, data, size);
+    if (decoded < 0) {
+        parse->failed = 1;
+        return -1;
+    }
+    if ((decoded > 0 || parse->table->def_count > defs) && !acd_quiet) {
+        printf("🏷️  TagInfo.XML block at offset 0x%lx: %d tags, %zu data types\n", block->offset, decoded,
+               parse->table->def_count - defs);
+    }
+    parse->tags += decoded;
+    return 0;
+}
+
+long parse_acd_tags(TagTable *table, const ACD_File *acd, const CompressedBlock *blocks, size_t count) {
+    TagsParse parse = { .table = table };
+    BlockRoute routes[] = {
+        { "tags", TAGINFO_SIGNATURE, TAGINFO_WINDOW, tags_block_handler, &parse },
+    };
+    if (acd_pipeline_run(acd, blocks, count, routes, sizeof(routes) / sizeof(routes[0]), NULL) != 0 ||
+        parse.failed) {
+        return -1;
+    }
+    return parse.tags;
+}
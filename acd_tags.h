@@ -0,0 +1,172 @@
+#ifndef ACD_TAGS_H
+#define ACD_TAGS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "acd_file.h"
+#include "acd_block.h"
+#include "acd_store.h"
+
+// TagInfo.XML decoder with columnar storage
+//
+// A project's tags, data types and programs are described by TagInfo.XML,
+// which the ACD stores as a UTF-16LE document with a byte order mark (a
+// UTF-8 document is accepted too when decoded directly). The decoder is a
+// streaming tokenizer, not a general XML parser: it reads the elements and
+// attributes below and steps over everything else.
+//   Controller  Name                               controller_name
+//   DataType    Name, Family, Class                a data type definition
+//     Member    Name, DataType, Dimension, Hidden  one of its members
+//   Program     Name                               scope of the Tags inside it
+//   Tag         Name, DataType, Dimensions, ExternalAccess, AliasFor, Scope
+// A tag's scope is the Program element enclosing it, or else its Scope
+// attribute naming a program; neither (or Scope="Controller") is
+// controller scope. Not decoded: Modules, Routines and their logic,
+// Add-On Instruction definitions, descriptions and comments, tag values
+// (Data elements), produced/consumed connection details, and bit members'
+// Target / BitNumber.
+//
+// Tags are kept as one array per column rather than one struct per tag,
+// so a query touches only the columns it filters on: selecting every
+// TIMER of one program reads 8 bytes per tag. Definitions keep their
+// members in CSR form: the members of definition d are
+// member_*[def_member_start[d] .. def_member_start[d + 1]).
+
+#define TAG_SCOPE_CONTROLLER 0u
+#define TAG_SCOPE_ANY UINT32_MAX
+#define TAG_TYPE_ANY UINT32_MAX
+
+typedef enum {
+    TAG_ACCESS_READ_WRITE = 0,
+    TAG_ACCESS_READ_ONLY = 1,
+    TAG_ACCESS_NONE = 2
+} TagAccess;
+
+typedef struct {
+    size_t count;
+    size_t capacity;
+
+    // Columns, count entries each
+    uint32_t *name;              // Offset of the NUL-terminated name in strings
+    uint32_t *type;              // Index into type_name
+    uint32_t *dim0;
+    uint32_t *dim1;
+    uint32_t *dim2;
+    uint32_t *scope;             // Program index + 1, TAG_SCOPE_CONTROLLER
+    uint8_t *access;             // TagAccess
+    uint32_t *alias;             // AliasFor operand in strings; 0 = base tag
+
+    // Distinct data type names; a type id is an index here
+    uint32_t *type_name;         // Offsets in strings
+    size_t type_count;
+    size_t type_capacity;
+    uint32_t *type_slots;        // Open addressing: string offset -> type id + 1
+    size_t type_slot_count;      // Power of two
+
+    // Programs in document order
+    uint32_t *program_name;      // Offsets in strings
+    size_t program_count;
+    size_t program_capacity;
+
+    // Data type definitions
+    uint32_t *def_type;          // Type id of the defined name
+    uint32_t *def_family;        // Offsets in strings ("NoFamily", "StringFamily")
+    uint32_t *def_class;         // ("User", "ProductDefined", ...)
+    uint32_t *def_member_start;  // def_count + 1 entries once a definition is added
+    size_t def_count;
+    size_t def_capacity;
+
+    // Members of the definitions, in definition order
+    uint32_t *member_name;       // Offsets in strings
+    uint32_t *member_type;       // Type id
+    uint32_t *member_dim;        // Array length, 0 = scalar
+    uint8_t *member_hidden;      // Hidden="true" (e.g. the host of BIT members)
+    size_t member_count;
+    size_t member_capacity;
+
+    uint32_t controller_name;    // Offset in strings; 0 = none seen
+
+    StringPool strings;
+} TagTable;
+
+int tag_table_init(TagTable *table);
+void tag_table_free(TagTable *table);
+
+// Make room for n more tags (one allocation per column)
+int tag_table_reserve(TagTable *table, size_t n);
+
+// Append one tag; dims may be NULL, alias "" for a base tag. Returns its
+// index, or -1 on allocation failure.
+long tag_table_add(TagTable *table, const char *name, size_t name_len, const char *type,
+                   size_t type_len, const uint32_t *dims, uint32_t scope, TagAccess access,
+                   const char *alias, size_t alias_len);
+
+// Scope value of the program spelled name (case-insensitive), adding it
+// on first sight; TAG_SCOPE_ANY on allocation failure
+uint32_t tag_table_add_program(TagTable *table, const char *name, size_t len);
+
+// Scope value of an existing program, or TAG_SCOPE_ANY if there is none
+uint32_t tag_table_program_scope(const TagTable *table, const char *name);
+
+// Append a data type definition; its members are the ones added next.
+// Returns its index, or -1 on allocation failure.
+long tag_table_add_datatype(TagTable *table, const char *name, size_t name_len, const char *family,
+                            size_t family_len, const char *cls, size_t class_len);
+
+// Append a member to the last definition added. Returns its index, or -1
+// on allocation failure or when there is no definition yet.
+long tag_table_add_member(TagTable *table, const char *name, size_t name_len, const char *type,
+                          size_t type_len, uint32_t dim, int hidden);
+
+// Definition of a type id, or -1 for an atomic or undefined type
+long tag_table_find_datatype(const TagTable *table, uint32_t type);
+
+static inline const char *tag_name(const TagTable *table, size_t i) {
+    return table->strings.data + table->name[i];
+}
+
+static inline const char *tag_type_name(const TagTable *table, uint32_t type) {
+    return table->strings.data + table->type_name[type];
+}
+
+static inline const char *tag_str(const TagTable *table, uint32_t offset) {
+    return table->strings.data + offset;
+}
+
+// Program name for a scope value; "" for controller scope
+static inline const char *tag_scope_name(const TagTable *table, uint32_t scope) {
+    return scope ? table->strings.data + table->program_name[scope - 1] : "";
+}
+
+// Number of dimensions of tag i (0 for a scalar)
+static inline int tag_dimensions(const TagTable *table, size_t i) {
+    return table->dim2[i] ? 3 : table->dim1[i] ? 2 : table->dim0[i] ? 1 : 0;
+}
+
+// Type id of a data type name (case-insensitive, as in Logix), or
+// TAG_TYPE_ANY when no tag, definition or member uses it
+uint32_t tag_table_type_id(const TagTable *table, const char *type);
+
+// Indices of the tags matching type (TAG_TYPE_ANY) and scope
+// (TAG_SCOPE_ANY), in table order. Writes up to max of them to out (which
+// may be NULL to count) and returns the total number of matches.
+size_t tag_table_select(const TagTable *table, uint32_t type, uint32_t scope, uint32_t *out, size_t max);
+
+const char *tag_access_name(uint8_t access);
+
+// Decode a TagInfo.XML document held in one decompressed block, appending
+// to table. Returns the number of tags decoded (0 for a block that is not
+// an XML document or holds none), or -1 on allocation failure.
+int parse_tag_block(TagTable *table, const unsigned char *data, size_t size);
+
+// Decode the TagInfo.XML blocks of a whole ACD through the block pipeline
+// (blocks may be NULL to scan for them). Returns the number of tags or -1.
+long parse_acd_tags(TagTable *table, const ACD_File *acd, const CompressedBlock *blocks, size_t count);
+
+// Pipeline route for TagInfo.XML: a byte order mark and '<' opening the
+// block (UTF-16LE XML), so the window is the signature itself
+#define TAGINFO_SIGNATURE "\xFF\xFE<"
+#define TAGINFO_WINDOW 3
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_xml.h"
+
+#define DEFAULT_CAPACITY (1024 * 1024)
+
+// Replacement text per byte, NULL if the byte is copied as is. Control
+// bytes other than TAB/LF/CR can't appear in XML 1.0 at all and are
+// dropped. The tables are constant, so writers on several threads share them.
+#define CONTROL_ESCAPES \
+    [0x00] = "", [0x01] = "", [0x02] = "", [0x03] = "", [0x04] = "", \
+    [0x05] = "", [0x06] = "", [0x07] = "", [0x08] = "", [0x0B] = "", \
+    [0x0C] = "", [0x0E] = "", [0x0F] = "", [0x10] = "", [0x11] = "", \
+    [0x12] = "", [0x13] = "", [0x14] = "", [0x15] = "", [0x16] = "", \
+    [0x17] = "", [0x18] = "", [0x19] = "", [0x1A] = "", [0x1B] = "", \
+    [0x1C] = "", [0x1D] = "", [0x1E] = "", [0x1F] = ""
+
+static const char *const text_escape[256] = {
+    CONTROL_ESCAPES,
+    ['&'] = "&amp;", ['<'] = "&lt;", ['>'] = "&gt;",
+};
+
+static const char *const attr_escape[256] = {
+    CONTROL_ESCAPES,
+    ['&'] = "&amp;", ['<'] = "&lt;", ['>'] = "&gt;", ['"'] = "&quot;",
+    ['\t'] = "&#9;", ['\n'] = "&#10;", ['\r'] = "&#13;",
+};
+
+int xml_writer_init(XmlWriter *w, FILE *sink, size_t capacity) {
+    memset(w, 0, sizeof(*w));
+    w->sink = sink;
+    w->capacity = capacity ? capacity : DEFAULT_CAPACITY;
+    w->buf = malloc(w->capacity);
+    if (!w->buf) {
+        w->capacity = 0;
+        w->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+int xml_writer_flush(XmlWriter *w) {
+    if (w->sink && w->len) {
+        if (fwrite(w->buf, 1, w->len, w->sink) != w->len) {
+            w->error = 1;
+        }
+        w->flushed += w->len;
+        w->len = 0;
+    }
+    return w->error ? -1 : 0;
+}
+
+int xml_writer_close(XmlWriter *w) {
+    int ret = xml_writer_flush(w);
+    free(w->buf);
+    w->buf = NULL;
+    w->len = w->capacity = 0;
+    return ret;
+}
+
+// Make room for n more bytes: flush to the sink, or grow in memory mode
+static int reserve(XmlWriter *w, size_t n) {
+    if (w->capacity - w->len >= n) {
+        return 0;
+    }
+    if (w->sink) {
+        xml_writer_flush(w);
+        if (w->capacity >= n) {
+            return 0;
+        }
+    }
+    size_t capacity = w->capacity ? w->capacity : DEFAULT_CAPACITY;
+    while (capacity - w->len < n) capacity *= 2;
+    char *grown = realloc(w->buf, capacity);
+    if (!grown) {
+        w->error = 1;
+        return -1;
+    }
+    w->buf = grown;
+    w->capacity = capacity;
+    return 0;
+}
+
+void xml_write(XmlWriter *w, const char *data, size_t len) {
+    if (w->error) {
+        return;
+    }
+    // Large pieces go straight through once the buffer is out of the way
+    if (w->sink && len >= w->capacity) {
+        xml_writer_flush(w);
+        if (fwrite(data, 1, len, w->sink) != len) w->error = 1;
+        w->flushed += len;
+        return;
+    }
+    if (reserve(w, len) != 0) {
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void write_escaped(XmlWriter *w, const char *const *table, const char *s, size_t len) {
+    const unsigned char *p = (const unsigned char *)s;
+    size_t run = 0;
+    for (size_t i = 0; i < len; i++) {
+        const char *escape = table[p[i]];
+        if (!escape) continue;
+        if (i > run) xml_write(w, s + run, i - run);
+        xml_puts(w, escape);
+        run = i + 1;
+    }
+    if (len > run) xml_write(w, s + run, len - run);
+}
+
+void xml_text(XmlWriter *w, const char *s, size_t len) {
+    write_escaped(w, text_escape, s, len);
+}
+
+void xml_attr_value(XmlWriter *w, const char *s, size_t len) {
+    write_escaped(w, attr_escape, s, len);
+}
+
+void xml_attr(XmlWriter *w, const char *name, const char *value, size_t len) {
+    xml_write(w, " ", 1);
+    xml_puts(w, name);
+    xml_write(w, "=\"", 2);
+    xml_attr_value(w, value, len);
+    xml_write(w, "\"", 1);
+}
+
+void xml_uint(XmlWriter *w, unsigned long long value) {
+    char digits[24];
+    size_t n = sizeof(digits);
+    do {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    xml_write(w, digits + n, sizeof(digits) - n);
+}
+
+void xml_cdata(XmlWriter *w, const char *s, size_t len) {
+    xml_write(w, "<![CDATA[", 9);
+    size_t run = 0;
+    for (size_t i = 0; i + 3 <= len; i++) {
+        if (s[i] == ']' && s[i + 1] == ']' && s[i + 2] == '>') {
+            // End the section between "]]" and ">" and reopen it
+            xml_write(w, s + run, i + 2 - run);
+            xml_write(w, "]]><![CDATA[", 12);
+            run = i + 2;
+        }
+    }
+    xml_write(w, s + run, len - run);
+    xml_write(w, "]]>", 3);
+}
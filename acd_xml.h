@@ -0,0 +1,63 @@
+#ifndef ACD_XML_H
+#define ACD_XML_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Streaming XML emitter. Output collects in one large buffer that is
+// flushed to the sink in big writes; with no sink the buffer just grows,
+// so a section can be rendered in memory and appended elsewhere later.
+// Escaping goes through precomputed per-byte tables: runs of bytes that
+// need nothing are copied with a single memcpy.
+typedef struct {
+    FILE *sink;                  // NULL = memory only
+    char *buf;
+    size_t len;
+    size_t capacity;
+    unsigned long long flushed;  // Bytes already handed to the sink
+    int error;                   // Sticky: allocation or write failure
+} XmlWriter;
+
+// capacity 0 picks the default (1 MB)
+int xml_writer_init(XmlWriter *w, FILE *sink, size_t capacity);
+
+// Flush to the sink (no-op in memory mode). Returns 0 or -1.
+int xml_writer_flush(XmlWriter *w);
+
+// Flush and release the buffer; returns -1 if any write failed
+int xml_writer_close(XmlWriter *w);
+
+// Bytes written so far, flushed or still buffered
+static inline unsigned long long xml_writer_total(const XmlWriter *w) {
+    return w->flushed + w->len;
+}
+
+void xml_write(XmlWriter *w, const char *data, size_t len);
+
+static inline void xml_puts(XmlWriter *w, const char *s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    xml_write(w, s, n);
+}
+
+// Character data: escapes & < >
+void xml_text(XmlWriter *w, const char *s, size_t len);
+
+// Attribute value: escapes & < > " and tabs/newlines
+void xml_attr_value(XmlWriter *w, const char *s, size_t len);
+
+// ` name="value"` with the value escaped
+void xml_attr(XmlWriter *w, const char *name, const char *value, size_t len);
+
+// Decimal unsigned number
+void xml_uint(XmlWriter *w, unsigned long long value);
+
+// <![CDATA[...]]>, splitting any "]]>" inside s
+void xml_cdata(XmlWriter *w, const char *s, size_t len);
+
+// Append another (memory) writer's output
+static inline void xml_append(XmlWriter *w, const XmlWriter *part) {
+    xml_write(w, part->buf, part->len);
+}
+
+#endif
@@ -0,0 +1,1256 @@
+// Stage-by-stage benchmark of the ACD pipeline
+//
+// Times each stage on its own, so a regression shows up in the stage that
+// caused it rather than as a blur in the end-to-end number:
+//   header    binary start detection and text header parse
+//   scan      gzip magic scan over the binary region (every candidate)
+//   validate  acd_gzip_check on every candidate
+//   index     block index build (scan, validate, probe)
+//   inflate   decode of every indexed member (known sizes)
+//   seek      scattered 4 KB reads inside the largest member (checkpoints)
+//   comps     Comps database parse of the Comps block(s)
+//   tags      TagInfo database decode into the columnar tag table
+//   tag_query selection of every TIMER tag of one program
+//   rungs     RungCode decode into neutral rung text (--jobs threads)
+//   l5x       L5X emission of the parsed tree
+// Each stage repeats until --min-time has passed (and at least
+// --iterations times) and prints one JSON object per line on stdout. The
+// library's own progress output is discarded while timing.
+//
+// Runs on the given files, or on a synthetic file generated in memory
+// (acd_synth.h) when none are given; --verify runs the checks above
+// verify_corpus instead of timing:
+//   cc -O2 -I. -o acd_bench bench/acd_bench.c bench/acd_synth.c acd_*.c -lz -pthread
+//   ./acd_bench [--verify] [--iterations N] [--min-time S] [--jobs N] [--label TEXT]
+//               [--size MB] [--blocks N] [--programs N] [--tags N] [--routines N]
+//               [--rungs N] [--false-positives N] [--seed N] [file.ACD...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "acd.h"
+#include "acd_synth.h"
+
+// Fixed so every run emits the same bytes
+#define BENCH_EXPORT_DATE "Mon Jan 01 00:00:00 2024"
+
+typedef struct {
+    const char *name;            // Path, or "synthetic"
+    const SynthOptions *synth;   // What generated it; NULL for a file
+    ACD_File acd;
+    CompressedBlock *blocks;
+    size_t count;
+    long *candidates;            // Every magic hit in the binary region
+    size_t candidate_count;
+    CompressedBlock *comps;      // Decoded Comps blocks, so only the parse is timed
+    size_t comps_count;
+    CompressedBlock *tag_blocks; // Decoded TagInfo blocks
+    size_t tag_block_count;
+    TagTable tags;               // Decoded once, for tag_query
+    CompressedBlock *rung_blocks; // Decoded RungCode blocks
+    size_t rung_block_count;
+    RungTable rungs;             // Decoded once, for the l5x stage
+    ComponentStore store;        // Parsed once, for the l5x stage
+    size_t l5x_bytes;
+    InflateContext ctx;
+    BlockReader reader;          // Largest member, checkpoints recorded in advance
+    int reader_open;
+} Corpus;
+
+typedef struct {
+    int min_iterations;
+    double min_time;
+    int jobs;
+    const char *label;
+    FILE *json;                  // Real stdout
+    FILE *null;                  // Sink for the l5x stage
+} BenchConfig;
+
+// What one iteration of a stage processed
+typedef struct {
+    size_t bytes;
+    size_t items;
+} BenchWork;
+
+typedef int (*BenchStage)(Corpus *corpus, const BenchConfig *config, BenchWork *work);
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t binary_length(const Corpus *c) {
+    return (size_t)(c->acd.file_size - c->acd.binary_start);
+}
+
+static int stage_header(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    ACD_Header header;
+    long start = acd_find_binary_start(&c->acd);
+    ACD_File view = c->acd;
+    view.binary_start = start;
+    if (acd_header_parse(&view, &header) != 0) {
+        return -1;
+    }
+    work->bytes = (size_t)start;
+    work->items = header.count;
+    acd_header_free(&header);
+    return 0;
+}
+
+static int stage_scan(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    const unsigned char *region = c->acd.data + c->acd.binary_start;
+    size_t len = binary_length(c), hits = 0;
+    for (size_t pos = acd_scan_next_gzip(region, len, 0); pos < len;
+         pos = acd_scan_next_gzip(region, len, pos + 1)) {
+        hits++;
+    }
+    work->bytes = len;
+    work->items = hits;
+    return 0;
+}
+
+static volatile size_t validate_sink;
+
+static int stage_validate(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    size_t accepted = 0;
+    for (size_t i = 0; i < c->candidate_count; i++) {
+        long offset = c->candidates[i];
+        accepted += acd_gzip_check(c->acd.data + offset, (size_t)(c->acd.file_size - offset)) ==
+                    GZIP_CANDIDATE_OK;
+    }
+    validate_sink = accepted;
+    // Throughput here is per candidate (items_per_s), not per byte
+    work->bytes = 0;
+    work->items = c->candidate_count;
+    return 0;
+}
+
+static int stage_index(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    CompressedBlock *blocks;
+    size_t count;
+    if (acd_index_build(&c->acd, &blocks, &count) != 0) {
+        return -1;
+    }
+    free(blocks);
+    work->bytes = binary_length(c);
+    work->items = count;
+    return 0;
+}
+
+static int stage_inflate(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    work->bytes = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        CompressedBlock block = c->blocks[i];
+        if (acd_block_inflate_ctx(&c->ctx, &c->acd, &block) != Z_STREAM_END) {
+            return -1;
+        }
+        work->bytes += block.uncompressed_size;
+        acd_block_free(&block);
+    }
+    work->items = c->count;
+    return 0;
+}
+
+#define SEEK_READS 64
+#define SEEK_LENGTH 4096
+
+static int stage_seek(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    unsigned char buf[SEEK_LENGTH];
+    uint64_t size = acd_block_size(&c->reader);
+    work->bytes = 0;
+    work->items = 0;
+    if (!c->reader_open || !size) {
+        return 0;
+    }
+    // A fixed stride coprime with the read count, so every iteration
+    // seeks back and forth over the whole member the same way
+    for (size_t k = 0; k < SEEK_READS; k++) {
+        uint64_t offset = (k * 37 % SEEK_READS) * (size / SEEK_READS);
+        long n = acd_block_read(&c->reader, offset, buf, sizeof(buf));
+        if (n < 0) {
+            return -1;
+        }
+        work->bytes += (size_t)n;
+    }
+    work->items = SEEK_READS;
+    return 0;
+}
+
+static int stage_comps(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    ComponentStore store;
+    if (component_store_init(&store) != 0) {
+        return -1;
+    }
+    work->bytes = 0;
+    for (size_t i = 0; i < c->comps_count; i++) {
+        const CompressedBlock *block = &c->comps[i];
+        if (parse_block(&store, block->data, block->uncompressed_size) < 0) {
+            component_store_free(&store);
+            return -1;
+        }
+        work->bytes += block->uncompressed_size;
+    }
+    work->items = store.count;
+    component_store_free(&store);
+    return 0;
+}
+
+static int stage_tags(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    TagTable table;
+    if (tag_table_init(&table) != 0) {
+        return -1;
+    }
+    work->bytes = 0;
+    for (size_t i = 0; i < c->tag_block_count; i++) {
+        const CompressedBlock *block = &c->tag_blocks[i];
+        if (parse_tag_block(&table, block->data, block->uncompressed_size) < 0) {
+            tag_table_free(&table);
+            return -1;
+        }
+        work->bytes += block->uncompressed_size;
+    }
+    work->items = table.count;
+    tag_table_free(&table);
+    return 0;
+}
+
+// Scope of the first program tag (any TIMER scope will do), else any
+static uint32_t query_scope(const TagTable *tags) {
+    for (size_t i = 0; i < tags->count; i++) {
+        if (tags->scope[i] != TAG_SCOPE_CONTROLLER) return tags->scope[i];
+    }
+    return TAG_SCOPE_ANY;
+}
+
+static int stage_tag_query(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    (void)config;
+    uint32_t type = tag_table_type_id(&c->tags, "TIMER");
+    size_t matches = tag_table_select(&c->tags, type, query_scope(&c->tags), NULL, 0);
+    // Columns the query reads: type and scope
+    work->bytes = c->tags.count * 2 * sizeof(uint32_t);
+    work->items = c->tags.count;
+    return matches > c->tags.count ? -1 : 0;
+}
+
+static int stage_rungs(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    RungTable table;
+    rung_table_init(&table);
+    work->bytes = 0;
+    for (size_t i = 0; i < c->rung_block_count; i++) {
+        const CompressedBlock *block = &c->rung_blocks[i];
+        if (parse_rung_block(&table, block->data, block->uncompressed_size, config->jobs) < 0) {
+            rung_table_free(&table);
+            return -1;
+        }
+        work->bytes += block->uncompressed_size;
+    }
+    work->items = table.count;
+    rung_table_free(&table);
+    return 0;
+}
+
+static int stage_l5x(Corpus *c, const BenchConfig *config, BenchWork *work) {
+    XmlWriter w;
+    L5xOptions options = { .export_date = BENCH_EXPORT_DATE, .jobs = config->jobs, .rungs = &c->rungs };
+    if (xml_writer_init(&w, config->null, 0) != 0) {
+        return -1;
+    }
+    int ret = acd_l5x_write(&w, &c->store, &options);
+    if (xml_writer_close(&w) != 0 || ret != 0) {
+        return -1;
+    }
+    work->bytes = c->l5x_bytes;
+    work->items = c->store.count;
+    return 0;
+}
+
+static int run_stage(Corpus *c, const BenchConfig *config, const char *name, BenchStage stage) {
+    BenchWork work = {0};
+    // One untimed pass warms caches and allocators
+    if (stage(c, config, &work) != 0) {
+        fprintf(stderr, "❌ %s: %s stage failed\n", c->name, name);
+        return -1;
+    }
+    int iterations = 0;
+    double start = now_seconds(), elapsed = 0;
+    while (iterations < config->min_iterations || elapsed < config->min_time) {
+        if (stage(c, config, &work) != 0) {
+            fprintf(stderr, "❌ %s: %s stage failed\n", c->name, name);
+            return -1;
+        }
+        iterations++;
+        elapsed = now_seconds() - start;
+    }
+
+    fprintf(config->json, "{\"bench\":\"%s\",\"file\":\"%s\"", name, c->name);
+    if (config->label) {
+        fprintf(config->json, ",\"label\":\"%s\"", config->label);
+    }
+    fprintf(config->json, ",\"bytes\":%zu,\"items\":%zu,\"iterations\":%d,\"seconds\":%.6f,"
+                          "\"ns_per_iteration\":%.0f,\"mb_per_s\":%.1f,\"items_per_s\":%.0f}\n",
+            work.bytes, work.items, iterations, elapsed, elapsed * 1e9 / iterations,
+            elapsed > 0 ? (double)work.bytes * iterations / elapsed / 1e6 : 0.0,
+            elapsed > 0 ? (double)work.items * iterations / elapsed : 0.0);
+    fflush(config->json);
+    return 0;
+}
+
+// Index, candidate list, decoded Comps blocks, parsed store and L5X size,
+// built once before any stage is timed
+static int corpus_prepare(Corpus *c) {
+    inflate_context_init(&c->ctx);
+    c->acd.binary_start = acd_find_binary_start(&c->acd);
+    if (acd_index_build(&c->acd, &c->blocks, &c->count) != 0) {
+        return -1;
+    }
+
+    // One read through the largest member records its checkpoints
+    size_t largest = 0;
+    for (size_t i = 1; i < c->count; i++) {
+        if (c->blocks[i].uncompressed_size > c->blocks[largest].uncompressed_size) largest = i;
+    }
+    if (c->count && acd_block_open(&c->reader, &c->acd, c->blocks, c->count, c->blocks[largest].offset,
+                                   ACD_BLOCK_SPAN_DEFAULT / 4) == 0) {
+        unsigned char tail;
+        c->reader_open = acd_block_read(&c->reader, c->blocks[largest].uncompressed_size - 1, &tail, 1) == 1;
+    }
+
+    CandidateList list = {0};
+    if (acd_scan_gzip(c->acd.data + c->acd.binary_start, binary_length(c), c->acd.binary_start,
+                      &list) != 0) {
+        return -1;
+    }
+    c->candidates = list.offsets;
+    c->candidate_count = list.count;
+
+    c->comps = calloc(c->count ? c->count : 1, sizeof(CompressedBlock));
+    if (!c->comps) {
+        return -1;
+    }
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->blocks[i].kind != BLOCK_KIND_COMPS) continue;
+        CompressedBlock block = c->blocks[i];
+        if (acd_block_inflate(&c->acd, &block) == Z_STREAM_END) {
+            c->comps[c->comps_count++] = block;
+        }
+    }
+
+    c->tag_blocks = calloc(c->count ? c->count : 1, sizeof(CompressedBlock));
+    c->rung_blocks = calloc(c->count ? c->count : 1, sizeof(CompressedBlock));
+    if (!c->tag_blocks || !c->rung_blocks || tag_table_init(&c->tags) != 0) {
+        return -1;
+    }
+    rung_table_init(&c->rungs);
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->blocks[i].kind == BLOCK_KIND_COMPS) continue;
+        CompressedBlock block = c->blocks[i];
+        if (acd_block_inflate(&c->acd, &block) != Z_STREAM_END) continue;
+        if (parse_tag_block(&c->tags, block.data, block.uncompressed_size) > 0) {
+            c->tag_blocks[c->tag_block_count++] = block;
+        } else if (parse_rung_block(&c->rungs, block.data, block.uncompressed_size, 1) > 0) {
+            c->rung_blocks[c->rung_block_count++] = block;
+        } else {
+            acd_block_free(&block);
+        }
+    }
+
+    if (component_store_init(&c->store) != 0 ||
+        parse_acd_components(&c->store, &c->acd, c->blocks, c->count) < 0) {
+        return -1;
+    }
+
+    XmlWriter w;
+    L5xOptions options = { .export_date = BENCH_EXPORT_DATE, .rungs = &c->rungs };
+    if (xml_writer_init(&w, NULL, 0) != 0) {
+        return -1;
+    }
+    int ret = acd_l5x_write(&w, &c->store, &options);
+    c->l5x_bytes = w.len;
+    xml_writer_close(&w);
+    return ret;
+}
+
+static void corpus_free(Corpus *c) {
+    for (size_t i = 0; i < c->comps_count; i++) {
+        acd_block_free(&c->comps[i]);
+    }
+    free(c->comps);
+    for (size_t i = 0; i < c->tag_block_count; i++) {
+        acd_block_free(&c->tag_blocks[i]);
+    }
+    free(c->tag_blocks);
+    tag_table_free(&c->tags);
+    for (size_t i = 0; i < c->rung_block_count; i++) {
+        acd_block_free(&c->rung_blocks[i]);
+    }
+    free(c->rung_blocks);
+    rung_table_free(&c->rungs);
+    inflate_context_end(&c->ctx);
+    acd_block_close(&c->reader);
+    component_store_free(&c->store);
+    free(c->candidates);
+    free(c->blocks);
+    acd_file_close(&c->acd);
+}
+
+static int bench_corpus(Corpus *c, const BenchConfig *config) {
+    static const struct {
+        const char *name;
+        BenchStage stage;
+    } stages[] = {
+        { "header", stage_header },
+        { "scan", stage_scan },
+        { "validate", stage_validate },
+        { "index", stage_index },
+        { "inflate", stage_inflate },
+        { "seek", stage_seek },
+        { "comps", stage_comps },
+        { "tags", stage_tags },
+        { "tag_query", stage_tag_query },
+        { "rungs", stage_rungs },
+        { "l5x", stage_l5x },
+    };
+    if (corpus_prepare(c) != 0) {
+        fprintf(stderr, "❌ %s: cannot index\n", c->name);
+        return -1;
+    }
+    int status = 0;
+    for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+        if (run_stage(c, config, stages[i].name, stages[i].stage) != 0) {
+            status = -1;
+        }
+    }
+    return status;
+}
+
+// --verify: behavioural checks on the same corpora, one JSON line each
+// ({"verify":NAME,"file":...,"ok":true|false,"items":N[,"error":...]}),
+// and exit status 1 if any fails:
+//   head_peek       acd_block_inflate_until stops at a 4 KB limit into a
+//                   buffer already bigger than every member, and resumes
+//                   to the same bytes as a full inflate
+//   inflate_backend the compiled one-shot backend's in_used/out_used and
+//                   output against the zlib streaming path, for every
+//                   block, with the rest of the file readable past it
+//   block_read      scattered reads through acd_block_read, at checkpoint
+//                   spans 0, 4 KB and 64 KB and with and without the
+//                   index's sizes, give a full inflate's bytes, short
+//                   only at the member's end
+//   scan_prefilter  the scanning block iterator finds what the index
+//                   does, its candidate counts add up, and no candidate
+//                   acd_gzip_check rejects decodes
+//   paths_agree     separate Comps and RungCode passes, acd_export_collect
+//                   (as export, parse and batch run it), with --jobs and
+//                   with a cold and a warm component cache, give the same
+//                   L5X bytes and tags
+//   batch           two inputs with one L5X name both fail and write
+//                   nothing; the third converts to the same L5X
+//   columnar        every column of a written .acdcol reads back as the
+//                   tables it was written from
+//   diff            acd diff against the written copy finds nothing
+//                   changed (exit status 0); on the generated corpus,
+//                   against a revision with one more program, the
+//                   QuickInfo block is unchanged, the Comps, TagInfo and
+//                   RungCode blocks modified, and exactly the new
+//                   program's components added
+//   synthetic       (generated corpus only) the tags, programs, data
+//                   types, components and rungs the generator wrote
+#define VERIFY_HEAD 4096
+#define VERIFY_READS 24
+#define VERIFY_READ_MAX (80 * 1024)
+
+typedef struct {
+    Corpus *c;
+    const BenchConfig *config;
+    char dir[1024];              // Scratch directory for this corpus
+    char project[1100];          // The corpus written out there, dir/Project.ACD
+    L5xOptions l5x;              // From the header, with BENCH_EXPORT_DATE
+    char header_text[512];
+    XmlWriter reference;         // L5X of separate Comps and RungCode passes
+    size_t items;                // What the check covered
+    char why[512];               // Set on failure
+} Verify;
+
+typedef int (*VerifyCheck)(Verify *v);
+
+static int verify_fail(Verify *v, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(v->why, sizeof(v->why), fmt, ap);
+    va_end(ap);
+    return -1;
+}
+
+static int write_file(const char *path, const unsigned char *data, size_t size) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    int ok = fwrite(data, 1, size, f) == size;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+static void remove_tree(const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        unlink(path);
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        char child[2048];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        remove_tree(child);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+// L5X of store and rungs in memory, as every command renders it
+static int render_l5x(const Verify *v, const ComponentStore *store, const RungTable *rungs, int jobs,
+                      XmlWriter *w) {
+    L5xOptions options = v->l5x;
+    options.jobs = jobs;
+    options.rungs = rungs->count ? rungs : NULL;
+    if (xml_writer_init(w, NULL, 0) != 0) {
+        return -1;
+    }
+    return acd_l5x_write(w, store, &options) == 0 && !w->error ? 0 : -1;
+}
+
+static int same_bytes(const XmlWriter *w, const void *data, size_t size) {
+    return w->len == size && memcmp(w->buf, data, size) == 0;
+}
+
+static int verify_head_peek(Verify *v) {
+    Corpus *c = v->c;
+    size_t cap = VERIFY_HEAD;
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->blocks[i].uncompressed_size >= cap) cap = (size_t)c->blocks[i].uncompressed_size + 1;
+    }
+    cap *= 2;
+    unsigned char *buf = malloc(cap);
+    InflateContext ctx;
+    inflate_context_init(&ctx);
+    int status = buf ? 0 : verify_fail(v, "out of memory");
+    for (size_t i = 0; status == 0 && i < c->count; i++) {
+        CompressedBlock full = c->blocks[i], block = c->blocks[i];
+        if (acd_block_inflate_ctx(&c->ctx, &c->acd, &full) != Z_STREAM_END) {
+            status = verify_fail(v, "block at 0x%lx does not inflate", full.offset);
+            break;
+        }
+        size_t size = full.uncompressed_size, want = size < VERIFY_HEAD ? size : VERIFY_HEAD;
+        int ret = acd_block_inflate_begin(&ctx, &c->acd, &block);
+        if (ret == Z_OK) {
+            ret = acd_block_inflate_until(&ctx, &c->acd, &block, &buf, &cap, VERIFY_HEAD);
+        }
+        size_t head = ctx.strm.total_out;
+        if ((ret != Z_OK && ret != Z_STREAM_END) || head != want || memcmp(buf, full.data, head) != 0) {
+            status = verify_fail(v, "block at 0x%lx: a %d-byte peek gave %zu bytes (zlib %d), want the first %zu",
+                                 full.offset, VERIFY_HEAD, head, ret, want);
+        } else if ((ret = acd_block_inflate_until(&ctx, &c->acd, &block, &buf, &cap, SIZE_MAX)) != Z_STREAM_END ||
+                   ctx.strm.total_out != size || memcmp(buf, full.data, size) != 0 ||
+                   block.crc32 != full.crc32) {
+            status = verify_fail(v, "block at 0x%lx: resuming after the peek gave %lu bytes (zlib %d), want %zu",
+                                 full.offset, (unsigned long)ctx.strm.total_out, ret, size);
+        }
+        acd_block_free(&full);
+        v->items++;
+    }
+    inflate_context_end(&ctx);
+    free(buf);
+    return status;
+}
+
+static int verify_inflate_backend(Verify *v) {
+    Corpus *c = v->c;
+    AcdInflater *inflater = acd_inflater_create();
+    if (!inflater) {
+        return verify_fail(v, "cannot create the %s inflater", acd_inflate_backend());
+    }
+    int status = 0;
+    for (size_t i = 0; status == 0 && i < c->count; i++) {
+        // Sizes unknown: the streaming path finds them itself
+        CompressedBlock stream = { .offset = c->blocks[i].offset };
+        if (acd_block_inflate_ctx(&c->ctx, &c->acd, &stream) != Z_STREAM_END) {
+            status = verify_fail(v, "block at 0x%lx does not stream-inflate", stream.offset);
+            break;
+        }
+        size_t size = stream.uncompressed_size;
+        unsigned char *out = malloc(size ? size : 1);
+        const unsigned char *in = c->acd.data + stream.offset;
+        size_t rest = (size_t)(c->acd.file_size - stream.offset);
+        // Whole rest of the file readable, then exactly the member
+        const size_t avail[2] = { rest, stream.compressed_size };
+        for (int k = 0; out && status == 0 && k < 2; k++) {
+            size_t in_used = 0, out_used = 0;
+            AcdInflateResult ret = acd_inflater_gzip(inflater, in, avail[k], out, size ? size : 1,
+                                                     &in_used, &out_used);
+            if (ret != ACD_INFLATE_OK || in_used != stream.compressed_size || out_used != size ||
+                memcmp(out, stream.data, size) != 0) {
+                status = verify_fail(v, "block at 0x%lx, %zu bytes readable: %s gave %d, in_used %zu, "
+                                     "out_used %zu; zlib streaming used %u in, %zu out",
+                                     stream.offset, avail[k], acd_inflate_backend(), (int)ret, in_used,
+                                     out_used, stream.compressed_size, size);
+            }
+        }
+        if (!out) {
+            status = verify_fail(v, "out of memory");
+        } else if (status == 0 && (stream.compressed_size != c->blocks[i].compressed_size ||
+                                   stream.uncompressed_size != c->blocks[i].uncompressed_size ||
+                                   stream.crc32 != c->blocks[i].crc32)) {
+            status = verify_fail(v, "block at 0x%lx: streaming sizes/CRC differ from the index", stream.offset);
+        } else if (status == 0 && size > 0) {
+            size_t in_used, out_used;
+            if (acd_inflater_gzip(inflater, in, rest, out, size - 1, &in_used, &out_used) !=
+                ACD_INFLATE_SHORT_OUTPUT) {
+                status = verify_fail(v, "block at 0x%lx: a buffer one byte short is not SHORT_OUTPUT",
+                                     stream.offset);
+            }
+        }
+        free(out);
+        acd_block_free(&stream);
+        v->items++;
+    }
+    acd_inflater_destroy(inflater);
+    return status;
+}
+
+// Offsets either side of every 32 KB window and of the member's end, and
+// lengths up to past a window, picked by a fixed LCG so runs repeat
+static void read_plan(uint32_t *seed, uint64_t size, size_t k, uint64_t *offset, size_t *len) {
+    *seed = *seed * 1103515245u + 12345u;
+    uint32_t r = *seed >> 8;
+    switch (k) {
+    case 0: *offset = 0; *len = VERIFY_READ_MAX; return;                   // From the start
+    case 1: *offset = size > 7 ? size - 7 : 0; *len = 64; return;          // Across the end
+    case 2: *offset = size; *len = 16; return;                             // At the end
+    case 3: *offset = size + 1 + r % 4096; *len = 16; return;              // Past it
+    }
+    *offset = size ? r % size : 0;
+    if (k % 3 == 0 && *offset >= ACD_BLOCK_WINDOW) *offset -= *offset % ACD_BLOCK_WINDOW;
+    *len = 1 + (r >> 4) % VERIFY_READ_MAX;
+}
+
+static int verify_block_read(Verify *v) {
+    Corpus *c = v->c;
+    static const size_t spans[] = { 0, 4096, 65536 };
+    unsigned char *buf = malloc(VERIFY_READ_MAX);
+    int status = buf ? 0 : verify_fail(v, "out of memory");
+    for (size_t i = 0; status == 0 && i < c->count; i++) {
+        CompressedBlock full = c->blocks[i];
+        if (acd_block_inflate_ctx(&c->ctx, &c->acd, &full) != Z_STREAM_END) {
+            status = verify_fail(v, "block at 0x%lx does not inflate", full.offset);
+            break;
+        }
+        uint64_t size = full.uncompressed_size;
+        for (size_t s = 0; status == 0 && s < sizeof(spans) / sizeof(spans[0]); s++) {
+            for (int indexed = 1; status == 0 && indexed >= 0; indexed--) {
+                BlockReader r;
+                if (acd_block_open(&r, &c->acd, indexed ? c->blocks : NULL, indexed ? c->count : 0,
+                                   full.offset, spans[s]) != 0) {
+                    status = verify_fail(v, "block at 0x%lx does not open (span %zu, %s index)", full.offset,
+                                         spans[s], indexed ? "with" : "without");
+                    break;
+                }
+                uint32_t seed = (uint32_t)i + 1;
+                for (size_t k = 0; status == 0 && k < VERIFY_READS; k++) {
+                    uint64_t offset;
+                    size_t len;
+                    read_plan(&seed, size, k, &offset, &len);
+                    uint64_t want = offset >= size ? 0 : size - offset < len ? size - offset : len;
+                    long n = acd_block_read(&r, offset, buf, len);
+                    if (n < 0 || (uint64_t)n != want || (want && memcmp(buf, full.data + offset, (size_t)want) != 0)) {
+                        status = verify_fail(v, "block at 0x%lx (span %zu, %s index): %zu bytes at %llu gave "
+                                             "%ld, want %llu bytes of the full inflate",
+                                             full.offset, spans[s], indexed ? "with" : "without", len,
+                                             (unsigned long long)offset, n, (unsigned long long)want);
+                    }
+                    v->items++;
+                }
+                if (status == 0 && acd_block_size(&r) != size) {
+                    status = verify_fail(v, "block at 0x%lx: reader size %llu, want %llu", full.offset,
+                                         (unsigned long long)acd_block_size(&r), (unsigned long long)size);
+                }
+                acd_block_close(&r);
+            }
+        }
+        acd_block_free(&full);
+    }
+    free(buf);
+    return status;
+}
+
+static int verify_scan_prefilter(Verify *v) {
+    Corpus *c = v->c;
+    acd_stats_reset();
+    BlockIter it;
+    if (acd_block_iter_open(&it, &c->acd, NULL, 0) != 0) {
+        return verify_fail(v, "cannot open the block iterator");
+    }
+    const CompressedBlock *block;
+    size_t found = 0;
+    int ret, status = 0;
+    while ((ret = acd_block_iter_next(&it, &block)) == 1) {
+        const CompressedBlock *want = found < c->count ? &c->blocks[found] : NULL;
+        if (!want || block->offset != want->offset || block->compressed_size != want->compressed_size ||
+            block->crc32 != want->crc32) {
+            status = verify_fail(v, "iterator block %zu at 0x%lx is not the index's", found + 1, block->offset);
+            break;
+        }
+        found++;
+    }
+    acd_block_iter_close(&it);
+    if (status != 0) {
+        return status;
+    }
+    if (ret < 0 || found != c->count) {
+        return verify_fail(v, "iterator found %zu blocks, the index %zu", found, c->count);
+    }
+    uint64_t candidates = acd_stats.candidates, header = acd_stats.rejected_header,
+             deflate = acd_stats.rejected_block, inflate = acd_stats.rejected_inflate,
+             blocks = acd_stats.blocks;
+    if (candidates != header + deflate + inflate + blocks || blocks != c->count) {
+        return verify_fail(v, "%llu candidates but %llu + %llu + %llu rejected and %llu blocks",
+                           (unsigned long long)candidates, (unsigned long long)header,
+                           (unsigned long long)deflate, (unsigned long long)inflate,
+                           (unsigned long long)blocks);
+    }
+
+    // The pre-filter may only drop candidates that wouldn't have decoded
+    for (size_t i = 0; i < c->candidate_count; i++) {
+        long offset = c->candidates[i];
+        if (acd_gzip_check(c->acd.data + offset, (size_t)(c->acd.file_size - offset)) == GZIP_CANDIDATE_OK) {
+            continue;
+        }
+        CompressedBlock probe = { .offset = offset };
+        if (acd_block_inflate_ctx(&c->ctx, &c->acd, &probe) == Z_STREAM_END) {
+            acd_block_free(&probe);
+            return verify_fail(v, "candidate at 0x%lx is rejected but decodes", offset);
+        }
+        v->items++;
+    }
+    return 0;
+}
+
+static int same_tags(const TagTable *a, const TagTable *b) {
+    if (a->count != b->count || a->def_count != b->def_count || a->member_count != b->member_count ||
+        a->program_count != b->program_count) {
+        return 0;
+    }
+    for (size_t i = 0; i < a->count; i++) {
+        if (strcmp(tag_name(a, i), tag_name(b, i)) != 0 ||
+            strcmp(tag_type_name(a, a->type[i]), tag_type_name(b, b->type[i])) != 0 ||
+            a->scope[i] != b->scope[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int verify_paths_agree(Verify *v) {
+    Corpus *c = v->c;
+    int jobs = v->config->jobs > 1 ? v->config->jobs : 4;
+    const struct {
+        const char *name;
+        int jobs;
+        int comp_cache;
+        int tags;
+    } variants[] = {
+        { "export", 1, 0, 0 },
+        { "export --jobs", jobs, 0, 0 },
+        { "parse, cold component cache", 1, 1, 1 },
+        { "parse, warm component cache", 1, 1, 1 },
+        { "parse --jobs, warm component cache", jobs, 1, 0 },
+    };
+    for (size_t k = 0; k < sizeof(variants) / sizeof(variants[0]); k++) {
+        ComponentStore store;
+        RungTable rungs;
+        TagTable tags;
+        rung_table_init(&rungs);
+        if (component_store_init(&store) != 0 || tag_table_init(&tags) != 0) {
+            return verify_fail(v, "out of memory");
+        }
+        ExportOptions options = { variants[k].jobs, NULL, NULL, 1, variants[k].comp_cache ? v->project : NULL };
+        XmlWriter w = {0};
+        int status = 0;
+        if (acd_export_collect(&store, &rungs, variants[k].tags ? &tags : NULL, &c->acd, c->blocks, c->count,
+                               &options, NULL) != 0 ||
+            render_l5x(v, &store, &rungs, variants[k].jobs, &w) != 0) {
+            status = verify_fail(v, "%s failed", variants[k].name);
+        } else if (!same_bytes(&w, v->reference.buf, v->reference.len)) {
+            status = verify_fail(v, "%s: %zu bytes of L5X, separate passes %zu, or they differ",
+                                 variants[k].name, w.len, v->reference.len);
+        } else if (variants[k].tags && !same_tags(&tags, &c->tags)) {
+            status = verify_fail(v, "%s: %zu tags, parse_tag_block %zu, or they differ", variants[k].name,
+                                 tags.count, c->tags.count);
+        }
+        xml_writer_close(&w);
+        tag_table_free(&tags);
+        rung_table_free(&rungs);
+        component_store_free(&store);
+        if (status != 0) {
+            return status;
+        }
+        v->items++;
+    }
+    return 0;
+}
+
+static int verify_batch(Verify *v) {
+    Corpus *c = v->c;
+    char dirs[3][1200], paths[3][1300], out[1200], missing[1300];
+    snprintf(dirs[0], sizeof(dirs[0]), "%s/batch", v->dir);
+    snprintf(dirs[1], sizeof(dirs[1]), "%s/batch/a", v->dir);
+    snprintf(dirs[2], sizeof(dirs[2]), "%s/batch/b", v->dir);
+    snprintf(out, sizeof(out), "%s/batch/out", v->dir);
+    snprintf(paths[0], sizeof(paths[0]), "%s/Line.ACD", dirs[1]);
+    snprintf(paths[1], sizeof(paths[1]), "%s/line.acd", dirs[2]);
+    snprintf(paths[2], sizeof(paths[2]), "%s/Other.ACD", dirs[1]);
+    snprintf(missing, sizeof(missing), "%s/Line.L5X", out);
+    for (int i = 0; i < 3; i++) {
+        mkdir(dirs[i], 0755);
+    }
+    mkdir(out, 0755);
+    for (int i = 0; i < 3; i++) {
+        if (write_file(paths[i], c->acd.data, (size_t)c->acd.file_size) != 0) {
+            return verify_fail(v, "cannot write %s", paths[i]);
+        }
+    }
+
+    const char *inputs[3] = { paths[0], paths[1], paths[2] };
+    BatchOptions options = { 1, out, 0, NULL, BENCH_EXPORT_DATE, NULL, 1 };
+    BatchResult results[3];
+    long failed = acd_batch_run(inputs, 3, &options, results);
+    struct stat st;
+    int status = 0;
+    if (failed != 2 || results[0].status == 0 || results[1].status == 0 || results[2].status != 0) {
+        status = verify_fail(v, "%ld failed (want 2): %s, %s, %s", failed,
+                             results[0].error ? results[0].error : "ok", results[1].error ? results[1].error : "ok",
+                             results[2].error ? results[2].error : "ok");
+    } else if (stat(missing, &st) == 0) {
+        status = verify_fail(v, "%s was written for colliding inputs", missing);
+    } else {
+        ACD_File l5x;
+        if (acd_file_open(&l5x, results[2].output) != 0) {
+            status = verify_fail(v, "cannot read %s", results[2].output);
+        } else {
+            if (!same_bytes(&v->reference, l5x.data, (size_t)l5x.file_size)) {
+                status = verify_fail(v, "%s differs from the separate-pass L5X", results[2].output);
+            }
+            acd_file_close(&l5x);
+        }
+    }
+    if (status == 0 && acd_batch_write_manifest(v->config->null, results, 3, 0) != 0) {
+        status = verify_fail(v, "manifest write failed");
+    }
+    acd_batch_results_free(results, 3);
+    v->items = 3;
+    return status;
+}
+
+static int verify_columnar(Verify *v) {
+    Corpus *c = v->c;
+    const ComponentStore *s = &c->store;
+    const TagTable *t = &c->tags;
+    const RungTable *r = &c->rungs;
+    char path[1200];
+    snprintf(path, sizeof(path), "%s/Project%s", v->dir, ACD_COLUMNAR_SUFFIX);
+    ColumnarFile f;
+    if (acd_columnar_write(path, s, t, r) != 0 || acd_columnar_open(&f, path) != 0) {
+        return verify_fail(v, "cannot write and reopen %s", path);
+    }
+
+    int status = 0;
+    if (f.component_count != s->count || f.root_count != s->root_count || f.tag_count != t->count ||
+        f.type_count != t->type_count || f.program_count != t->program_count ||
+        f.datatype_count != t->def_count || f.member_count != t->member_count || f.rung_count != r->count ||
+        strcmp(acd_columnar_str(&f, f.controller_name), tag_str(t, t->controller_name)) != 0) {
+        status = verify_fail(v, "counts differ: %zu components, %zu tags, %zu rungs read back", f.component_count,
+                             f.tag_count, f.rung_count);
+    }
+    for (size_t i = 0; status == 0 && i < s->count; i++) {
+        const Component *comp = &s->items[i];
+        size_t n, m;
+        const uint32_t *kids = component_children(s, i, &n), *read = acd_columnar_children(&f, i, &m);
+        if (f.comp_uid[i] != comp->uid || f.comp_parent[i] != comp->parent_uid ||
+            f.comp_ordinal[i] != comp->ordinal ||
+            strcmp(acd_columnar_str(&f, f.comp_name[i]), component_str(s, comp->name)) != 0 ||
+            strcmp(acd_columnar_str(&f, f.comp_type[i]), component_str(s, comp->type)) != 0 ||
+            strcmp(acd_columnar_str(&f, f.comp_ioi[i]), component_str(s, comp->ioi)) != 0 ||
+            n != m || memcmp(kids, read, n * sizeof(*kids)) != 0 ||
+            acd_columnar_find(&f, comp->uid) != component_store_find(s, comp->uid)) {
+            status = verify_fail(v, "component %zu (UID %u) differs", i, comp->uid);
+        }
+    }
+    for (size_t i = 0; status == 0 && i < s->root_count; i++) {
+        if (f.roots[i] != s->roots[i]) status = verify_fail(v, "root %zu differs", i);
+    }
+    for (size_t i = 0; status == 0 && i < t->count; i++) {
+        if (strcmp(acd_columnar_str(&f, f.tag_name[i]), tag_name(t, i)) != 0 ||
+            strcmp(acd_columnar_str(&f, f.type_name[f.tag_type[i]]), tag_type_name(t, t->type[i])) != 0 ||
+            f.tag_dim0[i] != t->dim0[i] || f.tag_dim1[i] != t->dim1[i] || f.tag_dim2[i] != t->dim2[i] ||
+            f.tag_scope[i] != t->scope[i] || f.tag_access[i] != t->access[i] ||
+            strcmp(acd_columnar_str(&f, f.tag_alias[i]), tag_str(t, t->alias[i])) != 0) {
+            status = verify_fail(v, "tag %zu (%s) differs", i, tag_name(t, i));
+        }
+    }
+    for (size_t i = 0; status == 0 && i < t->program_count; i++) {
+        if (strcmp(acd_columnar_str(&f, f.program_name[i]), tag_str(t, t->program_name[i])) != 0) {
+            status = verify_fail(v, "program %zu differs", i);
+        }
+    }
+    for (size_t d = 0; status == 0 && d < t->def_count; d++) {
+        if (strcmp(acd_columnar_str(&f, f.type_name[f.def_type[d]]), tag_type_name(t, t->def_type[d])) != 0 ||
+            strcmp(acd_columnar_str(&f, f.def_family[d]), tag_str(t, t->def_family[d])) != 0 ||
+            strcmp(acd_columnar_str(&f, f.def_class[d]), tag_str(t, t->def_class[d])) != 0 ||
+            f.def_member_start[d + 1] != t->def_member_start[d + 1]) {
+            status = verify_fail(v, "data type %zu (%s) differs", d, tag_type_name(t, t->def_type[d]));
+        }
+    }
+    for (size_t m = 0; status == 0 && m < t->member_count; m++) {
+        if (strcmp(acd_columnar_str(&f, f.member_name[m]), tag_str(t, t->member_name[m])) != 0 ||
+            strcmp(acd_columnar_str(&f, f.type_name[f.member_type[m]]), tag_type_name(t, t->member_type[m])) != 0 ||
+            f.member_dim[m] != t->member_dim[m] || f.member_hidden[m] != t->member_hidden[m]) {
+            status = verify_fail(v, "member %zu differs", m);
+        }
+    }
+    for (size_t i = 0; status == 0 && i < r->count; i++) {
+        if (f.rung_uid[i] != r->uid[i] || f.rung_routine[i] != r->routine[i] ||
+            strcmp(acd_columnar_str(&f, f.rung_text[i]), rung_text(r, i)) != 0) {
+            status = verify_fail(v, "rung %zu (UID %u) differs", i, r->uid[i]);
+        }
+    }
+    v->items = f.component_count + f.tag_count + f.datatype_count + f.member_count + f.rung_count;
+    acd_columnar_close(&f);
+    return status;
+}
+
+// Diff the corpus (old side) against acd, both indexed
+static int run_diff(Verify *v, AcdDiff *diff, const ACD_File *acd, const CompressedBlock *blocks, size_t count) {
+    const Corpus *c = v->c;
+    if (acd_diff_run(diff, &c->acd, c->blocks, c->count, acd, blocks, count) != 0) {
+        return verify_fail(v, "diff failed");
+    }
+    v->items += diff->block_count + diff->component_count;
+    return 0;
+}
+
+static int verify_diff(Verify *v) {
+    Corpus *c = v->c;
+    ACD_File copy;
+    CompressedBlock *blocks = NULL;
+    size_t count = 0;
+    if (acd_file_open(&copy, v->project) != 0) {
+        return verify_fail(v, "cannot open %s", v->project);
+    }
+    AcdDiff diff;
+    int status = acd_index_blocks(v->project, &copy, &blocks, &count, NULL) != 0
+                     ? verify_fail(v, "cannot index %s", v->project)
+                     : run_diff(v, &diff, &copy, blocks, count);
+    if (status == 0) {
+        // What cmd_diff exits 0 on
+        if (diff.block_count != c->count || diff.blocks_same != diff.block_count || diff.component_count != 0) {
+            status = verify_fail(v, "against an identical copy: %zu of %zu blocks unchanged (want %zu), "
+                                 "%zu component changes", diff.blocks_same, diff.block_count, c->count,
+                                 diff.component_count);
+        }
+        acd_diff_free(&diff);
+    }
+    free(blocks);
+    acd_file_close(&copy);
+    if (status != 0 || !c->synth) {
+        return status;
+    }
+
+    // One more program: its components, and the blocks that describe them
+    const SynthOptions *o = c->synth;
+    SynthOptions next = *o;
+    next.programs++;
+    ACD_File rev = {0};
+    unsigned char *data;
+    size_t size;
+    if (acd_synth_generate(&next, &data, &size) != 0) {
+        return verify_fail(v, "generation failed");
+    }
+    rev.data = data;
+    rev.file_size = (long)size;
+    rev.binary_start = acd_find_binary_start(&rev);
+    blocks = NULL;
+    status = acd_index_build(&rev, &blocks, &count) != 0 ? verify_fail(v, "cannot index the revision")
+                                                         : run_diff(v, &diff, &rev, blocks, count);
+    if (status == 0) {
+        size_t added = 1 + o->tags + o->routines * (1 + o->rungs);
+        if (diff.block_count != c->count || diff.blocks_added || diff.blocks_removed ||
+            diff.comps_added != added || diff.comps_removed || diff.comps_modified) {
+            status = verify_fail(v, "against one more program: %zu blocks (%zu added, %zu removed), "
+                                 "%zu components added, %zu removed, %zu modified; want %zu blocks, "
+                                 "%zu components added",
+                                 diff.block_count, diff.blocks_added, diff.blocks_removed, diff.comps_added,
+                                 diff.comps_removed, diff.comps_modified, c->count, added);
+        }
+        for (size_t i = 0; status == 0 && i < diff.block_count && i < 4; i++) {
+            // Without rungs the RungCode block is the same, whatever the programs
+            DiffStatus want = i == 0 || (i == 3 && !(o->routines && o->rungs)) ? DIFF_SAME : DIFF_MODIFIED;
+            if (diff.blocks[i].new_index != (long)i || diff.blocks[i].status != want) {
+                status = verify_fail(v, "against one more program: block %zu is %s, want %s", i,
+                                     diff.blocks[i].status == DIFF_SAME ? "unchanged" : "changed",
+                                     want == DIFF_SAME ? "unchanged" : "modified");
+            }
+        }
+        acd_diff_free(&diff);
+    }
+    free(blocks);
+    acd_file_close(&rev);
+    return status;
+}
+
+static int verify_synthetic(Verify *v) {
+    const Corpus *c = v->c;
+    const SynthOptions *o = c->synth;
+    const TagTable *t = &c->tags;
+    size_t tags = 32 + o->programs * o->tags;
+    size_t components = 1 + 8 + 8 + 32 + o->programs * (1 + o->tags + o->routines * (1 + o->rungs));
+    size_t aliases = 0, matrices = 0;
+    for (size_t n = 0; n < tags; n++) {
+        aliases += n % 11 == 10;
+        matrices += n % 15 == 0;
+    }
+    if (t->count != tags || t->program_count != o->programs || t->def_count != 8 || t->member_count != 8 * 4 + 7 ||
+        strcmp(tag_str(t, t->controller_name), "Synthetic_Controller") != 0) {
+        return verify_fail(v, "%zu tags, %zu programs, %zu data types with %zu members; want %zu, %zu, 8, 39",
+                           t->count, t->program_count, t->def_count, t->member_count, tags, o->programs);
+    }
+    size_t alias_seen = 0, matrix_seen = 0;
+    for (size_t i = 0; i < t->count; i++) {
+        alias_seen += t->alias[i] != 0;
+        matrix_seen += tag_dimensions(t, i) == 2;
+        // P<p>_Tag_<k> belongs to Program_<p>, Ctrl_Tag_<k> to the controller
+        const char *name = tag_name(t, i);
+        char scope[64] = "";
+        size_t p;
+        if (sscanf(name, "P%zu_Tag_", &p) == 1) snprintf(scope, sizeof(scope), "Program_%zu", p);
+        if (strcmp(scope, tag_scope_name(t, t->scope[i])) != 0) {
+            return verify_fail(v, "tag %s is in scope %u", name, t->scope[i]);
+        }
+    }
+    if (alias_seen != aliases || matrix_seen != matrices) {
+        return verify_fail(v, "%zu aliases and %zu two-dimension tags; want %zu and %zu", alias_seen,
+                           matrix_seen, aliases, matrices);
+    }
+    if (c->store.count != components || c->rungs.count != o->programs * o->routines * o->rungs ||
+        c->rungs.bad != 0) {
+        return verify_fail(v, "%zu components and %zu rungs (%zu bad); want %zu and %zu", c->store.count,
+                           c->rungs.count, c->rungs.bad, components, o->programs * o->routines * o->rungs);
+    }
+    v->items = t->count + t->def_count + c->store.count + c->rungs.count;
+    return 0;
+}
+
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static int verify_corpus(Corpus *c, const BenchConfig *config, const char *dir) {
+    static const struct {
+        const char *name;
+        VerifyCheck check;
+    } checks[] = {
+        { "head_peek", verify_head_peek },
+        { "inflate_backend", verify_inflate_backend },
+        { "block_read", verify_block_read },
+        { "scan_prefilter", verify_scan_prefilter },
+        { "paths_agree", verify_paths_agree },
+        { "batch", verify_batch },
+        { "columnar", verify_columnar },
+        { "diff", verify_diff },
+        { "synthetic", verify_synthetic },
+    };
+    if (corpus_prepare(c) != 0) {
+        fprintf(stderr, "❌ %s: cannot index\n", c->name);
+        return -1;
+    }
+
+    Verify v = { .c = c, .config = config };
+    snprintf(v.dir, sizeof(v.dir), "%s", dir);
+    snprintf(v.project, sizeof(v.project), "%s/Project.ACD", dir);
+    ACD_Header header;
+    if (acd_header_parse(&c->acd, &header) == 0) {
+        acd_l5x_options_from_header(&v.l5x, &header, v.header_text, sizeof(v.header_text));
+        acd_header_free(&header);
+    }
+    v.l5x.export_date = BENCH_EXPORT_DATE;
+
+    // The reference: Comps and RungCode each in a pass of their own
+    ComponentStore store;
+    RungTable rungs;
+    rung_table_init(&rungs);
+    int ready = mkdir(dir, 0755) == 0 &&
+                write_file(v.project, c->acd.data, (size_t)c->acd.file_size) == 0 &&
+                component_store_init(&store) == 0;
+    if (ready) {
+        ready = parse_acd_components(&store, &c->acd, c->blocks, c->count) >= 0 &&
+                parse_acd_rungs(&rungs, &c->acd, c->blocks, c->count, 1) >= 0 &&
+                render_l5x(&v, &store, &rungs, 1, &v.reference) == 0;
+        component_store_free(&store);
+    }
+    rung_table_free(&rungs);
+    if (!ready) {
+        fprintf(stderr, "❌ %s: cannot set up %s\n", c->name, dir);
+        xml_writer_close(&v.reference);
+        return -1;
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        if (checks[i].check == verify_synthetic && !c->synth) continue;
+        v.items = 0;
+        v.why[0] = '\0';
+        int ok = checks[i].check(&v) == 0;
+        fprintf(config->json, "{\"verify\":\"%s\",\"file\":\"%s\"", checks[i].name, c->name);
+        if (config->label) {
+            fprintf(config->json, ",\"label\":\"%s\"", config->label);
+        }
+        fprintf(config->json, ",\"ok\":%s,\"items\":%zu", ok ? "true" : "false", v.items);
+        if (!ok) {
+            fputs(",\"error\":", config->json);
+            json_string(config->json, v.why);
+            fprintf(stderr, "❌ %s: %s: %s\n", c->name, checks[i].name, v.why);
+            status = -1;
+        }
+        fputs("}\n", config->json);
+        fflush(config->json);
+    }
+    xml_writer_close(&v.reference);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig config = { .min_iterations = 3, .min_time = 0.5, .jobs = 1 };
+    int verify = 0;
+    SynthOptions synth;
+    acd_synth_defaults(&synth);
+
+    const char **files = calloc((size_t)argc, sizeof(*files));
+    size_t file_count = 0;
+    if (!files) {
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-') {
+            files[file_count++] = arg;
+            continue;
+        }
+        if (strcmp(arg, "--verify") == 0) {
+            verify = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "❌ %s needs a value\n", arg);
+            return 1;
+        }
+        const char *value = argv[++i];
+        unsigned long long n = strtoull(value, NULL, 10);
+        if (strcmp(arg, "--iterations") == 0) config.min_iterations = (int)n;
+        else if (strcmp(arg, "--min-time") == 0) config.min_time = atof(value);
+        else if (strcmp(arg, "--jobs") == 0) config.jobs = (int)n;
+        else if (strcmp(arg, "--label") == 0) config.label = value;
+        else if (strcmp(arg, "--size") == 0) synth.size = (size_t)(n << 20);
+        else if (strcmp(arg, "--blocks") == 0) synth.blocks = (size_t)n;
+        else if (strcmp(arg, "--programs") == 0) synth.programs = (size_t)n;
+        else if (strcmp(arg, "--tags") == 0) synth.tags = (size_t)n;
+        else if (strcmp(arg, "--routines") == 0) synth.routines = (size_t)n;
+        else if (strcmp(arg, "--rungs") == 0) synth.rungs = (size_t)n;
+        else if (strcmp(arg, "--false-positives") == 0) synth.false_positives = (size_t)n;
+        else if (strcmp(arg, "--seed") == 0) synth.seed = (uint32_t)n;
+        else {
+            fprintf(stderr, "❌ Unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (config.min_iterations < 1) config.min_iterations = 1;
+
+    // JSON goes to the real stdout; the library's printf output is dropped
+    int json_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    config.json = json_fd >= 0 ? fdopen(json_fd, "w") : NULL;
+    config.null = fopen("/dev/null", "w");
+    if (!config.json || !config.null || null_fd < 0) {
+        fprintf(stderr, "❌ Cannot set up output\n");
+        return 1;
+    }
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    // Checks write their projects, caches and outputs under one scratch
+    // directory, removed at the end
+    char scratch[1024] = "";
+    if (verify) {
+        const char *tmp = getenv("TMPDIR");
+        snprintf(scratch, sizeof(scratch), "%s/acd_verify.XXXXXX", tmp && *tmp ? tmp : "/tmp");
+        if (!mkdtemp(scratch)) {
+            fprintf(stderr, "❌ Cannot create a scratch directory\n");
+            return 1;
+        }
+    }
+    char dir[1100];
+
+    int status = 0;
+    if (file_count == 0) {
+        Corpus c = { .name = "synthetic", .synth = &synth };
+        unsigned char *data;
+        size_t size;
+        if (acd_synth_generate(&synth, &data, &size) != 0) {
+            fprintf(stderr, "❌ Generation failed\n");
+            return 1;
+        }
+        // A heap-buffered ACD_File; acd_file_close frees the buffer
+        c.acd.data = data;
+        c.acd.file_size = (long)size;
+        snprintf(dir, sizeof(dir), "%s/synthetic", scratch);
+        status |= verify ? verify_corpus(&c, &config, dir) : bench_corpus(&c, &config);
+        corpus_free(&c);
+    }
+    for (size_t f = 0; f < file_count; f++) {
+        Corpus c = { .name = files[f] };
+        if (acd_file_open(&c.acd, files[f]) != 0) {
+            fprintf(stderr, "❌ Cannot open %s\n", files[f]);
+            status = -1;
+            continue;
+        }
+        snprintf(dir, sizeof(dir), "%s/%zu", scratch, f + 1);
+        status |= verify ? verify_corpus(&c, &config, dir) : bench_corpus(&c, &config);
+        corpus_free(&c);
+    }
+
+    if (verify) remove_tree(scratch);
+    free(files);
+    fclose(config.null);
+    fclose(config.json);
+    return status ? 1 : 0;
+}
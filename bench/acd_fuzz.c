@@ -0,0 +1,484 @@
+// Fuzz harnesses for the parsing entry points, and their throughput
+//
+// Each target feeds one input, as raw bytes, to one entry point:
+//   scan       acd_scan_gzip, then acd_gzip_check on every candidate
+//   header     acd_find_binary_start and acd_header_parse
+//   index      acd_index_build (scan, validate and probe every candidate)
+//   blockread  acd_block_open on the first candidate, reads steered by the input
+//   signatures acd_signatures_scan with the default database markers
+//   database   read_database_header at the start of the input
+//   comps      parse_block (Comps database)
+//   tags       parse_tag_block (TagInfo.XML document)
+//   rungs      parse_rung_block (RungCode database, one thread)
+//   rll        rll_decode_rung on the whole input as one instruction stream
+//
+// libFuzzer (target from $ACD_FUZZ_TARGET):
+//   clang -g -O1 -fsanitize=fuzzer,address,undefined -DACD_FUZZ_LIBFUZZER -I. -o acd_fuzz
+//         bench/acd_fuzz.c bench/acd_synth.c acd_*.c -lz -pthread
+//   ACD_FUZZ_TARGET=comps ./acd_fuzz corpus/
+// AFL, or replaying crashes, with the standalone build:
+//   afl-clang-fast -g -O1 -I. -o acd_fuzz bench/acd_fuzz.c bench/acd_synth.c acd_*.c -lz -pthread
+//   afl-fuzz -i corpus -o findings -- ./acd_fuzz comps @@
+//   ./acd_fuzz comps crash-1234 ...     (no files: one input on stdin)
+//
+// The standalone build also writes a seed corpus from the synthetic
+// generator (a small ACD and every member inflated), and times every
+// target over a corpus, one JSON line per target, like acd_bench:
+//   ./acd_fuzz --seeds corpus/
+//   ./acd_fuzz --bench [--min-time S] [--budget comps=400]... corpus/*
+// A --budget target=MB/s that isn't met makes the run exit 1, so a
+// bounds-checking patch can be held to the throughput it had before.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "acd.h"
+#include "acd_synth.h"
+
+typedef int (*FuzzFn)(const unsigned char *data, size_t size);
+
+// A heap-free view of the input as an ACD (never passed to acd_file_close)
+static ACD_File input_file(const unsigned char *data, size_t size) {
+    ACD_File acd = { data, (long)size, NULL, 0, 0, 0 };
+    return acd;
+}
+
+static int fuzz_scan(const unsigned char *data, size_t size) {
+    CandidateList list = {0};
+    if (acd_scan_gzip(data, size, 0, &list) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < list.count; i++) {
+        size_t at = (size_t)list.offsets[i];
+        acd_gzip_check(data + at, size - at);
+    }
+    candidate_list_free(&list);
+    return 0;
+}
+
+static int fuzz_header(const unsigned char *data, size_t size) {
+    ACD_File acd = input_file(data, size);
+    ACD_Header header;
+    acd.binary_start = acd_find_binary_start(&acd);
+    if (acd_header_parse(&acd, &header) == 0) {
+        acd_header_get(&header, "Version");
+        acd_header_free(&header);
+    }
+    return 0;
+}
+
+static int fuzz_index(const unsigned char *data, size_t size) {
+    ACD_File acd = input_file(data, size);
+    CompressedBlock *blocks = NULL;
+    size_t count = 0;
+    acd.binary_start = acd_find_binary_start(&acd);
+    if (acd_index_build(&acd, &blocks, &count) != 0) {
+        return -1;
+    }
+    free(blocks);
+    return 0;
+}
+
+static int fuzz_blockread(const unsigned char *data, size_t size) {
+    ACD_File acd = input_file(data, size);
+    size_t at = acd_scan_next_gzip(data, size, 0);
+    BlockReader reader;
+    if (at >= size || acd_block_open(&reader, &acd, NULL, 0, (long)at, 4096) != 0) {
+        return 0;
+    }
+    // The first bytes pick the read offsets, so seeks go both ways
+    unsigned char buf[512];
+    for (size_t i = 0; i < 8 && i < size; i++) {
+        uint64_t offset = (uint64_t)data[i] * 97;
+        if (acd_block_read(&reader, offset, buf, sizeof(buf)) < 0) break;
+    }
+    acd_block_close(&reader);
+    return 0;
+}
+
+static void count_hit(void *ctx, int id, size_t offset) {
+    (void)id;
+    (void)offset;
+    (*(size_t *)ctx)++;
+}
+
+static int fuzz_signatures(const unsigned char *data, size_t size) {
+    static SignatureSet *set;
+    if (!set && !(set = acd_signatures_default())) {
+        return -1;
+    }
+    size_t hits = 0;
+    acd_signatures_scan(set, data, size, 0, count_hit, &hits);
+    return 0;
+}
+
+static int fuzz_database(const unsigned char *data, size_t size) {
+    DatabaseHeader header;
+    read_database_header(data, size, 0, &header);
+    return 0;
+}
+
+static int fuzz_comps(const unsigned char *data, size_t size) {
+    ComponentStore store;
+    if (component_store_init(&store) != 0) {
+        return -1;
+    }
+    parse_block(&store, data, size);
+    component_store_free(&store);
+    return 0;
+}
+
+static int fuzz_tags(const unsigned char *data, size_t size) {
+    TagTable table;
+    if (tag_table_init(&table) != 0) {
+        return -1;
+    }
+    parse_tag_block(&table, data, size);
+    tag_table_free(&table);
+    return 0;
+}
+
+static int fuzz_rungs(const unsigned char *data, size_t size) {
+    RungTable table;
+    rung_table_init(&table);
+    parse_rung_block(&table, data, size, 1);
+    rung_table_free(&table);
+    return 0;
+}
+
+static int fuzz_rll(const unsigned char *data, size_t size) {
+    char *out = malloc(RLL_TEXT_BOUND(size));
+    if (!out) {
+        return -1;
+    }
+    rll_decode_rung(data, size, out);
+    free(out);
+    return 0;
+}
+
+static const struct {
+    const char *name;
+    FuzzFn fn;
+} targets[] = {
+    { "scan", fuzz_scan },
+    { "header", fuzz_header },
+    { "index", fuzz_index },
+    { "blockread", fuzz_blockread },
+    { "signatures", fuzz_signatures },
+    { "database", fuzz_database },
+    { "comps", fuzz_comps },
+    { "tags", fuzz_tags },
+    { "rungs", fuzz_rungs },
+    { "rll", fuzz_rll },
+};
+#define TARGET_COUNT (sizeof(targets) / sizeof(targets[0]))
+
+static int find_target(const char *name) {
+    for (size_t t = 0; t < TARGET_COUNT; t++) {
+        if (strcmp(targets[t].name, name) == 0) return (int)t;
+    }
+    return -1;
+}
+
+// The parsers report progress on stdout; fuzzing and timing don't want it
+static int silence_stdout(void) {
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    acd_quiet = 1;
+    fflush(stdout);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    return saved;
+}
+
+#ifdef ACD_FUZZ_LIBFUZZER
+
+static FuzzFn active;
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    const char *name = getenv("ACD_FUZZ_TARGET");
+    int t = find_target(name ? name : "comps");
+    if (t < 0) {
+        fprintf(stderr, "❌ Unknown ACD_FUZZ_TARGET %s\n", name);
+        exit(1);
+    }
+    active = targets[t].fn;
+    silence_stdout();
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    active(data, size);
+    return 0;
+}
+
+#else
+
+// Whole file (or stdin) in an exact-size buffer, so a sanitizer sees any
+// read past the end
+static unsigned char *read_input(const char *path, size_t *size) {
+    FILE *f = path ? fopen(path, "rb") : stdin;
+    if (!f) {
+        return NULL;
+    }
+    size_t len = 0, cap = 1 << 16;
+    unsigned char *buf = malloc(cap);
+    size_t n;
+    while (buf && (n = fread(buf + len, 1, cap - len, f)) > 0) {
+        len += n;
+        if (len == cap) {
+            unsigned char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+    }
+    if (path) fclose(f);
+    if (!buf) {
+        return NULL;
+    }
+    unsigned char *exact = malloc(len ? len : 1);
+    if (exact) memcpy(exact, buf, len);
+    free(buf);
+    *size = len;
+    return exact;
+}
+
+static int write_seed(const char *dir, const char *name, const unsigned char *data, size_t size) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    int ok = fwrite(data, 1, size, f) == size;
+    return fclose(f) == 0 && ok ? 0 : -1;
+}
+
+// A small synthetic ACD, and every member of it inflated
+static int write_seeds(const char *dir) {
+    SynthOptions options;
+    acd_synth_defaults(&options);
+    options.size = 1 << 20;
+    options.blocks = 8;
+    options.programs = 2;
+    options.tags = 8;
+    options.routines = 2;
+    options.rungs = 8;
+    options.false_positives = 32;
+    unsigned char *data;
+    size_t size;
+    if (mkdir(dir, 0755) != 0 && access(dir, W_OK) != 0) {
+        return -1;
+    }
+    if (acd_synth_generate(&options, &data, &size) != 0) {
+        return -1;
+    }
+    int ret = write_seed(dir, "synthetic.ACD", data, size);
+
+    ACD_File acd = input_file(data, size);
+    CompressedBlock *blocks = NULL;
+    size_t count = 0;
+    acd.binary_start = acd_find_binary_start(&acd);
+    if (ret == 0 && acd_index_build(&acd, &blocks, &count) != 0) ret = -1;
+    for (size_t i = 0; ret == 0 && i < count; i++) {
+        CompressedBlock block = blocks[i];
+        if (acd_block_inflate(&acd, &block) != Z_STREAM_END) continue;
+        char name[64];
+        snprintf(name, sizeof(name), "block_%03zu_%s.bin", i + 1, acd_block_kind_name(block.kind));
+        ret = write_seed(dir, name, block.data, block.uncompressed_size);
+        acd_block_free(&block);
+    }
+    free(blocks);
+    free(data);
+    return ret;
+}
+
+typedef struct {
+    unsigned char **data;
+    size_t *sizes;
+    size_t count;
+    size_t bytes;
+} FuzzCorpus;
+
+static int corpus_add(FuzzCorpus *c, const char *path) {
+    size_t size;
+    unsigned char *data = read_input(path, &size);
+    if (!data) {
+        fprintf(stderr, "❌ Cannot read %s\n", path);
+        return -1;
+    }
+    unsigned char **grown_data = realloc(c->data, (c->count + 1) * sizeof(*grown_data));
+    if (grown_data) c->data = grown_data;
+    size_t *grown_sizes = realloc(c->sizes, (c->count + 1) * sizeof(*grown_sizes));
+    if (grown_sizes) c->sizes = grown_sizes;
+    if (!grown_data || !grown_sizes) {
+        free(data);
+        return -1;
+    }
+    c->data[c->count] = data;
+    c->sizes[c->count++] = size;
+    c->bytes += size;
+    return 0;
+}
+
+// A file, or every regular file in a directory
+static int corpus_add_path(FuzzCorpus *c, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return corpus_add(c, path);
+    }
+    DIR *d = opendir(path);
+    if (!d) {
+        return -1;
+    }
+    struct dirent *entry;
+    int ret = 0;
+    while (ret == 0 && (entry = readdir(d)) != NULL) {
+        char file[4096];
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        if (entry->d_name[0] != '.' && stat(file, &st) == 0 && S_ISREG(st.st_mode)) {
+            ret = corpus_add(c, file);
+        }
+    }
+    closedir(d);
+    return ret;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Every target over the whole corpus until min_time has passed; returns
+// the number of targets under their budget. MB/s is over the whole input,
+// so a target that rejects most of the corpus early (rll on anything but
+// RungCode) reads very high.
+static int bench_targets(const FuzzCorpus *c, double min_time, const double *budget, FILE *json) {
+    int missed = 0;
+    for (size_t t = 0; t < TARGET_COUNT; t++) {
+        size_t iterations = 0;
+        double start = now_seconds(), elapsed;
+        do {
+            for (size_t i = 0; i < c->count; i++) {
+                targets[t].fn(c->data[i], c->sizes[i]);
+            }
+            iterations++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < min_time);
+        double mb_per_s = elapsed > 0 ? c->bytes * (double)iterations / elapsed / 1e6 : 0;
+        int under = budget[t] > 0 && mb_per_s < budget[t];
+        fprintf(json, "{\"bench\":\"fuzz_%s\",\"files\":%zu,\"bytes\":%zu,\"iterations\":%zu,"
+                      "\"seconds\":%.6f,\"mb_per_s\":%.1f",
+                targets[t].name, c->count, c->bytes, iterations, elapsed, mb_per_s);
+        if (budget[t] > 0) fprintf(json, ",\"budget_mb_per_s\":%.1f,\"within_budget\":%s", budget[t],
+                                   under ? "false" : "true");
+        fprintf(json, "}\n");
+        missed += under;
+    }
+    return missed;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Usage: acd_fuzz <target> [input...]          run one target (stdin without inputs)\n");
+    fprintf(stderr, "       acd_fuzz --seeds DIR                  write a seed corpus\n");
+    fprintf(stderr, "       acd_fuzz --bench [--min-time S] [--budget TARGET=MBPS]... <file | dir>...\n");
+    fprintf(stderr, "Targets:");
+    for (size_t t = 0; t < TARGET_COUNT; t++) fprintf(stderr, " %s", targets[t].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "--seeds") == 0) {
+        if (argc != 3) {
+            usage();
+            return 1;
+        }
+        int saved = silence_stdout();
+        int ret = write_seeds(argv[2]);
+        dup2(saved, STDOUT_FILENO);
+        if (ret != 0) {
+            fprintf(stderr, "❌ Cannot write seeds to %s\n", argv[2]);
+            return 1;
+        }
+        printf("🌱 Seed corpus written to %s\n", argv[2]);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--bench") == 0) {
+        double min_time = 0.5;
+        double budget[TARGET_COUNT] = {0};
+        FuzzCorpus corpus = {0};
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+                min_time = atof(argv[++i]);
+            } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+                char *eq = strchr(argv[++i], '=');
+                if (eq) *eq = '\0';
+                int t = eq ? find_target(argv[i]) : -1;
+                if (t < 0) {
+                    fprintf(stderr, "❌ Bad budget %s (want TARGET=MBPS)\n", argv[i]);
+                    return 1;
+                }
+                budget[t] = atof(eq + 1);
+            } else if (corpus_add_path(&corpus, argv[i]) != 0) {
+                return 1;
+            }
+        }
+        if (!corpus.count) {
+            usage();
+            return 1;
+        }
+        int saved = silence_stdout();
+        FILE *json = saved >= 0 ? fdopen(saved, "w") : NULL;
+        if (!json) {
+            return 1;
+        }
+        int missed = bench_targets(&corpus, min_time, budget, json);
+        fclose(json);
+        for (size_t i = 0; i < corpus.count; i++) free(corpus.data[i]);
+        free(corpus.data);
+        free(corpus.sizes);
+        return missed ? 1 : 0;
+    }
+
+    int t = find_target(argv[1]);
+    if (t < 0) {
+        usage();
+        return 1;
+    }
+    silence_stdout();
+    for (int i = 2; i < argc || i == 2; i++) {
+        size_t size;
+        unsigned char *data = read_input(i < argc ? argv[i] : NULL, &size);
+        if (!data) {
+            fprintf(stderr, "❌ Cannot read %s\n", i < argc ? argv[i] : "stdin");
+            return 1;
+        }
+        targets[t].fn(data, size);
+        free(data);
+        if (i >= argc) break;
+    }
+    return 0;
+}
+
+#endif
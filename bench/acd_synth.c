@@ -0,0 +1,427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "acd_synth.h"
+#include "acd_rll.h"
+
+// Opcode bytes by mnemonic, from the decoder's own table
+#define SYNTH_OPCODE(code, name, n) OP_##name = code,
+enum { ACD_RLL_INSTRUCTIONS(SYNTH_OPCODE) };
+#undef SYNTH_OPCODE
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} ByteBuf;
+
+static void buf_reserve(ByteBuf *b, size_t extra) {
+    if (b->failed || b->capacity - b->size >= extra) {
+        return;
+    }
+    size_t capacity = b->capacity ? b->capacity : 4096;
+    while (capacity - b->size < extra) capacity *= 2;
+    unsigned char *grown = realloc(b->data, capacity);
+    if (!grown) {
+        b->failed = 1;
+        return;
+    }
+    b->data = grown;
+    b->capacity = capacity;
+}
+
+static void buf_put(ByteBuf *b, const void *p, size_t len) {
+    buf_reserve(b, len);
+    if (b->failed) return;
+    memcpy(b->data + b->size, p, len);
+    b->size += len;
+}
+
+static void buf_u32(ByteBuf *b, uint32_t v) {
+    unsigned char le[4] = { (unsigned char)v, (unsigned char)(v >> 8),
+                            (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    buf_put(b, le, 4);
+}
+
+// u8 length prefix, truncated to 255 bytes
+static void buf_str8(ByteBuf *b, const char *s) {
+    size_t len = strlen(s);
+    unsigned char n = (unsigned char)(len > 255 ? 255 : len);
+    buf_put(b, &n, 1);
+    buf_put(b, s, n);
+}
+
+static void buf_text(ByteBuf *b, const char *s) {
+    buf_put(b, s, strlen(s));
+}
+
+// xorshift32: deterministic for a seed, no libc state
+static uint32_t next_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void put_random(ByteBuf *b, uint32_t *state, size_t len) {
+    buf_reserve(b, len);
+    if (b->failed) return;
+    for (size_t i = 0; i < len; i++) {
+        b->data[b->size++] = (unsigned char)(next_random(state) >> 24);
+    }
+}
+
+// Append src as one gzip member (zlib's default header: XFL 0, OS 3)
+static void put_gzip(ByteBuf *b, const unsigned char *src, size_t len) {
+    z_stream strm = {0};
+    if (deflateInit2(&strm, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        b->failed = 1;
+        return;
+    }
+    size_t bound = deflateBound(&strm, (uLong)len);
+    buf_reserve(b, bound);
+    if (b->failed) {
+        deflateEnd(&strm);
+        return;
+    }
+    strm.next_in = (Bytef *)src;
+    strm.avail_in = (uInt)len;
+    strm.next_out = b->data + b->size;
+    strm.avail_out = (uInt)bound;
+    if (deflate(&strm, Z_FINISH) != Z_STREAM_END) {
+        b->failed = 1;
+    } else {
+        b->size += strm.total_out;
+    }
+    deflateEnd(&strm);
+}
+
+typedef struct {
+    ByteBuf records;
+    ByteBuf offsets;
+    uint32_t count;
+    ByteBuf tag_xml;             // TagInfo.XML (as UTF-8), built alongside
+    uint32_t tag_count;
+    ByteBuf rung_records;        // RungCode database
+    ByteBuf rung_offsets;
+    uint32_t rung_count;
+} CompsBuilder;
+
+static uint32_t add_component(CompsBuilder *c, const char *name, const char *type,
+                              uint32_t parent, uint32_t ordinal, const char *ioi) {
+    uint32_t uid = ++c->count;
+    buf_u32(&c->offsets, (uint32_t)c->records.size);
+    buf_u32(&c->records, uid);
+    buf_str8(&c->records, name);
+    buf_str8(&c->records, ioi);
+    buf_u32(&c->records, parent);
+    buf_u32(&c->records, ordinal);
+    buf_str8(&c->records, type);
+    return uid;
+}
+
+// A Tag component plus its TagInfo.XML element: a mix of atomic types, a
+// TIMER/COUNTER every few tags, a UDT, some arrays and aliases, and a
+// description now and then
+static void add_tag(CompsBuilder *c, const char *name, uint32_t scope, uint32_t ordinal, const char *ioi) {
+    static const char *types[] = { "DINT", "BOOL", "REAL", "TIMER", "DINT", "COUNTER", "UDT_0", "INT" };
+    add_component(c, name, "Tag", scope, ordinal, ioi);
+    uint32_t n = c->tag_count++;
+    char element[256];
+    int len = snprintf(element, sizeof(element), "<Tag Name=\"%s\" TagType=\"%s\" DataType=\"%s\"", name,
+                       n % 11 == 10 ? "Alias" : "Base", types[n % 8]);
+    if (n % 15 == 0) {
+        len += snprintf(element + len, sizeof(element) - (size_t)len, " Dimensions=\"10 4\"");
+    } else if (n % 5 == 0) {
+        len += snprintf(element + len, sizeof(element) - (size_t)len, " Dimensions=\"10\"");
+    }
+    if (n % 11 == 10) {
+        len += snprintf(element + len, sizeof(element) - (size_t)len, " AliasFor=\"Ctrl_Tag_0.%u\"", n % 32);
+    }
+    snprintf(element + len, sizeof(element) - (size_t)len, " ExternalAccess=\"%s\"%s",
+             n % 7 == 0 ? "Read Only" : "Read/Write", n % 9 == 0 ? ">" : "/>\n");
+    buf_text(&c->tag_xml, element);
+    if (n % 9 == 0) {
+        buf_text(&c->tag_xml, "<Description><![CDATA[Start <push> button & \"lamp\"]]></Description>"
+                 "<Data Format=\"L5K\"><![CDATA[0]]></Data></Tag>\n");
+    }
+}
+
+// The UDT_<i> definition: a hidden host for its BIT members, then a few
+// members of other types including an array and a nested UDT
+static void add_datatype(ByteBuf *xml, uint32_t i) {
+    char element[512];
+    snprintf(element, sizeof(element),
+             "<DataType Name=\"UDT_%u\" Family=\"NoFamily\" Class=\"User\">\n<Members>\n"
+             "<Member Name=\"ZZZZZZZZZZUDT_%u0\" DataType=\"SINT\" Dimension=\"0\" Hidden=\"true\"/>\n"
+             "<Member Name=\"Run\" DataType=\"BIT\" Dimension=\"0\" Hidden=\"false\"/>\n"
+             "<Member Name=\"Count\" DataType=\"DINT\" Dimension=\"0\" Hidden=\"false\"/>\n"
+             "<Member Name=\"Samples\" DataType=\"REAL\" Dimension=\"%u\" Hidden=\"false\"/>\n",
+             i, i, 4 + i);
+    buf_text(xml, element);
+    if (i > 0) {
+        snprintf(element, sizeof(element),
+                 "<Member Name=\"Inner\" DataType=\"UDT_%u\" Dimension=\"0\" Hidden=\"false\"/>\n", i - 1);
+        buf_text(xml, element);
+    }
+    buf_text(xml, "</Members>\n</DataType>\n");
+}
+
+// TagInfo.XML is stored as UTF-16LE with a byte order mark; the synthetic
+// text is ASCII, so each byte becomes one unit
+static void put_utf16(ByteBuf *out, const ByteBuf *text) {
+    static const unsigned char bom[2] = { 0xFF, 0xFE };
+    buf_put(out, bom, sizeof(bom));
+    buf_reserve(out, text->size * 2);
+    for (size_t i = 0; i < text->size && !out->failed; i++) {
+        out->data[out->size++] = text->data[i];
+        out->data[out->size++] = 0;
+    }
+    if (text->failed) out->failed = 1;
+}
+
+static void code_op(ByteBuf *b, unsigned char op) {
+    buf_put(b, &op, 1);
+}
+
+static void code_text(ByteBuf *b, const char *s) {
+    code_op(b, RLL_OPERAND_TEXT);
+    buf_str8(b, s);
+}
+
+static void code_int(ByteBuf *b, int32_t v) {
+    code_op(b, RLL_OPERAND_INT);
+    buf_u32(b, (uint32_t)v);
+}
+
+static void code_real(ByteBuf *b, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    code_op(b, RLL_OPERAND_REAL);
+    buf_u32(b, bits);
+}
+
+// Rung logic in four shapes (contacts and coil, a timer behind a branch,
+// math, a compare with a latch/unlatch branch) over the given tag names
+static void build_rung_code(ByteBuf *code, size_t k, const char *a, const char *b, const char *c) {
+    switch (k % 4) {
+        case 0:
+            code_op(code, OP_XIC); code_text(code, a);
+            code_op(code, OP_XIO); code_text(code, b);
+            code_op(code, OP_OTE); code_text(code, c);
+            break;
+        case 1:
+            code_op(code, RLL_BRANCH_START);
+            code_op(code, OP_XIC); code_text(code, a);
+            code_op(code, RLL_BRANCH_NEXT);
+            code_op(code, OP_XIC); code_text(code, b);
+            code_op(code, RLL_BRANCH_END);
+            code_op(code, OP_TON); code_text(code, c); code_int(code, 1000); code_int(code, 0);
+            break;
+        case 2:
+            code_op(code, OP_XIC); code_text(code, a);
+            code_op(code, OP_MOV); code_int(code, (int32_t)k); code_text(code, b);
+            code_op(code, OP_ADD); code_text(code, b); code_real(code, 1.5f); code_text(code, c);
+            break;
+        default:
+            code_op(code, OP_GRT); code_text(code, a); code_int(code, 10);
+            code_op(code, RLL_BRANCH_START);
+            code_op(code, OP_OTL); code_text(code, b);
+            code_op(code, RLL_BRANCH_NEXT);
+            code_op(code, OP_OTU); code_text(code, c);
+            code_op(code, RLL_BRANCH_END);
+            break;
+    }
+}
+
+// A Rung component plus its RungCode record, on tags named prefix0 ..
+// prefix<tags - 1>
+static void add_rung(CompsBuilder *c, ByteBuf *code, const char *name, uint32_t routine, uint32_t ordinal,
+                     size_t k, const char *prefix, size_t tags) {
+    uint32_t uid = add_component(c, name, "Rung", routine, ordinal, "");
+    char a[64], b[64], t[64];
+    snprintf(a, sizeof(a), "%s%zu", prefix, k % tags);
+    snprintf(b, sizeof(b), "%s%zu", prefix, (k + 1) % tags);
+    snprintf(t, sizeof(t), "%s%zu", prefix, (k + 2) % tags);
+    code->size = 0;
+    build_rung_code(code, k, a, b, t);
+
+    c->rung_count++;
+    buf_u32(&c->rung_offsets, (uint32_t)c->rung_records.size);
+    buf_u32(&c->rung_records, uid);
+    buf_u32(&c->rung_records, routine);
+    buf_u32(&c->rung_records, (uint32_t)code->size);
+    buf_put(&c->rung_records, code->data, code->size);
+    if (code->failed) c->rung_records.failed = 1;
+}
+
+static void put_database(ByteBuf *out, const char *fields, size_t fields_len, const ByteBuf *records,
+                         const ByteBuf *offsets, uint32_t count) {
+    buf_put(out, fields, fields_len);  // Includes the empty closing name
+    buf_put(out, ".dat", 4);
+    buf_u32(out, (uint32_t)records->size);
+    buf_put(out, records->data, records->size);
+    buf_put(out, ".idx", 4);
+    buf_u32(out, count);
+    buf_put(out, offsets->data, offsets->size);
+    if (records->failed || offsets->failed) out->failed = 1;
+}
+
+// Comps database into out, TagInfo.XML into tags, RungCode into rungs
+static void build_comps(ByteBuf *out, ByteBuf *tags, ByteBuf *rungs, const SynthOptions *o) {
+    // Real blocks name the database by path; parse_block expects the prefix
+    static const char fields[] = "C:\\Temp\\Comps\0CompUId\0CompName\0CompIOI\0AlternateParentUId\0Ordinal\0CompType\0";
+    static const char rung_fields[] = "C:\\Temp\\RungCode\0RungUId\0RoutineUId\0Code\0";
+    CompsBuilder c = {0};
+    ByteBuf code = {0};
+    char name[64], ioi[64];
+
+    uint32_t root = add_component(&c, "Synthetic_Controller", "Controller", 0, 0, "");
+    buf_text(&c.tag_xml, "<?xml version=\"1.0\" encoding=\"UTF-16\"?>\n<!-- TagInfo -->\n"
+             "<Controller Name=\"Synthetic_Controller\" ProcessorType=\"1756-L85E\">\n<DataTypes>\n");
+    for (uint32_t i = 0; i < 8; i++) {
+        snprintf(name, sizeof(name), "UDT_%u", i);
+        add_component(&c, name, "DataType", root, i, "");
+        add_datatype(&c.tag_xml, i);
+    }
+    buf_text(&c.tag_xml, "</DataTypes>\n<Tags>\n");
+    for (uint32_t i = 0; i < 8; i++) {
+        snprintf(name, sizeof(name), "Local:%u", i);
+        add_component(&c, name, "Module", root, i, "");
+    }
+    for (uint32_t i = 0; i < 32; i++) {
+        snprintf(name, sizeof(name), "Ctrl_Tag_%u", i);
+        snprintf(ioi, sizeof(ioi), "Ctrl_Tag_%u.Value", i);
+        add_tag(&c, name, 0, i, ioi);
+    }
+    buf_text(&c.tag_xml, "</Tags>\n<Programs>\n");
+    for (size_t p = 0; p < o->programs; p++) {
+        snprintf(name, sizeof(name), "Program_%zu", p);
+        uint32_t program = add_component(&c, name, "Program", root, (uint32_t)p, "");
+        char element[128];
+        snprintf(element, sizeof(element), "<Program Name=\"%s\" Type=\"Normal\">\n<Tags>\n", name);
+        buf_text(&c.tag_xml, element);
+        for (size_t t = 0; t < o->tags; t++) {
+            snprintf(name, sizeof(name), "P%zu_Tag_%zu", p, t);
+            add_tag(&c, name, program, (uint32_t)t, "");
+        }
+        buf_text(&c.tag_xml, "</Tags>\n</Program>\n");
+        // Rungs use the program's tags, or the controller's if it has none
+        char prefix[32] = "Ctrl_Tag_";
+        if (o->tags) snprintf(prefix, sizeof(prefix), "P%zu_Tag_", p);
+        for (size_t r = 0; r < o->routines; r++) {
+            snprintf(name, sizeof(name), "Routine_%zu", r);
+            uint32_t routine = add_component(&c, name, "Routine", program, (uint32_t)(10 + r), "");
+            for (size_t k = 0; k < o->rungs; k++) {
+                snprintf(name, sizeof(name), "Rung %zu <check> & \"set\"", k);
+                add_rung(&c, &code, name, routine, (uint32_t)(o->rungs - k), k, prefix,
+                         o->tags ? o->tags : 32);
+            }
+        }
+    }
+
+    put_database(out, fields, sizeof(fields), &c.records, &c.offsets, c.count);
+    buf_text(&c.tag_xml, "</Programs>\n</Controller>\n");
+    put_utf16(tags, &c.tag_xml);
+    put_database(rungs, rung_fields, sizeof(rung_fields), &c.rung_records, &c.rung_offsets, c.rung_count);
+    free(code.data);
+    free(c.records.data);
+    free(c.offsets.data);
+    free(c.tag_xml.data);
+    free(c.rung_records.data);
+    free(c.rung_offsets.data);
+}
+
+// Half random, half repetitive text: compresses to roughly half its size
+static void build_filler(ByteBuf *out, uint32_t *state, size_t len) {
+    static const char *words[] = { "Tag", "Value", "Timer", "Counter", "Preset", "Accum", "Enable",
+                                   "Done", "Motor", "Valve", "Pump", "Level", "Alarm", "Setpoint" };
+    size_t half = len / 2;
+    put_random(out, state, half);
+    while (!out->failed && out->size < len) {
+        const char *w = words[next_random(state) % (sizeof(words) / sizeof(words[0]))];
+        buf_put(out, w, strlen(w));
+        buf_put(out, " ", 1);
+    }
+    if (out->size > len) out->size = len;
+}
+
+void acd_synth_defaults(SynthOptions *options) {
+    options->size = 16u << 20;
+    options->blocks = 64;
+    options->programs = 20;
+    options->tags = 4;
+    options->routines = 4;
+    options->rungs = 50;
+    options->false_positives = 1000;
+    options->seed = 1;
+}
+
+int acd_synth_generate(const SynthOptions *o, unsigned char **data, size_t *size) {
+    *data = NULL;
+    *size = 0;
+    ByteBuf file = {0}, block = {0}, tags = {0}, rungs = {0};
+    uint32_t state = o->seed ? o->seed : 1;
+    size_t blocks = o->blocks < 2 ? 2 : o->blocks;
+
+    static const char header[] =
+        "=~=~=~=~=~=~=~=~=~=~=~= Project Information =~=~=~=~=~=~=~=~=~=~=~=\r\n"
+        "\r\n"
+        " Name: Synthetic_Controller\r\n"
+        " Revision: 34.01\r\n"
+        " Version: 34.01.00\r\n"
+        "\r\n"
+        "=~=~=~=~=~=~=~=~=~=~=~= Save History =~=~=~=~=~=~=~=~=~=~=~=\r\n"
+        " Save: 2024-01-01 synthetic\r\n";
+    buf_put(&file, header, sizeof(header) - 1);
+    static const unsigned char pad[16];
+    buf_put(&file, pad, sizeof(pad));
+
+    // Spread the fake headers over the gaps after each member
+    size_t fakes_left = o->false_positives;
+    for (size_t i = 0; i < blocks && !file.failed && !block.failed; i++) {
+        block.size = 0;
+        if (i == 0) {
+            static const char xml[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><QuickInfo Name=\"Synthetic\"/>";
+            for (int k = 0; k < 64; k++) buf_put(&block, xml, sizeof(xml) - 1);
+        } else if (i == 1) {
+            build_comps(&block, &tags, &rungs, o);
+        } else if (i == 2) {
+            buf_put(&block, tags.data, tags.size);
+            if (tags.failed) block.failed = 1;
+        } else if (i == 3) {
+            buf_put(&block, rungs.data, rungs.size);
+            if (rungs.failed) block.failed = 1;
+        } else {
+            // Filler shares whatever size is left
+            size_t left = o->size > file.size ? o->size - file.size : 0;
+            size_t share = left / (blocks - i);
+            build_filler(&block, &state, share * 2);
+        }
+        put_gzip(&file, block.data, block.size);
+
+        size_t fakes = fakes_left / (blocks - i);
+        fakes_left -= fakes;
+        for (size_t f = 0; f < fakes; f++) {
+            static const unsigned char fake[] = { 0x1F, 0x8B, 0x08, 0x00 };
+            buf_put(&file, fake, sizeof(fake));
+            put_random(&file, &state, 12 + next_random(&state) % 52);
+        }
+        buf_put(&file, pad, 7);
+    }
+
+    free(block.data);
+    free(tags.data);
+    free(rungs.data);
+    if (file.failed || block.failed) {
+        free(file.data);
+        return -1;
+    }
+    *data = file.data;
+    *size = file.size;
+    return 0;
+}
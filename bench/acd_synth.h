@@ -0,0 +1,35 @@
+#ifndef ACD_SYNTH_H
+#define ACD_SYNTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Synthetic ACD-like files for benchmarks, laid out the way the parsers
+// expect: a " Key: Value" text header, then a binary region of gzip
+// members separated by short gaps. One member is a QuickInfo XML block,
+// one a Comps database (acd_comps layout) holding a controller with
+// DataTypes, Modules, Tags and Programs of Routines of Rungs, one (with 3+
+// blocks) the UTF-16LE TagInfo.XML describing those tags, programs and
+// the UDT definitions (what acd_tags reads),
+// one (with 4+ blocks) the RungCode logic of those rungs (acd_rll layout),
+// and the rest are half-compressible filler. Gaps can carry fake 1F 8B 08
+// headers to exercise candidate validation.
+typedef struct {
+    size_t size;                 // Approximate file size in bytes
+    size_t blocks;               // gzip members, at least 2
+    size_t programs;
+    size_t tags;                 // Per program, besides 32 controller tags
+    size_t routines;             // Per program
+    size_t rungs;                // Per routine
+    size_t false_positives;      // Fake gzip headers spread over the gaps
+    uint32_t seed;
+} SynthOptions;
+
+// 16 MB, 64 blocks, 20 programs x (4 tags, 4 routines x 50 rungs), 1000 fakes
+void acd_synth_defaults(SynthOptions *options);
+
+// Build a file into a malloc'd buffer. Same options and seed give the
+// same bytes. Returns 0, or -1 on allocation/compression failure.
+int acd_synth_generate(const SynthOptions *options, unsigned char **data, size_t *size);
+
+#endif
@@ -0,0 +1,121 @@
+// Inflate backend benchmark over a corpus of ACD files
+//
+// Decodes every indexed member of every file, first with the streaming
+// zlib path (sizes unknown, buffer grown as it goes) and then with the
+// compiled-in one-shot backend, and prints one JSON object per line.
+// Build once per backend and compare:
+//
+//   cc -O2 -I. -o bench_inflate bench/bench_inflate.c acd_*.c -lz -pthread
+//   cc -O2 -I. -DACD_INFLATE_LIBDEFLATE -o bench_inflate_ld bench/bench_inflate.c acd_*.c -ldeflate -lz -pthread
+//   ./bench_inflate [--iterations N] corpus/*.ACD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acd.h"
+
+typedef struct {
+    ACD_File acd;
+    CompressedBlock *blocks;
+    size_t count;
+} CorpusFile;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Decode every block of the corpus once; returns bytes produced, or 0 on
+// a decode failure
+static size_t run_pass(CorpusFile *files, size_t file_count, InflateContext *ctx, int oneshot) {
+    size_t produced = 0;
+    for (size_t f = 0; f < file_count; f++) {
+        for (size_t i = 0; i < files[f].count; i++) {
+            CompressedBlock block = files[f].blocks[i];
+            if (!oneshot) {
+                // Forget the sizes so the streaming path is taken
+                block.compressed_size = 0;
+                block.uncompressed_size = 0;
+            }
+            if (acd_block_inflate_ctx(ctx, &files[f].acd, &block) != Z_STREAM_END) {
+                fprintf(stderr, "decode failed: block at 0x%lx\n", block.offset);
+                return 0;
+            }
+            produced += block.uncompressed_size;
+            acd_block_free(&block);
+        }
+    }
+    return produced;
+}
+
+static void report(const char *mode, size_t in_bytes, size_t out_bytes, size_t blocks,
+                   int iterations, double seconds) {
+    printf("{\"bench\":\"inflate\",\"mode\":\"%s\",\"backend\":\"%s\",\"blocks\":%zu,"
+           "\"compressed_bytes\":%zu,\"bytes\":%zu,\"iterations\":%d,\"seconds\":%.6f,\"mb_per_s\":%.1f}\n",
+           mode, strcmp(mode, "streaming") == 0 ? "zlib" : acd_inflate_backend(), blocks,
+           in_bytes, out_bytes, iterations, seconds,
+           seconds > 0 ? (double)out_bytes * iterations / seconds / 1e6 : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = 5;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+        iterations = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || iterations <= 0) {
+        fprintf(stderr, "Usage: %s [--iterations N] <file.ACD>...\n", argv[0]);
+        return 1;
+    }
+
+    size_t file_count = (size_t)(argc - first);
+    CorpusFile *files = calloc(file_count, sizeof(*files));
+    if (!files) {
+        return 1;
+    }
+    size_t blocks = 0, in_bytes = 0;
+    for (size_t f = 0; f < file_count; f++) {
+        const char *path = argv[first + (int)f];
+        if (acd_file_open(&files[f].acd, path) != 0 ||
+            acd_index_blocks(path, &files[f].acd, &files[f].blocks, &files[f].count, NULL) != 0) {
+            fprintf(stderr, "cannot index %s\n", path);
+            return 1;
+        }
+        blocks += files[f].count;
+        for (size_t i = 0; i < files[f].count; i++) {
+            in_bytes += files[f].blocks[i].compressed_size;
+        }
+    }
+
+    InflateContext ctx;
+    inflate_context_init(&ctx);
+    int status = 0;
+    for (int oneshot = 0; oneshot <= 1 && status == 0; oneshot++) {
+        // One untimed pass warms the page cache and the allocator
+        size_t out_bytes = run_pass(files, file_count, &ctx, oneshot);
+        double start = now_seconds();
+        for (int i = 0; i < iterations && out_bytes; i++) {
+            if (run_pass(files, file_count, &ctx, oneshot) != out_bytes) {
+                out_bytes = 0;
+            }
+        }
+        if (!out_bytes && blocks) {
+            status = 1;
+            break;
+        }
+        report(oneshot ? "oneshot" : "streaming", in_bytes, out_bytes, blocks, iterations,
+               now_seconds() - start);
+    }
+    inflate_context_end(&ctx);
+
+    for (size_t f = 0; f < file_count; f++) {
+        free(files[f].blocks);
+        acd_file_close(&files[f].acd);
+    }
+    free(files);
+    return status;
+}
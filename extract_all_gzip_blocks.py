@@ -1,14 +1,12 @@
 #!/usr/bin/env python3
 """
-Extract ALL GZIP blocks from ACD file using multiple strategies
+Extract ALL GZIP blocks from ACD file (through libacd when it is built)
 """
 
-import os
-import gzip
-import zlib
-import struct
 from pathlib import Path
 
+from acd_gzip_members import gzip_members, libacd
+
 class GZIPBlockExtractor:
     def __init__(self, acd_file):
         self.acd_file = Path(acd_file)
@@ -21,121 +19,32 @@ class GZIPBlockExtractor:
         print(f"📄 Loaded ACD file: {self.acd_file.name}")
         print(f"📏 Size: {len(self.data):,} bytes")
         
-    def find_all_gzip_headers(self):
-        """Find all GZIP headers in the file"""
-        headers = []
-        offset = 0
-        
-        while offset < len(self.data):
-            pos = self.data.find(b'\x1F\x8B', offset)
-            if pos == -1:
-                break
-            
-            # Check if it's a valid GZIP header (next byte should be 0x08)
-            if pos + 2 < len(self.data) and self.data[pos + 2] == 0x08:
-                headers.append(pos)
-            
-            offset = pos + 1
-        
-        print(f"\n🔍 Found {len(headers)} potential GZIP headers")
-        return headers
-    
-    def extract_gzip_block(self, start_pos, block_num):
-        """Try to extract a GZIP block starting at given position"""
-        # Strategy 1: Try standard gzip decompression with various sizes
-        test_sizes = [
-            100, 500, 1000, 5000, 10000, 50000, 100000, 500000,
-            1000000, 2000000, 5000000, 10000000, 20000000
-        ]
-        
-        for size in test_sizes:
-            if start_pos + size > len(self.data):
-                size = len(self.data) - start_pos
-            
-            try:
-                compressed_data = self.data[start_pos:start_pos + size]
-                decompressed = gzip.decompress(compressed_data)
-                
-                # Success! Save the block
-                output_file = self.output_dir / f"block_{block_num:03d}_offset_0x{start_pos:x}_gzip.bin"
-                with open(output_file, 'wb') as f:
-                    f.write(decompressed)
-                
-                print(f"✅ Block {block_num}: offset=0x{start_pos:x}, "
-                      f"compressed={size:,}, decompressed={len(decompressed):,}")
-                
-                return size, len(decompressed)
-                
-            except Exception:
-                continue
-        
-        # Strategy 2: Try zlib decompression (raw deflate)
-        for size in test_sizes[:10]:  # Try smaller sizes for zlib
-            if start_pos + size > len(self.data):
-                size = len(self.data) - start_pos
-            
-            try:
-                # Skip GZIP header (10 bytes) and try raw deflate
-                compressed_data = self.data[start_pos + 10:start_pos + size]
-                decompressed = zlib.decompress(compressed_data)
-                
-                output_file = self.output_dir / f"block_{block_num:03d}_offset_0x{start_pos:x}_zlib.bin"
-                with open(output_file, 'wb') as f:
-                    f.write(decompressed)
-                
-                print(f"✅ Block {block_num} (zlib): offset=0x{start_pos:x}, "
-                      f"compressed={size:,}, decompressed={len(decompressed):,}")
-                
-                return size, len(decompressed)
-                
-            except Exception:
-                continue
-        
-        # Strategy 3: Try to find the end of GZIP block
-        # GZIP format ends with CRC32 (4 bytes) + uncompressed size (4 bytes)
-        for end_offset in range(start_pos + 50, min(start_pos + 50000000, len(self.data))):
-            try:
-                compressed_data = self.data[start_pos:end_offset]
-                decompressed = gzip.decompress(compressed_data)
-                
-                # Check if the following 8 bytes could be CRC + size
-                if end_offset + 8 <= len(self.data):
-                    potential_size = struct.unpack('<I', self.data[end_offset-4:end_offset])[0]
-                    if potential_size == len(decompressed) % (2**32):
-                        # This looks like a valid GZIP ending
-                        output_file = self.output_dir / f"block_{block_num:03d}_offset_0x{start_pos:x}_exact.bin"
-                        with open(output_file, 'wb') as f:
-                            f.write(decompressed)
-                        
-                        print(f"✅ Block {block_num} (exact): offset=0x{start_pos:x}, "
-                              f"compressed={end_offset-start_pos:,}, decompressed={len(decompressed):,}")
-                        
-                        return end_offset - start_pos, len(decompressed)
-                
-            except Exception:
-                continue
-        
-        print(f"❌ Block {block_num}: Failed to extract from offset 0x{start_pos:x}")
-        return 0, 0
-    
     def extract_all_blocks(self):
         """Extract all GZIP blocks from the ACD file"""
-        headers = self.find_all_gzip_headers()
-        
         print("\n🗜️  Extracting compressed blocks...")
+        if libacd is None:
+            print("  (libacd extension not built, using zlib)")
         
         total_extracted = 0
         total_decompressed_size = 0
         
-        for i, header_pos in enumerate(headers):
-            compressed_size, decompressed_size = self.extract_gzip_block(header_pos, i + 1)
+        # Each member is decompressed once and its exact end taken from the
+        # stream, then the search resumes after it
+        for i, (start_pos, compressed_size, decompressed) in enumerate(
+                gzip_members(self.acd_file, self.data)):
+            block_num = i + 1
+            output_file = self.output_dir / f"block_{block_num:03d}_offset_0x{start_pos:x}_gzip.bin"
+            with open(output_file, 'wb') as f:
+                f.write(decompressed)
+            
+            print(f"✅ Block {block_num}: offset=0x{start_pos:x}, "
+                  f"compressed={compressed_size:,}, decompressed={len(decompressed):,}")
             
-            if compressed_size > 0:
-                total_extracted += 1
-                total_decompressed_size += decompressed_size
+            total_extracted += 1
+            total_decompressed_size += len(decompressed)
         
         print(f"\n📊 Summary:")
-        print(f"  Total blocks extracted: {total_extracted}/{len(headers)}")
+        print(f"  Total blocks extracted: {total_extracted}")
         print(f"  Total decompressed size: {total_decompressed_size:,} bytes")
         
         return total_extracted
@@ -0,0 +1,448 @@
+// CPython binding to libacd
+//
+// Exposes the mapped file, the gzip candidate scanner, the block index,
+// the member decoder and random reads inside a member. Nothing is copied
+// on the way out: an AcdFile is itself a read-only buffer over the
+// mapping, and inflate() returns a memoryview over the block's own decoded
+// buffer, which lives as long as the view. read() decodes only as far as
+// the range it returns, and the AcdFile keeps the last member's reader
+// (its checkpoints and stream position) for the next read() of that
+// member. Scans, index builds, inflates and reads run with the GIL
+// released.
+//
+//   cd python && python setup.py build_ext --inplace
+//
+//   import libacd
+//   with libacd.AcdFile("Project.ACD") as acd:
+//       for offset, csize, usize, crc, kind in acd.blocks():
+//           data = acd.inflate(offset, csize, usize)   # memoryview
+//           head = acd.read(offset, 0, 4096)             # bytes
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acd_file.h"
+#include "acd_scan.h"
+#include "acd_block.h"
+#include "acd_index.h"
+#include "acd_blockread.h"
+
+// Decoded member: owns the buffer a memoryview from inflate() points at
+typedef struct {
+    PyObject_HEAD
+    unsigned char *data;
+    Py_ssize_t size;
+} BlockObject;
+
+static void block_dealloc(BlockObject *self) {
+    free(self->data);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int block_getbuffer(BlockObject *self, Py_buffer *view, int flags) {
+    return PyBuffer_FillInfo(view, (PyObject *)self, self->data, self->size, 1, flags);
+}
+
+static PyBufferProcs block_as_buffer = {
+    .bf_getbuffer = (getbufferproc)block_getbuffer,
+};
+
+static PyTypeObject BlockType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "libacd.Block",
+    .tp_basicsize = sizeof(BlockObject),
+    .tp_dealloc = (destructor)block_dealloc,
+    .tp_as_buffer = &block_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Decoded gzip member (exported through memoryview)",
+};
+
+typedef struct {
+    PyObject_HEAD
+    ACD_File acd;
+    PyObject *path;
+    int open;
+    int exports;                 // Buffer views of the mapping still alive
+    int busy;                    // Calls running without the GIL
+    BlockReader reader;          // Member of the last read(), kept for the next
+    long reader_offset;
+    int reader_open;
+    int reading;                 // reader in use by a call without the GIL
+} AcdFileObject;
+
+static int check_open(AcdFileObject *self) {
+    if (!self->open) {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on closed AcdFile");
+        return -1;
+    }
+    return 0;
+}
+
+static int acdfile_init(AcdFileObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "path", NULL };
+    PyObject *path;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist, PyUnicode_FSConverter, &path)) {
+        return -1;
+    }
+    if (self->open) {
+        PyErr_SetString(PyExc_RuntimeError, "AcdFile already open");
+        Py_DECREF(path);
+        return -1;
+    }
+    int ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = acd_file_open(&self->acd, PyBytes_AS_STRING(path));
+    if (ret == 0) self->acd.binary_start = acd_find_binary_start(&self->acd);
+    Py_END_ALLOW_THREADS
+    if (ret != 0) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        Py_DECREF(path);
+        return -1;
+    }
+    Py_XSETREF(self->path, path);
+    self->open = 1;
+    return 0;
+}
+
+static PyObject *acdfile_close(AcdFileObject *self, PyObject *unused) {
+    (void)unused;
+    if (!self->open) {
+        Py_RETURN_NONE;
+    }
+    if (self->exports || self->busy) {
+        PyErr_SetString(PyExc_BufferError, "AcdFile still has views or calls in progress");
+        return NULL;
+    }
+    if (self->reader_open) acd_block_close(&self->reader);
+    self->reader_open = 0;
+    acd_file_close(&self->acd);
+    self->open = 0;
+    Py_RETURN_NONE;
+}
+
+static void acdfile_dealloc(AcdFileObject *self) {
+    if (self->reader_open) acd_block_close(&self->reader);
+    if (self->open) acd_file_close(&self->acd);
+    Py_XDECREF(self->path);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *acdfile_enter(AcdFileObject *self, PyObject *unused) {
+    (void)unused;
+    if (check_open(self) != 0) return NULL;
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject *acdfile_exit(AcdFileObject *self, PyObject *args) {
+    (void)args;
+    return acdfile_close(self, NULL);
+}
+
+static int acdfile_getbuffer(AcdFileObject *self, Py_buffer *view, int flags) {
+    if (check_open(self) != 0) {
+        view->obj = NULL;
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *)self, (void *)self->acd.data, self->acd.file_size, 1, flags) != 0) {
+        return -1;
+    }
+    self->exports++;
+    return 0;
+}
+
+static void acdfile_releasebuffer(AcdFileObject *self, Py_buffer *view) {
+    (void)view;
+    self->exports--;
+}
+
+static PyBufferProcs acdfile_as_buffer = {
+    .bf_getbuffer = (getbufferproc)acdfile_getbuffer,
+    .bf_releasebuffer = (releasebufferproc)acdfile_releasebuffer,
+};
+
+// List of Python ints from candidate offsets
+static PyObject *offsets_to_list(const CandidateList *list) {
+    PyObject *out = PyList_New((Py_ssize_t)list->count);
+    for (size_t i = 0; out && i < list->count; i++) {
+        PyObject *n = PyLong_FromLong(list->offsets[i]);
+        if (!n) {
+            Py_CLEAR(out);
+            break;
+        }
+        PyList_SET_ITEM(out, (Py_ssize_t)i, n);
+    }
+    return out;
+}
+
+static PyObject *acdfile_scan(AcdFileObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "start", "stop", NULL };
+    Py_ssize_t start = -1, stop = -1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nn", kwlist, &start, &stop) || check_open(self) != 0) {
+        return NULL;
+    }
+    if (start < 0) start = self->acd.binary_start;
+    if (stop < 0 || stop > self->acd.file_size) stop = self->acd.file_size;
+    if (start > stop) start = stop;
+
+    CandidateList list = {0};
+    int ret;
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = acd_scan_gzip(self->acd.data + start, (size_t)(stop - start), (long)start, &list);
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    PyObject *out = ret == 0 ? offsets_to_list(&list) : PyErr_NoMemory();
+    candidate_list_free(&list);
+    return out;
+}
+
+static PyObject *acdfile_blocks(AcdFileObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "use_index", NULL };
+    int use_index = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", kwlist, &use_index) || check_open(self) != 0) {
+        return NULL;
+    }
+    CompressedBlock *blocks = NULL;
+    size_t count = 0;
+    int ret;
+    const char *path = PyBytes_AS_STRING(self->path);
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    if (use_index) {
+        ret = acd_index_blocks(path, &self->acd, &blocks, &count, NULL);
+    } else {
+        ret = acd_index_build(&self->acd, &blocks, &count);
+    }
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    if (ret != 0) {
+        free(blocks);
+        return PyErr_NoMemory();
+    }
+
+    PyObject *out = PyList_New((Py_ssize_t)count);
+    for (size_t i = 0; out && i < count; i++) {
+        const CompressedBlock *b = &blocks[i];
+        PyObject *entry = Py_BuildValue("(lIIIs)", b->offset, b->compressed_size, b->uncompressed_size,
+                                        b->crc32, acd_block_kind_name(b->kind));
+        if (!entry) {
+            Py_CLEAR(out);
+            break;
+        }
+        PyList_SET_ITEM(out, (Py_ssize_t)i, entry);
+    }
+    free(blocks);
+    return out;
+}
+
+static PyObject *acdfile_inflate(AcdFileObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "offset", "compressed_size", "uncompressed_size", NULL };
+    long offset;
+    unsigned int compressed_size = 0, uncompressed_size = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "l|II", kwlist, &offset, &compressed_size,
+                                     &uncompressed_size) || check_open(self) != 0) {
+        return NULL;
+    }
+    if (!acd_file_ptr(&self->acd, offset, GZIP_HEADER_SIZE)) {
+        PyErr_Format(PyExc_ValueError, "offset %ld is outside the file", offset);
+        return NULL;
+    }
+    // Sizes only help when both are known (the one-shot path)
+    CompressedBlock block = { .offset = offset };
+    if (compressed_size && uncompressed_size) {
+        block.compressed_size = compressed_size;
+        block.uncompressed_size = uncompressed_size;
+    }
+    int ret;
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = acd_block_inflate(&self->acd, &block);
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    if (ret != Z_STREAM_END) {
+        acd_block_free(&block);
+        if (ret == Z_MEM_ERROR) return PyErr_NoMemory();
+        PyErr_Format(PyExc_ValueError, "no complete gzip member at offset %ld", offset);
+        return NULL;
+    }
+
+    BlockObject *owner = PyObject_New(BlockObject, &BlockType);
+    if (!owner) {
+        acd_block_free(&block);
+        return NULL;
+    }
+    owner->data = block.data;
+    owner->size = (Py_ssize_t)block.uncompressed_size;
+    PyObject *view = PyMemoryView_FromObject((PyObject *)owner);
+    Py_DECREF(owner);
+    return view;
+}
+
+static PyObject *acdfile_read(AcdFileObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = { "offset", "start", "length", NULL };
+    long offset;
+    unsigned long long start;
+    Py_ssize_t length;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "lKn", kwlist, &offset, &start, &length) ||
+        check_open(self) != 0) {
+        return NULL;
+    }
+    if (length < 0) {
+        PyErr_SetString(PyExc_ValueError, "length must not be negative");
+        return NULL;
+    }
+    if (!acd_file_ptr(&self->acd, offset, GZIP_HEADER_SIZE)) {
+        PyErr_Format(PyExc_ValueError, "offset %ld is outside the file", offset);
+        return NULL;
+    }
+    PyObject *out = PyBytes_FromStringAndSize(NULL, length);
+    if (!out) {
+        return NULL;
+    }
+    // One call at a time uses the kept reader; a concurrent one opens its own
+    int shared = !self->reading;
+    BlockReader local, *r = shared ? &self->reader : &local;
+    int opened = shared && self->reader_open && self->reader_offset == offset;
+    long n = -1;
+    self->reading |= shared;
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    if (!opened) {
+        if (shared && self->reader_open) acd_block_close(r);
+        opened = acd_block_open(r, &self->acd, NULL, 0, offset, ACD_BLOCK_SPAN_DEFAULT) == 0;
+    }
+    if (opened) n = acd_block_read(r, start, PyBytes_AS_STRING(out), (size_t)length);
+    // A failed read leaves the stream unusable
+    if (opened && (n < 0 || !shared)) {
+        acd_block_close(r);
+        opened = 0;
+    }
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    if (shared) {
+        self->reader_open = opened;
+        self->reader_offset = offset;
+        self->reading = 0;
+    }
+    if (n < 0) {
+        Py_DECREF(out);
+        PyErr_Format(PyExc_ValueError, "no readable gzip member at offset %ld", offset);
+        return NULL;
+    }
+    if (n != length && _PyBytes_Resize(&out, n) != 0) {
+        return NULL;
+    }
+    return out;
+}
+
+static PyObject *acdfile_get_size(AcdFileObject *self, void *closure) {
+    (void)closure;
+    if (check_open(self) != 0) return NULL;
+    return PyLong_FromLong(self->acd.file_size);
+}
+
+static PyObject *acdfile_get_binary_start(AcdFileObject *self, void *closure) {
+    (void)closure;
+    if (check_open(self) != 0) return NULL;
+    return PyLong_FromLong(self->acd.binary_start);
+}
+
+static PyObject *acdfile_get_closed(AcdFileObject *self, void *closure) {
+    (void)closure;
+    return PyBool_FromLong(!self->open);
+}
+
+static PyMethodDef acdfile_methods[] = {
+    { "scan", (PyCFunction)(void (*)(void))acdfile_scan, METH_VARARGS | METH_KEYWORDS,
+      "scan(start=binary_start, stop=size) -> list of gzip header candidate offsets" },
+    { "blocks", (PyCFunction)(void (*)(void))acdfile_blocks, METH_VARARGS | METH_KEYWORDS,
+      "blocks(use_index=True) -> list of (offset, compressed_size, uncompressed_size, crc32, kind)\n"
+      "for every complete gzip member, from (and kept in) the .acdidx sidecar when use_index" },
+    { "inflate", (PyCFunction)(void (*)(void))acdfile_inflate, METH_VARARGS | METH_KEYWORDS,
+      "inflate(offset, compressed_size=0, uncompressed_size=0) -> memoryview of the decoded member" },
+    { "read", (PyCFunction)(void (*)(void))acdfile_read, METH_VARARGS | METH_KEYWORDS,
+      "read(offset, start, length) -> bytes: up to length decoded bytes from start of the member\n"
+      "at offset, decoding only as far as the range (short only at the member's end)" },
+    { "close", (PyCFunction)acdfile_close, METH_NOARGS, "Unmap the file" },
+    { "__enter__", (PyCFunction)acdfile_enter, METH_NOARGS, NULL },
+    { "__exit__", (PyCFunction)acdfile_exit, METH_VARARGS, NULL },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef acdfile_getset[] = {
+    { "size", (getter)acdfile_get_size, NULL, "File size in bytes", NULL },
+    { "binary_start", (getter)acdfile_get_binary_start, NULL, "Offset where the text header ends", NULL },
+    { "closed", (getter)acdfile_get_closed, NULL, "True once closed", NULL },
+    { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject AcdFileType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "libacd.AcdFile",
+    .tp_basicsize = sizeof(AcdFileObject),
+    .tp_dealloc = (destructor)acdfile_dealloc,
+    .tp_as_buffer = &acdfile_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "AcdFile(path): memory-mapped ACD project, readable as a buffer",
+    .tp_methods = acdfile_methods,
+    .tp_getset = acdfile_getset,
+    .tp_init = (initproc)acdfile_init,
+    .tp_new = PyType_GenericNew,
+};
+
+// scan(buffer, base=0): candidates in any bytes-like object
+static PyObject *module_scan(PyObject *module, PyObject *args, PyObject *kwds) {
+    (void)module;
+    static char *kwlist[] = { "data", "base", NULL };
+    Py_buffer buf;
+    long base = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "y*|l", kwlist, &buf, &base)) {
+        return NULL;
+    }
+    CandidateList list = {0};
+    int ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = acd_scan_gzip(buf.buf, (size_t)buf.len, base, &list);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&buf);
+    PyObject *out = ret == 0 ? offsets_to_list(&list) : PyErr_NoMemory();
+    candidate_list_free(&list);
+    return out;
+}
+
+static PyMethodDef module_methods[] = {
+    { "scan", (PyCFunction)(void (*)(void))module_scan, METH_VARARGS | METH_KEYWORDS,
+      "scan(data, base=0) -> list of gzip header candidate offsets (plus base) in data" },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef libacd_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "libacd",
+    .m_doc = "In-memory access to Studio 5000 .ACD files (libacd)",
+    .m_size = -1,
+    .m_methods = module_methods,
+};
+
+PyMODINIT_FUNC PyInit_libacd(void) {
+    if (PyType_Ready(&BlockType) < 0 || PyType_Ready(&AcdFileType) < 0) {
+        return NULL;
+    }
+    PyObject *m = PyModule_Create(&libacd_module);
+    if (!m) {
+        return NULL;
+    }
+    Py_INCREF(&AcdFileType);
+    if (PyModule_AddObject(m, "AcdFile", (PyObject *)&AcdFileType) < 0 ||
+        PyModule_AddStringConstant(m, "scanner", acd_scan_impl()) < 0) {
+        Py_DECREF(&AcdFileType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
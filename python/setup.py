@@ -0,0 +1,36 @@
+"""
+Build the libacd CPython extension from the C sources one directory up:
+
+    cd python && python setup.py build_ext --inplace
+"""
+
+import glob
+import os
+
+from setuptools import Extension, setup
+
+here = os.path.dirname(os.path.abspath(__file__))
+root = os.path.dirname(here)
+os.chdir(here)
+
+# The whole library goes in; the CLI (acd.c) stays out
+sources = ["libacd.c"] + sorted(
+    os.path.relpath(path, here) for path in glob.glob(os.path.join(root, "acd_*.c"))
+)
+
+setup(
+    name="libacd",
+    version="0.1.0",
+    description="CPython binding to libacd: zero-copy ACD scanning and block decoding",
+    ext_modules=[
+        Extension(
+            "libacd",
+            sources=sources,
+            include_dirs=[root],
+            define_macros=[("_DEFAULT_SOURCE", None), ("_GNU_SOURCE", None)],
+            extra_compile_args=["-O2"],
+            extra_link_args=["-pthread"],
+            libraries=["z"],
+        )
+    ],
+)